@@ -10,12 +10,15 @@
 #include <spdlog/spdlog.h>
 
 #include "cam_capture.hpp"
+#include "command_sender.hpp"
 #include "firing.hpp"
+#include "mailbox.hpp"
 #include "policy.hpp"
 #include "pose_convert.hpp"
 #include "publisher.hpp"
 #include "serial_port.hpp"
 #include "structs.hpp"
+#include "thpool.hpp"
 #include "work_queue.hpp"
 
 int main() {
@@ -33,14 +36,19 @@ int main() {
         //! create a detector for detecting armor
         auto detector = std::make_shared<AutoAim::Publisher>(CONFIG_PATH + "detection_tr.toml");
 
+        //! worker pool shared by per-frame fan-out (ROI extraction, PnP, tracker update)
+        auto pool = std::make_shared<ThreadPool<>>();
+        detector->set_thread_pool(pool);
+
         //! create a coordinate transformer
         auto pose_transformer = std::make_shared<AutoAim::PoseConvert>(CONFIG_PATH + "transform.toml");
 
-        //* start thread to read and process raw data from port
-        std::thread read_from_port([&] { port->read_raw_data_from_port(); });
-        SPDLOG_LOGGER_INFO(log, "reading-raw-from-port thread started");
-        std::thread process_port_data([&] { port->process_raw_data_from_buffer(); });
-        SPDLOG_LOGGER_INFO(log, "processing-raw-from-port thread started");
+        //* 串口的读写都在 io_context 线程上异步完成，开火时 send_data() 不会阻塞在串口上
+        port->start_async_io();
+
+        //* 开火指令只保留最新的一条，按 send_interval 定时发送，过期时重发
+        auto sender = std::make_shared<CommandSender>(port);
+        sender->start();
 
         //! create several sync queues for
         // 1. "image + imu => armors (2D) + label + type(large/small) + imu"
@@ -48,13 +56,30 @@ int main() {
         // 3. "armors(3D) => forward to corresponding tracker"
         // 4. "armors(3D) => forward to filtering Policy"
         SPDLOG_LOGGER_INFO(log, "creating sync queues");
-        auto to_tf     = std::make_shared<SyncQueue<std::vector<AnnotatedArmorInfo>>>();
-        auto to_filter = std::make_shared<SyncQueue<std::vector<Armor3d>>>();
+        // 每一级都只有一个生产者线程和一个消费者线程，使用无锁队列
+        // 相机 -> 识别、跟踪 -> 开火 只关心最新数据，用 Mailbox 丢弃过期数据，保证过载时延迟有上界。
+        // 识别 -> 跟踪 用 FIFO：每一帧的识别结果都是一次观测，跟踪器要按顺序逐帧更新，不能只取最新的。
+        // 识别线程本身只从 Mailbox 取最新的一帧，写入速度不会超过识别速度，而解算、更新一帧远快于识别一帧，
+        // 正常情况下这个队列里最多一两帧，不会积压出延迟；队列满时（跟踪线程卡住）丢弃新结果并记录
+        auto frames    = std::make_shared<Mailbox<RawFrameInfo>>();
+        auto to_tf     = std::make_shared<SyncQueue<std::vector<AnnotatedArmorInfo>, 1024, SPSCRingBuffer>>();
+        auto to_filter = std::make_shared<Mailbox<std::vector<Armor3d>>>();
+        // 跟踪 -> 识别：正在跟踪的目标在图像中的位置，下一帧只在其附近检测
+        auto roi_hints = std::make_shared<Mailbox<std::vector<cv::Rect>>>();
+
+        // producer (0): raw image from camera
+        std::thread capture_img([&] {
+            SPDLOG_LOGGER_INFO(log, "start capturing image");
+            while (true)
+                frames->write(cam->get_frame());
+        });
 
-        // producer (1): raw image from camera
+        // producer (1): annotate the latest frame
         std::thread annotate_img([&] {
             RawFrameInfo raw_frame;
             IMUInfo imu_info;
+            std::vector<cv::Rect> rois;
+            uint64_t tf_dropped = 0; // 识别 -> 跟踪 队列满而丢弃的帧数
 
             auto time          = std::chrono::system_clock::now();
             auto msg_grep_time = std::chrono::system_clock::now();
@@ -65,15 +90,18 @@ int main() {
             while (true) {
                 using namespace std::chrono;
                 SPDLOG_LOGGER_INFO(log, "getting raw frame");
-                raw_frame = cam->get_frame();
+                raw_frame = frames->take_wait();
                 time      = system_clock::now();
 
-                //* get correct recv msg
-                SPDLOG_LOGGER_INFO(log, "getting correct recv msg");
-                auto recv_msg = port->get_data();
-                for (auto duration = time - recv_msg->timestamp; duration > milliseconds(10);
-                     recv_msg      = port->get_data())
-                    duration = time - recv_msg->timestamp;
+                //* get imu pose at the frame time
+                // 按图像时间戳在 IMU 历史中插值；图像晚于最新的 IMU 样本不超过 10 ms 时直接用最新样本
+                SPDLOG_LOGGER_INFO(log, "getting imu pose at frame time");
+                auto imu = port->imu_history().at(raw_frame.timestamp, milliseconds(10));
+                if (!imu) {
+                    SPDLOG_LOGGER_WARN(log, "no imu sample around the frame, skip");
+                    continue;
+                }
+                imu_info = *imu;
                 if constexpr (AnnotateImageBenchmark) {
                     msg_grep_time = system_clock::now();
                     spdlog::info("Get msg consumes {} ms", duration_cast<milliseconds>(msg_grep_time - time).count());
@@ -81,25 +109,42 @@ int main() {
 
                 //* annotate
                 SPDLOG_LOGGER_INFO(log, "annotating image");
-                imu_info.load_from_recvmsg(*recv_msg);
-                auto armor_info = detector->annotate_image(raw_frame, imu_info);
+                if (auto hint = roi_hints->take())
+                    rois = std::move(*hint);
+                auto armor_info = detector->annotate_image(raw_frame, imu_info, rois);
                 if constexpr (AnnotateImageBenchmark) {
-                    annotate_time = system_clock::now();
+                    annotate_time     = system_clock::now();
+                    const auto &stats = detector->detection_stats();
+                    const auto &cache = detector->label_cache_stats();
                     spdlog::info(
-                        "Annotate image consumes {} ms",
-                        duration_cast<milliseconds>(annotate_time - msg_grep_time).count()
+                        "Annotate image consumes {} ms ({}, {:.1f}% scanned), roi hits {}/{}, full scans {}/{}, "
+                        "label cache hits {}/{} ({:.1f}%)",
+                        duration_cast<milliseconds>(annotate_time - msg_grep_time).count(),
+                        stats.last_frame_roi ? "roi" : "full frame",
+                        stats.last_scanned_ratio * 100,
+                        stats.roi_hits,
+                        stats.roi_frames,
+                        stats.full_scans,
+                        stats.frames,
+                        cache.hits,
+                        cache.lookups,
+                        cache.hit_rate() * 100
                     );
                 }
 
                 //* push to next queue
-                to_tf->write_data(armor_info);
+                if (!to_tf->write_data(std::move(armor_info)))
+                    SPDLOG_LOGGER_WARN(log, "transform queue is full, {} annotated frames dropped", ++tf_dropped);
 
                 //* Benchmark test
                 if constexpr (AnnotateImageBenchmark) {
                     auto end_time = system_clock::now();
                     spdlog::info(
-                        "annotating and passing (in total) consumes {} ms",
-                        duration_cast<milliseconds>(end_time - time).count()
+                        "annotating and passing (in total) consumes {} ms, {} stale frames dropped so far, "
+                        "{} annotated frames dropped on a full transform queue",
+                        duration_cast<milliseconds>(end_time - time).count(),
+                        frames->dropped(),
+                        tf_dropped
                     );
                 }
             }
@@ -123,26 +168,71 @@ int main() {
         //* And update tracker
         std::thread transform([&] {
             std::vector<Armor3d> arms;
+            std::map<AutoAim::Labels, std::vector<size_t>> by_label;
+            std::vector<AutoAim::Labels> labels;
+            std::vector<const Armor3d *> priors;
+            std::vector<Armor3d> predictions;
             while (true) {
-                auto armors = to_tf->pop_data();
-                if (!armors.has_value())
-                    continue;
+                auto armors = to_tf->pop_wait();
+
+                //* group by label
+                // 同一个 tracker 的更新必须按顺序进行，因此按 label 分组，不同 tracker 并行更新
+                for (auto &[label, indices] : by_label)
+                    indices.clear();
+                for (size_t i = 0; i < armors.size(); ++i)
+                    if (trackers.count(armors[i].result))
+                        by_label[armors[i].result].push_back(i);
+
+                labels.clear();
+                for (const auto &[label, indices] : by_label)
+                    if (!indices.empty())
+                        labels.push_back(label);
 
                 //* transform
-                arms.clear();
-                for (const auto &armor : armors.value()) {
-                    auto tf_arm = pose_transformer->solve_absolute(armor);
-                    spdlog::info("transformed data writen");
+                // 正在跟踪的目标以跟踪器对本帧拍摄时刻的预测为 PnP 初值，避免装甲板朝向在两个解之间跳变。
+                // 同一目标在一帧中出现多块装甲板时无法对应到上一次的那块，仍使用闭式解
+                priors.assign(armors.size(), nullptr);
+                predictions.resize(armors.size());
+                for (AutoAim::Labels label : labels) {
+                    const auto &tracker = trackers.at(label);
+                    if (by_label.at(label).size() == 1 && tracker->is_tracking()) {
+                        const size_t i = by_label.at(label).front();
+                        predictions[i] = tracker->predict(armors[i].timestamp);
+                        priors[i]      = &predictions[i];
+                    }
+                }
+
+                // 闭式 PnP 每个装甲板只需几微秒，整帧在本线程一次解算，比分发到线程池更快
+                pose_transformer->solve_absolute(armors, priors, arms);
+                spdlog::info("transformed data writen");
 
-                    //* update tracker
-                    trackers[armor.result]->update(tf_arm);
-                    spdlog::info("tracker updated");
+                //* update tracker
+                // 指令经串口到达下位机还需要一段时间，一并计入提前量
+                const auto link = port->clock_sync().estimate();
+                for (AutoAim::Labels label : labels)
+                    trackers.at(label)->set_command_delay(link.uplink);
+                pool->parallel_for(0, labels.size(), [&](size_t k) {
+                    auto &tracker = trackers.at(labels[k]);
+                    for (size_t i : by_label.at(labels[k]))
+                        tracker->update(arms[i]);
+                });
+                spdlog::info("tracker updated");
 
-                    arms.push_back(tf_arm);
+                //* tell the detector where the tracked targets are
+                // 下一帧大约在此刻拍摄，投影跟踪器对此刻的预测
+                const auto next_frame = std::chrono::system_clock::now();
+                std::vector<cv::Rect> hints;
+                for (auto &[label, tracker] : trackers) {
+                    tracker->check_status();
+                    if (!tracker->is_tracking())
+                        continue;
+                    if (auto rect = pose_transformer->project_to_image(tracker->predict(next_frame)); !rect.empty())
+                        hints.push_back(rect);
                 }
+                roi_hints->write(std::move(hints));
 
                 //* push to next queue
-                to_filter->write_data(arms);
+                to_filter->write(std::move(arms));
             }
         });
 
@@ -150,15 +240,13 @@ int main() {
         auto policy          = std::make_shared<SelectingPolicy>();
         auto fire_controller = std::make_shared<FireController>();
 
-        fire_controller->set_port(port);
+        fire_controller->set_sender(sender);
 
         std::thread filter_and_grant_fire([&] {
             while (true) {
-                auto armors = to_filter->pop_data();
-                if (!armors.has_value())
-                    continue;
+                auto armors = to_filter->take_wait();
 
-                auto which = policy->select(armors.value());
+                auto which = policy->select(armors);
                 auto state = trackers[which]->get_pred();
 
                 spdlog::info(
@@ -171,15 +259,16 @@ int main() {
                 );
 
                 fire_controller->set_allow(which);
-                fire_controller->try_fire(state, armors.value());
+                fire_controller->try_fire(state, armors);
             }
         });
 
-        read_from_port.join();
-        process_port_data.join();
+        capture_img.join();
         annotate_img.join();
         transform.join();
         filter_and_grant_fire.join();
+        sender->stop();
+        port->stop_async_io();
     } catch (std::exception &E) {
         spdlog::critical("{}", E.what());
     } catch (boost::exception &E) {
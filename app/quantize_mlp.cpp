@@ -0,0 +1,55 @@
+#include "config.hpp"
+#include "int8_mlp.hpp"
+
+#include <cmath>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.hpp>
+
+/**
+ * @brief 离线量化数字分类模型：读取 ONNX 模型的全连接权重，生成 int8 推理后端使用的权重文件
+ * @details 用法：quantize_mlp [model.onnx] [model.int8]
+ * 省略参数时使用 detection_tr.toml 中 [mlp] model_path 指定的模型，输出到同目录下扩展名为 .int8 的文件
+ */
+int main(int argc, char **argv) {
+    std::string model_path;
+    if (argc > 1)
+        model_path = argv[1];
+    else {
+        const auto config = toml::parse_file(CONFIG_PATH + "detection_tr.toml");
+        model_path        = PWD + config["mlp"]["model_path"].value_or("model.onnx");
+    }
+    const std::string output_path = argc > 2 ? argv[2] : AutoAim::int8_model_path(model_path);
+
+    try {
+        const AutoAim::DenseNetwork network = AutoAim::read_dense_network(model_path);
+        const AutoAim::Int8Mlp mlp          = AutoAim::Int8Mlp::quantize(network);
+
+        // 每层权重量化后的最大相对误差（相对于该输出通道的最大权重）
+        for (size_t l = 0; l < network.layers.size(); ++l) {
+            const auto &dense = network.layers[l];
+            const auto &layer = mlp.layers()[l];
+            double max_error  = 0;
+            for (int o = 0; o < layer.outputs; ++o)
+                for (int i = 0; i < layer.inputs; ++i) {
+                    const double w = dense.weights[size_t(i) * layer.outputs + o];
+                    const double q = layer.weights[size_t(o) * layer.stride + i] * double(layer.scales[o]);
+                    max_error      = std::max(max_error, std::abs(w - q) / (layer.scales[o] * 127));
+                }
+            spdlog::info(
+                "layer {}: {} -> {}{}, max weight error {:.3f}%",
+                l,
+                layer.inputs,
+                layer.outputs,
+                layer.relu ? " (relu)" : "",
+                max_error * 100
+            );
+        }
+
+        mlp.save(output_path);
+        spdlog::info("saved int8 weights of {} to {}", model_path, output_path);
+    } catch (const std::exception &e) {
+        spdlog::error("failed to quantize {}: {}", model_path, e.what());
+        return 1;
+    }
+    return 0;
+}
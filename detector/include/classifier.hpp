@@ -1,8 +1,10 @@
 #ifndef __CLASSIFIER_HPP__
 #define __CLASSIFIER_HPP__
 
+#include "inference_backend.hpp"
 #include "structs.hpp"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -10,30 +12,68 @@
 
 namespace AutoAim {
 
+/**
+ * @brief 单个数字区域的分类结果
+ */
+struct ClassifyResult {
+    Labels label;      // 置信度不超过阈值时为 Labels::None
+    double confidence; // softmax 之后的最大概率
+};
+
 class Classifier {
   public:
     Classifier(const std::string &config_path);
 
+    /**
+     * @brief 复制出一个可以在另一个线程中同时使用的分类器，推理后端见 InferenceBackend::clone
+     */
+    Classifier(const Classifier &other);
+
     /**
      * @brief 对给定的装甲板数字区域进行分类
      */
     Labels classify(cv::Mat &roi);
 
+    /**
+     * @brief 一次前向推理分类一帧中所有的数字区域
+     * @details 所有 ROI 拼成一个 NCHW blob（blobFromImages），只调用一次推理后端的 forward()。
+     * 模型不支持 batch（例如导出时固定了 batch = 1）时，由后端退回逐个推理。
+     * 后端支持直接处理灰度图（InferenceBackend::predict，例如 int8）时逐个推理，不构造 blob
+     * @param rois 数字区域，彩色图会被原地转换为灰度图
+     */
+    std::vector<ClassifyResult> classify_batch(std::vector<cv::Mat> &rois);
+
     /**
      * @brief 从图像里提取装甲板数字区域
      */
     cv::Mat extract_region_of_interest(const cv::Mat &img, const Armor &armor);
     std::vector<cv::Mat> extract_region_of_interest(const cv::Mat &img, const std::vector<Armor> &armors);
 
+    /**
+     * @brief 直接采样出灰度数字区域，结果与 extract_region_of_interest + 转灰度每个像素最多相差 1
+     * @details 只计算 64x64 个输出像素，不对整幅图像做透视变换，也不生成中间彩色图，见 Kernels::warp_gray_patch
+     * @param patch 输出的灰度图，尺寸、类型一致时复用已有内存
+     */
+    void extract_gray_region_of_interest(const cv::Mat &img, const Armor &armor, cv::Mat &patch);
+
   protected:
-    cv::dnn::Net net_;
+    std::unique_ptr<InferenceBackend> backend_; // 由 [mlp] backend 选择，见 make_inference_backend
     std::vector<std::string> labels_, ignore_;
     double confidence_threshold_;
 
   private:
+    // 图像坐标 -> 数字区域（ModelInputWidth x ModelInputHeight）坐标的透视变换
+    cv::Matx33d number_region_transform(const cv::Mat &img, const Armor &armor);
+
     cv::Mat softmax(const cv::Mat &src);
-    void preprocess(cv::Mat &src);
+    void preprocess(cv::Mat &src); // 彩色图转灰度，已是灰度图时不做处理
     int inference(cv::Mat &src);
+
+    // 由一行 logits 得到分类结果
+    ClassifyResult decide(const cv::Mat &logits);
+    // 由 softmax 之后的最大值及其类别得到分类结果
+    ClassifyResult decide(int class_id, double confidence);
+    Labels to_label(int class_id) const;
 }; // class Classifier
 
 } // namespace AutoAim
@@ -0,0 +1,60 @@
+#ifndef __CLASSIFIER_POOL_HPP__
+#define __CLASSIFIER_POOL_HPP__
+
+#include "classifier.hpp"
+#include "thpool.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace AutoAim {
+
+/**
+ * @brief 多个分类器实例，一帧中的数字区域分给各实例并行推理
+ * @details 推理后端（例如 cv::dnn::Net）不能被多个线程同时使用，每个实例各有一份后端。
+ * 模型只加载一次，其余实例由 Classifier 的拷贝构造（InferenceBackend::clone）得到。
+ * 数字区域按顺序均分为若干段，第 k 段由第 k 个实例在线程池中推理（段内仍是一次 batch 推理），
+ * 因此同一个实例不会被两个线程同时使用。
+ *
+ * @remark classify_batch 本身不可重入：同一时刻只能有一个线程调用
+ */
+class ClassifierPool {
+  public:
+    /**
+     * @param size 实例数量，0 表示使用配置文件中的 [mlp] pool_size
+     */
+    explicit ClassifierPool(const std::string &config_path, size_t size = 0);
+
+    /**
+     * @brief 分类一帧中所有的数字区域，结果与单个 Classifier::classify_batch 相同
+     * @details 没有设置线程池、只有一个实例或数字区域少于 min_rois_per_worker 个时，在调用线程用第一个实例推理
+     * @param rois 数字区域，应为灰度图（彩色图由各实例自行转换，不一定写回 rois）
+     */
+    std::vector<ClassifyResult> classify_batch(std::vector<cv::Mat> &rois);
+
+    /**
+     * @brief 直接采样出灰度数字区域，见 Classifier::extract_gray_region_of_interest。可以被多个线程同时调用
+     */
+    void extract_gray_region_of_interest(const cv::Mat &img, const Armor &armor, cv::Mat &patch) {
+        classifiers_.front()->extract_gray_region_of_interest(img, armor, patch);
+    }
+
+    void set_thread_pool(std::shared_ptr<ThreadPool<>> pool) { pool_ = std::move(pool); }
+
+    size_t size() const { return classifiers_.size(); }
+
+  protected:
+    std::vector<std::unique_ptr<Classifier>> classifiers_;
+    std::shared_ptr<ThreadPool<>> pool_;
+
+    // 每个实例至少分到的数字区域数，太少时并行的调度开销超过收益
+    size_t min_rois_per_worker_{2};
+
+    std::vector<std::vector<cv::Mat>> chunks_;         // 各实例分到的数字区域，在帧间复用
+    std::vector<std::vector<ClassifyResult>> results_; // 各实例的分类结果
+};
+
+} // namespace AutoAim
+
+#endif // __CLASSIFIER_POOL_HPP__
@@ -2,39 +2,101 @@
 #define __DETECTOR_HPP__
 
 #include "structs.hpp"
+#include "thpool.hpp"
 
+#include <memory>
 #include <opencv2/core.hpp>
 #include <spdlog/spdlog.h>
 #include <toml++/toml.hpp>
+#include <vector>
 
 namespace AutoAim {
 
 class Detector {
     LightBarConfig light_bar_config_;
     ArmorConfig armor_config_;
+    MorphologyConfig morphology_config_;
+    RoiConfig roi_config_;
+    TilingConfig tiling_config_;
     cv::Mat debug_frame;
+    cv::Mat binary_;                     // 复用的二值图缓冲区
+    std::vector<uint8_t> window_buffer_; // ROI 窗口二值图的复用缓冲区
+    cv::Mat morph_kernel_;               // cv::dilate 使用的结构元素
+    cv::Mat morph_scratch_;              // 快速膨胀的中间结果缓冲区
+
+    DetectionStats stats_;
+    int frames_since_full_scan_{0};
+
+    // 全图按行切成条带，每个条带的中间结果，在多帧间复用
+    struct Stripe {
+        cv::Mat binary, scratch;
+        std::vector<LightBar> lights;
+    };
+    std::vector<Stripe> stripes_;
+    std::shared_ptr<ThreadPool<>> pool_;
 
     /* ==== Functions ==== */
 
-    // 按灰度阈值二值化图像
-    cv::Mat preprocess_image(const cv::Mat &src);
+    // 按灰度阈值、颜色阈值二值化图像并膨胀，结果写入 binary
+    void preprocess_image(const cv::Mat &src, cv::Mat &binary, cv::Mat &scratch);
 
-    // 检测灯条
-    std::vector<LightBar> detect_lightbars(const cv::Mat &rgb, const cv::Mat &binary);
+    // 按 morphology_config_ 原地膨胀二值图，scratch 为快速膨胀的中间结果缓冲区
+    void dilate_binary(cv::Mat &binary, cv::Mat &scratch);
 
-    // 将一组灯条匹配成装甲板
-    std::vector<Armor> pair_lightbars(std::vector<LightBar> &lights);
+    // 膨胀后前景最多向上/下扩展的行数（向左/右同理）
+    int dilation_radius() const;
+
+    // 检测灯条。binary 是原图的一个窗口时，offset 为窗口左上角，灯条坐标仍以原图为准
+    std::vector<LightBar> detect_lightbars(const cv::Mat &rgb, const cv::Mat &binary, cv::Point offset = cv::Point());
 
-    // 检测两个匹配的灯条之间是否还有其他灯条
+    // 检测两个匹配的灯条之间是否还有其他灯条。lights 需按中心横坐标升序
     bool check_mispair(const Armor &armor, const std::vector<LightBar> &lights);
 
+    // 全图扫描
+    std::vector<Armor> detect_full_frame(const cv::Mat &img);
+
+    // 全图扫描切成几个条带并行处理，1 表示串行
+    int stripe_count(int rows) const;
+
+    // 分条带并行预处理，结果写入 binary_，与整幅图预处理逐位一致
+    void preprocess_striped(const cv::Mat &img, int stripes);
+
+    // 分条带并行提取灯条，结果与 detect_lightbars(img, binary_) 相同（顺序可能不同）
+    std::vector<LightBar> detect_lightbars_striped(const cv::Mat &img, int stripes);
+
+    // 将预测框扩展、裁剪到图像内，并合并相交的窗口
+    std::vector<cv::Rect> make_windows(const std::vector<cv::Rect> &rois, const cv::Size &size) const;
+
   public:
     // 载入配置文件
     Detector(std::string path = "../config/detection_tr.toml");
 
-    // 检测装甲板
+    // 检测装甲板（全图扫描）
     std::vector<Armor> detect(const cv::Mat &img);
 
+    /**
+     * @brief 跟踪引导的检测：只在 rois（图像坐标下的预测框）附近做预处理和轮廓搜索
+     * @details rois 为空、未启用 ROI 模式、窗口内没有检测到装甲板，
+     * 或距上次全图扫描已满 RoiConfig::full_scan_interval 帧时，回退为全图扫描
+     */
+    std::vector<Armor> detect(const cv::Mat &img, const std::vector<cv::Rect> &rois);
+
+    /**
+     * @brief 将一组灯条匹配成装甲板
+     * @details 灯条按横坐标排序后扫描，只在 ArmorConfig 的几何门限之内寻找配对；
+     * 夹在中间的灯条同样借助排序二分查找，整体接近 O(n log n)。lights 会被重新排序
+     */
+    std::vector<Armor> pair_lightbars(std::vector<LightBar> &lights);
+
+    /**
+     * @brief 设置线程池后，全图扫描按行切成有重叠的条带并行预处理和提取灯条
+     * @remark 结果与串行实现一致，见 TilingConfig
+     */
+    void set_thread_pool(std::shared_ptr<ThreadPool<>> pool);
+
+    // ROI 命中、全图扫描等统计信息
+    const DetectionStats &stats() const { return stats_; }
+
     // （调试用）将检测结果绘制到图像上
     void draw_results_to_image(cv::Mat &img, const std::vector<Armor> &armors);
 };
@@ -0,0 +1,113 @@
+#ifndef __IMAGE_KERNELS_HPP__
+#define __IMAGE_KERNELS_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <opencv2/core.hpp>
+
+namespace AutoAim {
+
+namespace Kernels {
+
+/**
+ * @brief 灯条二值化所需的参数
+ * @details 与原来的 OpenCV 流程语义一致：
+ * mask = (gray > brightness_threshold) && (saturate(enemy - ally) > color_threshold) ? 255 : 0
+ */
+struct LightBarMaskParams {
+    int enemy_channel;        // BGR 中敌方颜色的通道下标
+    int ally_channel;         // BGR 中己方颜色的通道下标
+    int brightness_threshold; // 灰度阈值
+    int color_threshold;      // 通道差阈值
+};
+
+/**
+ * @brief 一次遍历 BGR 图像，直接写出灯条二值图
+ * @details 替代 cvtColor + threshold + split + subtract + threshold + bitwise_and。
+ * 灰度使用与 cv::cvtColor(COLOR_BGR2GRAY) 相同的 15 位定点系数，结果逐位一致。
+ * CPU 支持 AVX2 时使用向量化实现，否则使用标量实现。
+ *
+ * @param bgr 输入图像首地址，每行 step 字节
+ * @param mask 输出二值图首地址，每行 mask_step 字节
+ * @param rows, cols 图像尺寸（像素）
+ */
+void lightbar_mask(
+    const uint8_t *bgr, size_t bgr_step, uint8_t *mask, size_t mask_step, int rows, int cols,
+    const LightBarMaskParams &params
+);
+
+/**
+ * @brief cv::Mat 版本。mask 尺寸或类型不符时才重新分配，否则复用已有内存
+ */
+void lightbar_mask(const cv::Mat &bgr, cv::Mat &mask, const LightBarMaskParams &params);
+
+/**
+ * @brief 标量实现，用于不支持 AVX2 的 CPU 以及测试对照
+ */
+void lightbar_mask_scalar(
+    const uint8_t *bgr, size_t bgr_step, uint8_t *mask, size_t mask_step, int rows, int cols,
+    const LightBarMaskParams &params
+);
+
+/**
+ * @brief 二值图按 L1 菱形（|dx| + |dy| <= radius）膨胀
+ * @details 与 3x3 十字（即 3x3 椭圆）结构元素膨胀 radius 次的结果逐位一致。
+ * 先逐列求到最近前景像素的竖直距离 V（上下各扫一遍），再沿行取 min(V[x + k] + |k|)。
+ * 上下 radius 行内都没有前景的行不计算，直接输出 0，灯条二值图这类稀疏图像的开销接近一次 memset。
+ *
+ * @param src 二值图（非 0 即前景），允许与 dst 是同一个 Mat
+ * @param radius 菱形半径，[0, 254]
+ * @param scratch 中间结果缓冲区，可在多帧间复用
+ */
+void dilate_diamond(const cv::Mat &src, cv::Mat &dst, int radius, cv::Mat &scratch);
+
+/**
+ * @brief 矩形结构元素膨胀，等价于 cv::dilate(src, dst, getStructuringElement(MORPH_RECT, ksize))
+ * @details 先行后列分离计算，每个方向使用 van Herk/Gil-Werman 滑动最大值，开销与窗口大小无关。
+ *
+ * @param src 8 位单通道图像，允许与 dst 是同一个 Mat
+ * @param scratch 中间结果缓冲区，可在多帧间复用
+ * @param anchor 锚点，(-1, -1) 表示中心，与 cv::dilate 相同
+ */
+void dilate_rect(
+    const cv::Mat &src, cv::Mat &dst, cv::Size ksize, cv::Mat &scratch, cv::Point anchor = cv::Point(-1, -1)
+);
+
+/**
+ * @brief 透视采样一个灰度小图，等价于 warpPerspective(INTER_LINEAR, BORDER_CONSTANT) + cvtColor(BGR2GRAY)
+ * @details 只计算输出的 width x height 个像素：每个输出像素按逆变换求出源坐标，对 4 个邻点现场计算
+ * 未舍入的定点亮度后双线性插值，不生成中间彩色图。
+ * 与 OpenCV 两步流程相比每个像素最多相差 1（OpenCV 在两步之间各舍入一次）。
+ * CPU 支持 AVX2 时，4 个邻点都在图像内的 8 个像素一组用 gather 向量化，其余像素用标量实现。
+ *
+ * @param bgr 输入图像首地址，每行 bgr_step 字节，rows x cols 像素
+ * @param dst_to_src 输出坐标 -> 源坐标的 3x3 变换（行优先），即 warpPerspective 所用矩阵的逆
+ * @param patch 输出灰度图首地址，每行 patch_step 字节，height x width 像素
+ */
+void warp_gray_patch(
+    const uint8_t *bgr, size_t bgr_step, int rows, int cols, const double dst_to_src[9], uint8_t *patch,
+    size_t patch_step, int width, int height
+);
+
+/**
+ * @brief cv::Mat 版本，参数与 cv::warpPerspective 相同。patch 尺寸或类型不符时才重新分配
+ * @param src_to_dst 源坐标 -> 输出坐标的变换，例如 getPerspectiveTransform 的结果
+ */
+void warp_gray_patch(const cv::Mat &bgr, const cv::Matx33d &src_to_dst, cv::Mat &patch, cv::Size size);
+
+/**
+ * @brief 标量实现，用于不支持 AVX2 的 CPU 以及测试对照
+ */
+void warp_gray_patch_scalar(
+    const uint8_t *bgr, size_t bgr_step, int rows, int cols, const double dst_to_src[9], uint8_t *patch,
+    size_t patch_step, int width, int height
+);
+
+// 当前 CPU 是否支持 AVX2
+bool has_avx2();
+
+} // namespace Kernels
+
+} // namespace AutoAim
+
+#endif // __IMAGE_KERNELS_HPP__
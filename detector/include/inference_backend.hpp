@@ -0,0 +1,133 @@
+#ifndef __INFERENCE_BACKEND_HPP__
+#define __INFERENCE_BACKEND_HPP__
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <opencv2/dnn.hpp>
+
+namespace AutoAim {
+
+/**
+ * @brief 数字分类模型的推理后端
+ * @details 输入为 blobFromImages 得到的 N x 1 x H x W 归一化 float blob，输出 N x 类别数 的 logits。
+ * 预处理、softmax 与阈值判断都在 Classifier 中完成，与后端无关
+ */
+class InferenceBackend {
+  public:
+    virtual ~InferenceBackend() = default;
+
+    // 后端名称，与配置文件 [mlp] backend 的取值相同
+    virtual const char *name() const = 0;
+
+    /**
+     * @brief 前向推理
+     * @param blob N x 1 x H x W，CV_32F，内存连续
+     * @return N x 类别数，CV_32F
+     */
+    virtual cv::Mat forward(const cv::Mat &blob) = 0;
+
+    /**
+     * @brief 由一张 8 位灰度数字区域直接得到类别与置信度（forward() 的输出做 softmax 后的最大值）
+     * @details 供把 softmax 与 argmax 融合进推理、不需要构造 blob 的后端实现
+     * @return 后端不支持（或 patch 尺寸不符）时返回 false，调用方改用 forward()
+     */
+    virtual bool predict(const cv::Mat &patch, int &class_id, float &confidence) { return false; }
+
+    /**
+     * @brief 复制出一个可以在另一个线程中同时推理的实例
+     * @details 已加载的模型在实例间共享或直接复制，不重新读取模型文件
+     */
+    virtual std::unique_ptr<InferenceBackend> clone() const = 0;
+
+  protected:
+    // 逐个样本调用 forward()，用于不支持 batch 的模型
+    cv::Mat forward_each(const cv::Mat &blob);
+};
+
+/**
+ * @brief OpenCV DNN 后端（cv::dnn::readNetFromONNX）
+ * @details cv::dnn::Net 不能被多个线程同时 forward，并且复制 Net 只是共享同一个网络。
+ * 因此模型文件只读取一次，clone() 从内存中的模型重新构建网络
+ * @remark 模型导出时固定了 batch = 1 的话，第一次 batch 推理失败后自动退回逐个推理
+ */
+class OpenCvDnnBackend : public InferenceBackend {
+  public:
+    /**
+     * @throw std::runtime_error 模型文件无法读取；cv::Exception 模型格式不符
+     */
+    explicit OpenCvDnnBackend(const std::string &model_path);
+
+    const char *name() const override { return "opencv"; }
+    cv::Mat forward(const cv::Mat &blob) override;
+    std::unique_ptr<InferenceBackend> clone() const override;
+
+  protected:
+    explicit OpenCvDnnBackend(std::shared_ptr<const std::vector<uchar>> model);
+
+    std::shared_ptr<const std::vector<uchar>> model_; // 模型文件内容，各实例共享
+    cv::dnn::Net net_;
+    bool batch_supported_{true}; // 模型是否支持 batch > 1
+};
+
+/**
+ * @brief 全连接层的浮点权重
+ */
+struct DenseLayer {
+    int inputs, outputs;
+    std::vector<float> weights; // inputs x outputs
+    std::vector<float> bias;
+    bool relu{false};
+};
+
+/**
+ * @brief Flatten -> (Gemm -> ReLU)* -> Gemm [-> Softmax] 结构的小模型
+ */
+struct DenseNetwork {
+    std::vector<DenseLayer> layers;
+    bool softmax{false}; // 模型最后是否自带 softmax
+};
+
+/**
+ * @brief 从 ONNX 模型读取全连接网络的权重（借助 OpenCV 的导入器），按 输入 x 输出 转置存放
+ * @throw std::runtime_error 模型中有不支持的层；cv::Exception 权重格式不符
+ */
+DenseNetwork read_dense_network(const std::string &model_path);
+
+/**
+ * @brief 手写的全连接网络后端，浮点计算，权重见 read_dense_network
+ * @details 每层对一个 batch 的所有样本逐输入维度做 axpy：内层循环连续访问一行权重，编译器可以直接向量化；
+ * 输入为 0 的维度（数字区域的暗背景）直接跳过。
+ */
+class MlpBackend : public InferenceBackend {
+  public:
+    /**
+     * @throw std::runtime_error 模型中有不支持的层；cv::Exception 权重格式不符
+     */
+    explicit MlpBackend(const std::string &model_path);
+    explicit MlpBackend(DenseNetwork network);
+
+    const char *name() const override { return "native"; }
+    cv::Mat forward(const cv::Mat &blob) override;
+    std::unique_ptr<InferenceBackend> clone() const override { return std::make_unique<MlpBackend>(*this); }
+
+  protected:
+    DenseNetwork network_;
+    std::vector<float> hidden_[2]; // 隐藏层输出，在多次推理间复用
+};
+
+/**
+ * @brief 按名称创建推理后端
+ * @param backend "opencv" / "onnxruntime" / "native" / "int8"。
+ * 编译时未启用 ONNX Runtime，或模型结构不被 native / int8 后端支持时，退回 "opencv" 并给出警告
+ * @throw std::runtime_error 未知的后端名称
+ */
+std::unique_ptr<InferenceBackend> make_inference_backend(const std::string &backend, const std::string &model_path);
+
+// 当前编译启用的后端名称
+std::vector<std::string> available_inference_backends();
+
+} // namespace AutoAim
+
+#endif // __INFERENCE_BACKEND_HPP__
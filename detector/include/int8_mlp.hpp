@@ -0,0 +1,105 @@
+#ifndef __INT8_MLP_HPP__
+#define __INT8_MLP_HPP__
+
+#include "inference_backend.hpp"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+
+namespace AutoAim {
+
+/**
+ * @brief int8 量化的全连接网络，输入为 8 位灰度数字区域
+ * @details 权重按输出通道对称量化为 int8（每个输出一个 scale），偏置保持 float。
+ * 输入层的激活就是像素本身（scale = 1/255）；隐藏层经过 ReLU 后非负，逐样本按最大值动态量化为 uint8。
+ * 因此每层都是 uint8 x int8 -> int32 的点积：CPU 支持 AVX-VNNI 时用 vpdpbusd，否则用 AVX2 的 vpmaddwd，
+ * 都不支持时用标量实现，三者的整数累加结果完全相同。
+ * 最后一层的输出直接求 argmax 与 softmax 最大值；缓冲区在加载时分配好，推理过程不分配堆内存。
+ *
+ * @remark 同一个对象不能被多个线程同时用于推理
+ */
+class Int8Mlp {
+  public:
+    enum class Isa { Scalar, Avx2, AvxVnni };
+
+    struct Layer {
+        int inputs, outputs;
+        int stride;                  // 每行权重的字节数，inputs 向上取整到 32，补 0
+        std::vector<int8_t> weights; // outputs x stride
+        std::vector<float> scales;   // 每个输出通道的权重 scale
+        std::vector<float> bias;
+        bool relu{false};
+    };
+
+    Int8Mlp() = default;
+
+    /**
+     * @brief 量化浮点网络
+     * @throw std::runtime_error 隐藏层没有 ReLU（激活值可能为负，不能量化为 uint8）
+     */
+    static Int8Mlp quantize(const DenseNetwork &network);
+
+    /**
+     * @brief 读取 quantize_mlp 工具生成的权重文件
+     * @throw std::runtime_error 文件不存在或格式不符
+     */
+    static Int8Mlp load(const std::string &path);
+    void save(const std::string &path) const;
+
+    /**
+     * @brief 分类一个数字区域
+     * @param patch CV_8UC1，像素数与第一层输入相同（ModelInputHeight x ModelInputWidth）
+     * @param confidence 网络输出做 softmax 后的最大值，与 Classifier 对 forward() 结果的处理相同
+     * @param outputs 可选，写出网络的输出（类别数个 float；模型自带 softmax 时为概率）
+     */
+    void predict(const cv::Mat &patch, int &class_id, float &confidence, float *outputs = nullptr);
+
+    // 使用的指令集，默认为当前 CPU 支持的最快实现；设为 CPU 不支持的指令集时退回标量实现
+    Isa isa() const { return isa_; }
+    void set_isa(Isa isa);
+
+    const std::vector<Layer> &layers() const { return layers_; }
+    int inputs() const { return layers_.front().inputs; }
+    int classes() const { return layers_.back().outputs; }
+    bool softmax() const { return softmax_; }
+
+  private:
+    void allocate(); // 按各层宽度分配推理用的缓冲区
+
+    std::vector<Layer> layers_;
+    bool softmax_{false};
+    Isa isa_{Isa::Scalar};
+
+    std::vector<uint8_t> act_;   // 当前层的量化输入
+    std::vector<int16_t> act16_; // AVX2 实现把输入预先扩展为 16 位
+    std::vector<int32_t> acc_;   // 整数累加结果
+    std::vector<float> out_;     // 当前层的浮点输出
+};
+
+/**
+ * @brief int8 推理后端，配置文件 [mlp] backend = "int8"
+ * @details predict() 直接处理灰度数字区域；forward() 把 blob 还原为 8 位像素后逐个推理，用于兼容
+ */
+class Int8MlpBackend : public InferenceBackend {
+  public:
+    explicit Int8MlpBackend(Int8Mlp mlp);
+
+    const char *name() const override { return "int8"; }
+    cv::Mat forward(const cv::Mat &blob) override;
+    bool predict(const cv::Mat &patch, int &class_id, float &confidence) override;
+    std::unique_ptr<InferenceBackend> clone() const override;
+
+  protected:
+    Int8Mlp mlp_;
+    cv::Mat patch_; // forward() 中还原出的 8 位图像
+};
+
+// ONNX 模型对应的 int8 权重文件路径：扩展名换成 .int8，例如 model.onnx -> model.int8
+std::string int8_model_path(const std::string &model_path);
+
+} // namespace AutoAim
+
+#endif // __INT8_MLP_HPP__
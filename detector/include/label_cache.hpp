@@ -0,0 +1,74 @@
+#ifndef __LABEL_CACHE_HPP__
+#define __LABEL_CACHE_HPP__
+
+#include "classifier.hpp"
+#include "structs.hpp"
+
+#include <array>
+#include <vector>
+
+namespace AutoAim {
+
+/**
+ * @brief 按短期轨迹缓存数字分类结果，已确认的目标不再每帧推理
+ * @details 每帧分两步使用：
+ * 1. lookup() 把装甲板关联到上一帧的轨迹，返回仍需推理的装甲板；
+ * 2. 对这些装甲板推理后调用 update()，结果按轨迹做时间投票，得到每个装甲板的最终标签。
+ * 参数与确认规则见 LabelCacheConfig
+ */
+class LabelCache {
+  public:
+    explicit LabelCache(const LabelCacheConfig &config);
+
+    /**
+     * @brief 将本帧的装甲板关联到已有轨迹，返回需要推理的装甲板下标（升序）
+     * @details 关联按 IoU 从大到小贪心一对一匹配。未在返回值中的装甲板命中缓存
+     */
+    const std::vector<size_t> &lookup(const std::vector<Armor> &armors);
+
+    /**
+     * @brief 写入推理结果，更新轨迹
+     * @param armors 与 lookup() 传入的相同
+     * @param classified 与 lookup() 返回的下标一一对应的推理结果
+     * @return 每个装甲板投票后的分类结果
+     */
+    std::vector<ClassifyResult>
+    update(const std::vector<Armor> &armors, const std::vector<ClassifyResult> &classified);
+
+    // 丢弃所有轨迹，统计信息保留
+    void clear();
+
+    const LabelCacheStats &stats() const { return stats_; }
+
+    // 两个装甲板四边形的交并比
+    static double iou(const std::vector<cv::Point2f> &a, const std::vector<cv::Point2f> &b);
+
+  protected:
+    static constexpr size_t kLabelCount = static_cast<size_t>(Labels::Base) + 1;
+
+    struct Track {
+        std::vector<cv::Point2f> vertices;       // 最近一次关联上的装甲板顶点
+        std::array<double, kLabelCount> votes{}; // 每个标签按置信度加权、随时间衰减的票数
+        Labels label{Labels::None};              // 投票结果
+        double confidence{0};                    // 投票结果的置信度，跳过推理的帧会衰减
+        int streak{0};                           // 连续与投票结果一致的推理次数
+        int since_verify{0};                     // 距上次推理的帧数
+        int missed{0};                           // 连续未关联上的帧数
+    };
+
+    LabelCacheConfig config_;
+    LabelCacheStats stats_;
+    std::vector<Track> tracks_;
+
+    std::vector<int> matches_;    // 本帧装甲板 -> 轨迹下标，-1 表示新目标
+    std::vector<size_t> pending_; // 本帧需要推理的装甲板下标
+
+    // 缓存的标签是否可以直接使用
+    bool confirmed(const Track &track) const;
+    // 把一次推理结果计入轨迹的投票
+    void vote(Track &track, const ClassifyResult &result);
+};
+
+} // namespace AutoAim
+
+#endif // __LABEL_CACHE_HPP__
@@ -3,9 +3,11 @@
 
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
-#include "classifier.hpp"
+#include "classifier_pool.hpp"
 #include "detector.hpp"
+#include "label_cache.hpp"
 #include "structs.hpp"
+#include "thpool.hpp"
 
 #include <memory>
 #include <vector>
@@ -20,13 +22,31 @@ class Publisher {
      * @brief 传入一帧图像，返回所有识别到的装甲板信息
      * @param raw 原始图像
      * @param imu 此时的 IMU 信息
+     * @param rois 跟踪器预测的装甲板在图像中的位置。非空时只在其附近检测，见 Detector::detect
      * @return std::vector<AnnotatedArmorInfo> 该帧图像中所有识别到的装甲板信息
      */
-    std::vector<AnnotatedArmorInfo> annotate_image(const RawFrameInfo &raw, const IMUInfo &imu);
+    std::vector<AnnotatedArmorInfo>
+    annotate_image(const RawFrameInfo &raw, const IMUInfo &imu, const std::vector<cv::Rect> &rois = {});
+
+    // 检测器的 ROI 命中、全图扫描统计
+    const DetectionStats &detection_stats() const { return detector_->stats(); }
+
+    // 数字分类缓存的命中统计
+    const LabelCacheStats &label_cache_stats() const { return label_cache_->stats(); }
+
+    /**
+     * @brief 设置线程池后，全图扫描分条带并行，每帧各装甲板的数字区域提取并行执行，
+     * 数字区域较多时分给 ClassifierPool 的各个实例并行推理
+     */
+    void set_thread_pool(std::shared_ptr<ThreadPool<>> pool);
 
   protected:
     std::shared_ptr<Detector> detector_;
-    std::shared_ptr<Classifier> classifier_;
+    std::shared_ptr<ClassifierPool> classifiers_;
+    std::shared_ptr<LabelCache> label_cache_;
+    std::shared_ptr<ThreadPool<>> pool_;
+
+    std::vector<cv::Mat> rois_; // 每帧的灰度数字区域
 };
 
 } // namespace AutoAim
@@ -47,6 +47,162 @@ AutoAim::LightBarConfig::LightBarConfig(std::string path) {
         spdlog::info("LightBarConfig initialization done.");
 }
 
+// ========================================================
+// Morphology Config
+// ========================================================
+
+AutoAim::MorphologyConfig::MorphologyConfig(std::string path) {
+    if constexpr (InitializationDebug)
+        spdlog::info("initializing MorphologyConfig with config file: \"{}\"", path);
+
+    this->shape       = cv::MORPH_ELLIPSE;
+    this->kernel_size = 3;
+    this->iterations  = 7;
+    this->use_opencv  = false;
+    try {
+        auto T            = toml::parse_file(path);
+        std::string shape = T["morphology"]["shape"].value_or("ellipse");
+        this->kernel_size = T["morphology"]["kernel_size"].value_or(3);
+        this->iterations  = T["morphology"]["iterations"].value_or(7);
+        this->use_opencv  = T["morphology"]["method"].value_or("fast") == std::string("opencv");
+
+        if (shape == "rect")
+            this->shape = cv::MORPH_RECT;
+        else if (shape == "cross")
+            this->shape = cv::MORPH_CROSS;
+        else if (shape == "ellipse")
+            this->shape = cv::MORPH_ELLIPSE;
+        else
+            spdlog::error("unknown morphology shape \"{}\", using ellipse", shape);
+
+        if constexpr (InitializationDebug)
+            spdlog::info(
+                "MorphologyConfig(shape: {}, kernel_size: {}, iterations: {}, use_opencv: {})",
+                shape,
+                kernel_size,
+                iterations,
+                use_opencv
+            );
+    } catch (const toml::parse_error &e) {
+        spdlog::error("Error parsing config file \"{}\" for MorphologyConfig, using fallback", e.what());
+    }
+
+    if constexpr (InitializationDebug)
+        spdlog::info("MorphologyConfig initialization done.");
+}
+
+// ========================================================
+// ROI Config
+// ========================================================
+
+AutoAim::RoiConfig::RoiConfig(std::string path) {
+    if constexpr (InitializationDebug)
+        spdlog::info("initializing RoiConfig with config file: \"{}\"", path);
+
+    this->enable             = false;
+    this->padding            = 0.5;
+    this->min_size           = 64;
+    this->full_scan_interval = 30;
+    try {
+        auto T                   = toml::parse_file(path);
+        this->enable             = T["roi"]["enable"].value_or(false);
+        this->padding            = T["roi"]["padding"].value_or(0.5);
+        this->min_size           = T["roi"]["min_size"].value_or(64);
+        this->full_scan_interval = T["roi"]["full_scan_interval"].value_or(30);
+
+        if constexpr (InitializationDebug)
+            spdlog::info(
+                "RoiConfig(enable: {}, padding: {}, min_size: {}, full_scan_interval: {})",
+                enable,
+                padding,
+                min_size,
+                full_scan_interval
+            );
+    } catch (const toml::parse_error &e) {
+        spdlog::error("Error parsing config file \"{}\" for RoiConfig, using fallback", e.what());
+    }
+
+    if constexpr (InitializationDebug)
+        spdlog::info("RoiConfig initialization done.");
+}
+
+// ========================================================
+// Tiling Config
+// ========================================================
+
+AutoAim::TilingConfig::TilingConfig(std::string path) {
+    if constexpr (InitializationDebug)
+        spdlog::info("initializing TilingConfig with config file: \"{}\"", path);
+
+    this->stripes         = 0;
+    this->overlap         = 256;
+    this->min_stripe_rows = 128;
+    try {
+        auto T                = toml::parse_file(path);
+        this->stripes         = T["tiling"]["stripes"].value_or(0);
+        this->overlap         = T["tiling"]["overlap"].value_or(256);
+        this->min_stripe_rows = T["tiling"]["min_stripe_rows"].value_or(128);
+
+        if constexpr (InitializationDebug)
+            spdlog::info(
+                "TilingConfig(stripes: {}, overlap: {}, min_stripe_rows: {})", stripes, overlap, min_stripe_rows
+            );
+    } catch (const toml::parse_error &e) {
+        spdlog::error("Error parsing config file \"{}\" for TilingConfig, using fallback", e.what());
+    }
+
+    if constexpr (InitializationDebug)
+        spdlog::info("TilingConfig initialization done.");
+}
+
+// ========================================================
+// Label Cache Config
+// ========================================================
+
+AutoAim::LabelCacheConfig::LabelCacheConfig(std::string path) {
+    if constexpr (InitializationDebug)
+        spdlog::info("initializing LabelCacheConfig with config file: \"{}\"", path);
+
+    this->enable             = false;
+    this->min_iou            = 0.3;
+    this->confirm_frames     = 3;
+    this->confirm_confidence = 0.9;
+    this->confidence_decay   = 0.99;
+    this->reverify_interval  = 10;
+    this->vote_decay         = 0.7;
+    this->max_missed         = 3;
+    try {
+        auto T                   = toml::parse_file(path);
+        this->enable             = T["label_cache"]["enable"].value_or(false);
+        this->min_iou            = T["label_cache"]["min_iou"].value_or(0.3);
+        this->confirm_frames     = T["label_cache"]["confirm_frames"].value_or(3);
+        this->confirm_confidence = T["label_cache"]["confirm_confidence"].value_or(0.9);
+        this->confidence_decay   = T["label_cache"]["confidence_decay"].value_or(0.99);
+        this->reverify_interval  = T["label_cache"]["reverify_interval"].value_or(10);
+        this->vote_decay         = T["label_cache"]["vote_decay"].value_or(0.7);
+        this->max_missed         = T["label_cache"]["max_missed"].value_or(3);
+
+        if constexpr (InitializationDebug)
+            spdlog::info(
+                "LabelCacheConfig(enable: {}, min_iou: {}, confirm_frames: {}, confirm_confidence: {}, "
+                "confidence_decay: {}, reverify_interval: {}, vote_decay: {}, max_missed: {})",
+                enable,
+                min_iou,
+                confirm_frames,
+                confirm_confidence,
+                confidence_decay,
+                reverify_interval,
+                vote_decay,
+                max_missed
+            );
+    } catch (const toml::parse_error &e) {
+        spdlog::error("Error parsing config file \"{}\" for LabelCacheConfig, using fallback", e.what());
+    }
+
+    if constexpr (InitializationDebug)
+        spdlog::info("LabelCacheConfig initialization done.");
+}
+
 // ========================================================
 // Armor Config
 // ========================================================
@@ -322,4 +478,41 @@ bool AutoAim::Armor::is_valid(const ArmorConfig &config) {
         this->type = ArmorType::Small;
 
     return true;
-}
\ No newline at end of file
+}
+
+bool AutoAim::Armor::may_pair(const LightBar &l1, const LightBar &l2, const ArmorConfig &config) {
+    // 以下各项与 is_valid() 中的计算方式完全相同（l1 即 left，l2 即 right）
+    const cv::Rect2f r1 = l1.ellipse.boundingRect2f(), r2 = l2.ellipse.boundingRect2f();
+    if (r1.br().y < r2.tl().y || r2.br().y < r1.tl().y)
+        return false;
+
+    double area_ratio = l1.ellipse_area / l2.ellipse_area;
+    if (area_ratio > config.lightbar_area_ratio || area_ratio < 1.0 / config.lightbar_area_ratio)
+        return false;
+
+    double mean_length       = (l1.long_axis + l2.long_axis) / 2.0;
+    double height_diff_ratio = std::abs(l1.long_axis - l2.long_axis) / std::max(l1.long_axis, l2.long_axis);
+    if (height_diff_ratio > config.max_height_diff_ratio)
+        return false;
+
+    double y_diff_ratio = std::abs(l1.center().y - l2.center().y) / mean_length;
+    if (y_diff_ratio > config.max_Y_diff_ratio)
+        return false;
+
+    double distance     = cv::norm(l1.center() - l2.center());
+    double aspect_ratio = distance / mean_length;
+    if (aspect_ratio < config.min_X_diff_ratio || aspect_ratio < config.min_aspect_ratio
+        || aspect_ratio > config.max_aspect_ratio)
+        return false;
+
+    double roll = std::asin(std::abs(l1.center().y - l2.center().y) / distance) * 180.0 / CV_PI;
+    if (std::abs(roll) > config.max_roll_angle)
+        return false;
+
+    double angle_diff = std::abs(l1.angle - l2.angle);
+    if (angle_diff > 180)
+        angle_diff -= 180;
+    else if (angle_diff > 170)
+        angle_diff = 180 - angle_diff;
+    return !(angle_diff > config.max_angle_diff);
+}
@@ -2,6 +2,7 @@
 
 #include "classifier.hpp"
 #include "config.hpp"
+#include "image_kernels.hpp"
 #include "structs.hpp"
 
 #include <algorithm>
@@ -29,7 +30,10 @@ AutoAim::Classifier::Classifier(const std::string &config_path) {
         if constexpr (InitializationDebug)
             spdlog::info("loading model from {}", model_path.value());
 
-        net_ = cv::dnn::readNetFromONNX(PWD + model_path.value());
+        std::string backend = T["mlp"]["backend"].value_or("opencv");
+        backend_            = make_inference_backend(backend, PWD + model_path.value());
+        if constexpr (InitializationDebug)
+            spdlog::info("inference backend: {}", backend_->name());
 
         // 提取识别标签
         if (toml::array *arr = labels.as_array()) {
@@ -57,7 +61,13 @@ AutoAim::Classifier::Classifier(const std::string &config_path) {
         spdlog::info("classifier initialization done");
 }
 
-cv::Mat AutoAim::Classifier::extract_region_of_interest(const cv::Mat &img, const Armor &armor) {
+AutoAim::Classifier::Classifier(const Classifier &other)
+    : backend_(other.backend_->clone()),
+      labels_(other.labels_),
+      ignore_(other.ignore_),
+      confidence_threshold_(other.confidence_threshold_) {}
+
+cv::Matx33d AutoAim::Classifier::number_region_transform(const cv::Mat &img, const Armor &armor) {
     if constexpr (ClassifierDebug)
         spdlog::info("extracting ROI from armor, performing test");
 
@@ -97,19 +107,29 @@ cv::Mat AutoAim::Classifier::extract_region_of_interest(const cv::Mat &img, cons
     std::clamp(bottom_right.y, 1.0f, static_cast<float>(img.rows) - 1);
 
     // 透视变换
-    cv::Mat pattern_img;
     cv::Point2f src_points[4] = {top_left, top_right, bottom_right, bottom_left};
     cv::Point2f dst_points[4]
         = {cv::Point2f(0, 0),
            cv::Point2f(ModelInputWidth, 0),
            cv::Point2f(ModelInputWidth, ModelInputHeight),
            cv::Point2f(0, ModelInputHeight)}; // model.onnx 为 64x64
-    cv::Mat warpMatrix = cv::getPerspectiveTransform(src_points, dst_points);
-    cv::warpPerspective(img, pattern_img, warpMatrix, cv::Size(ModelInputWidth, ModelInputHeight));
+    return cv::getPerspectiveTransform(src_points, dst_points);
+}
 
+cv::Mat AutoAim::Classifier::extract_region_of_interest(const cv::Mat &img, const Armor &armor) {
+    cv::Mat pattern_img;
+    cv::warpPerspective(
+        img, pattern_img, number_region_transform(img, armor), cv::Size(ModelInputWidth, ModelInputHeight)
+    );
     return pattern_img;
 }
 
+void AutoAim::Classifier::extract_gray_region_of_interest(const cv::Mat &img, const Armor &armor, cv::Mat &patch) {
+    Kernels::warp_gray_patch(
+        img, number_region_transform(img, armor), patch, cv::Size(ModelInputWidth, ModelInputHeight)
+    );
+}
+
 std::vector<cv::Mat>
 AutoAim::Classifier::extract_region_of_interest(const cv::Mat &img, const std::vector<Armor> &armors) {
     std::vector<cv::Mat> rois;
@@ -118,9 +138,55 @@ AutoAim::Classifier::extract_region_of_interest(const cv::Mat &img, const std::v
     return rois;
 }
 
-AutoAim::Labels AutoAim::Classifier::classify(cv::Mat &roi) {
-    auto result = inference(roi);
-    switch (result) {
+AutoAim::Labels AutoAim::Classifier::classify(cv::Mat &roi) { return to_label(inference(roi)); }
+
+std::vector<AutoAim::ClassifyResult> AutoAim::Classifier::classify_batch(std::vector<cv::Mat> &rois) {
+    std::vector<ClassifyResult> results;
+    if (rois.empty())
+        return results;
+
+    for (auto &roi : rois)
+        preprocess(roi); //* 预处理
+
+    // 后端可以直接处理灰度图时（int8）不构造 blob
+    int class_id;
+    float confidence;
+    if (backend_->predict(rois.front(), class_id, confidence)) {
+        results.push_back(decide(class_id, confidence));
+        for (size_t i = 1; i < rois.size(); ++i) {
+            if (!backend_->predict(rois[i], class_id, confidence))
+                break;
+            results.push_back(decide(class_id, confidence));
+        }
+        if (results.size() == rois.size())
+            return results;
+        results.clear();
+    }
+
+    cv::Mat inputBlob = cv::dnn::blobFromImages(
+        rois, 1.0 / 255, cv::Size(ModelInputWidth, ModelInputHeight), cv::Scalar(0), false, false
+    );
+    cv::Mat output = backend_->forward(inputBlob); // N x 类别数
+    for (int i = 0; i < output.rows; ++i)
+        results.push_back(decide(output.row(i)));
+    return results;
+}
+
+AutoAim::ClassifyResult AutoAim::Classifier::decide(const cv::Mat &logits) {
+    cv::Mat prob = softmax(logits);
+
+    cv::Point classIdPoint;
+    double confidence;
+    cv::minMaxLoc(prob, nullptr, &confidence, nullptr, &classIdPoint);
+    return decide(classIdPoint.x, confidence);
+}
+
+AutoAim::ClassifyResult AutoAim::Classifier::decide(int class_id, double confidence) {
+    return {to_label(confidence > confidence_threshold_ ? class_id : -1), confidence};
+}
+
+AutoAim::Labels AutoAim::Classifier::to_label(int class_id) const {
+    switch (class_id) {
         case 1: return Labels::Hero;
         case 2: return Labels::Engineer;
         case 3: return Labels::Infantry3;
@@ -151,8 +217,7 @@ int AutoAim::Classifier::inference(cv::Mat &src) {
     cv::Mat inputBlob = cv::dnn::blobFromImage(
         src, 1.0 / 255, cv::Size(ModelInputWidth, ModelInputHeight), cv::Scalar(0), false, false
     );
-    net_.setInput(inputBlob);
-    cv::Mat output = net_.forward();
+    cv::Mat output = backend_->forward(inputBlob);
 
     cv::Mat prob = softmax(output.reshape(1, 1));
 
@@ -167,4 +232,7 @@ int AutoAim::Classifier::inference(cv::Mat &src) {
         return -1;
 }
 
-void AutoAim::Classifier::preprocess(cv::Mat &src) { cv::cvtColor(src, src, cv::COLOR_BGR2GRAY); }
\ No newline at end of file
+void AutoAim::Classifier::preprocess(cv::Mat &src) {
+    if (src.channels() == 3)
+        cv::cvtColor(src, src, cv::COLOR_BGR2GRAY);
+}
\ No newline at end of file
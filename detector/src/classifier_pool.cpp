@@ -0,0 +1,50 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "classifier_pool.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.hpp>
+
+AutoAim::ClassifierPool::ClassifierPool(const std::string &config_path, size_t size) {
+    if (size == 0) {
+        try {
+            size = std::max<int64_t>(toml::parse_file(config_path)["mlp"]["pool_size"].value_or(1), 1);
+        } catch (const toml::parse_error &err) {
+            spdlog::error("fail to parse config file, {}", err.description());
+            size = 1;
+        }
+    }
+
+    // 模型只加载一次，其余实例复制推理后端
+    classifiers_.push_back(std::make_unique<Classifier>(config_path));
+    for (size_t i = 1; i < size; ++i)
+        classifiers_.push_back(std::make_unique<Classifier>(*classifiers_.front()));
+    chunks_.resize(size);
+    results_.resize(size);
+
+    if constexpr (InitializationDebug)
+        spdlog::info("classifier pool with {} instances", size);
+}
+
+std::vector<AutoAim::ClassifyResult> AutoAim::ClassifierPool::classify_batch(std::vector<cv::Mat> &rois) {
+    const size_t workers = std::min(classifiers_.size(), rois.size() / min_rois_per_worker_);
+    if (!pool_ || workers <= 1)
+        return classifiers_.front()->classify_batch(rois);
+
+    // 按顺序均分，前 rois.size() % workers 段各多一个
+    const size_t base = rois.size() / workers, extra = rois.size() % workers;
+    for (size_t k = 0, begin = 0; k < workers; ++k) {
+        const size_t count = base + (k < extra);
+        chunks_[k].assign(rois.begin() + begin, rois.begin() + begin + count);
+        begin += count;
+    }
+    pool_->parallel_for(0, workers, [&](size_t k) { results_[k] = classifiers_[k]->classify_batch(chunks_[k]); });
+
+    std::vector<ClassifyResult> results;
+    results.reserve(rois.size());
+    for (size_t k = 0; k < workers; ++k)
+        results.insert(results.end(), results_[k].begin(), results_[k].end());
+    return results;
+}
@@ -2,60 +2,255 @@
 
 #include "detector.hpp"
 #include "config.hpp"
+#include "image_kernels.hpp"
 #include "structs.hpp"
 
+#include <algorithm>
+#include <atomic>
 #include <opencv2/core.hpp>
 #include <opencv2/highgui.hpp>
 #include <opencv2/opencv.hpp>
+#include <tuple>
 
 //! Detector
-AutoAim::Detector::Detector(std::string path) : light_bar_config_(path), armor_config_(path) {
+AutoAim::Detector::Detector(std::string path)
+    : light_bar_config_(path), armor_config_(path), morphology_config_(path), roi_config_(path),
+      tiling_config_(path) {
+    morph_kernel_ = cv::getStructuringElement(
+        morphology_config_.shape, cv::Size(morphology_config_.kernel_size, morphology_config_.kernel_size)
+    );
     spdlog::info("Detector initialized with config file: \"{}\"", path);
 }
 
 std::vector<AutoAim::Armor> AutoAim::Detector::detect(const cv::Mat &img) {
-    auto binary = this->preprocess_image(img);
-    cv::imshow("binary", binary);
-    cv::waitKey();
-    auto lights = this->detect_lightbars(img, binary);
+    this->stats_.frames++;
+    return this->detect_full_frame(img);
+}
+
+std::vector<AutoAim::Armor> AutoAim::Detector::detect(const cv::Mat &img, const std::vector<cv::Rect> &rois) {
+    this->stats_.frames++;
+
+    const bool periodic_full_scan = this->roi_config_.full_scan_interval > 0
+                                 && this->frames_since_full_scan_ >= this->roi_config_.full_scan_interval;
+    if (!this->roi_config_.enable || rois.empty() || periodic_full_scan)
+        return this->detect_full_frame(img);
+
+    this->stats_.roi_frames++;
+    std::vector<LightBar> lights;
+    double scanned = 0;
+    for (const auto &window : this->make_windows(rois, img.size())) {
+        // 窗口用独立的连续缓冲区，cv::dilate 不会读到窗口外（上一帧残留）的像素
+        this->window_buffer_.resize(window.area());
+        cv::Mat binary(window.size(), CV_8UC1, this->window_buffer_.data());
+        this->preprocess_image(img(window), binary, this->morph_scratch_);
+
+        auto found = this->detect_lightbars(img(window), binary, window.tl());
+        lights.insert(lights.end(), found.begin(), found.end());
+        scanned += window.area();
+    }
+    auto armors = this->pair_lightbars(lights);
+
+    if (armors.empty()) {
+        if constexpr (DetectorDebug)
+            spdlog::info("no armor inside {} roi(s), falling back to full frame", rois.size());
+        this->stats_.miss_fallbacks++;
+        return this->detect_full_frame(img);
+    }
+
+    this->frames_since_full_scan_++;
+    this->stats_.roi_hits++;
+    this->stats_.last_frame_roi     = true;
+    this->stats_.last_scanned_ratio = scanned / img.total();
+    return armors;
+}
+
+std::vector<AutoAim::Armor> AutoAim::Detector::detect_full_frame(const cv::Mat &img) {
+    this->frames_since_full_scan_ = 0;
+    this->stats_.full_scans++;
+    this->stats_.last_frame_roi     = false;
+    this->stats_.last_scanned_ratio = 1.0;
+
+    const int stripes = this->stripe_count(img.rows);
+    if (stripes > 1)
+        this->preprocess_striped(img, stripes);
+    else
+        this->preprocess_image(img, this->binary_, this->morph_scratch_);
+
+    if constexpr (DetectorDisplayBinaryDebug) {
+        cv::imshow("binary", this->binary_);
+        cv::waitKey();
+    }
+    auto lights
+        = stripes > 1 ? this->detect_lightbars_striped(img, stripes) : this->detect_lightbars(img, this->binary_);
     auto armors = this->pair_lightbars(lights);
 
     return armors;
 }
 
-cv::Mat AutoAim::Detector::preprocess_image(const cv::Mat &src) {
-    cv::Mat gray, grayColor, binary_color, binary, binary_brightness;
+int AutoAim::Detector::stripe_count(int rows) const {
+    if (!this->pool_)
+        return 1;
+    const auto &cfg = this->tiling_config_;
+    const int wanted = cfg.stripes > 0 ? cfg.stripes : int(this->pool_->size()) + 1;
+    return std::clamp(rows / std::max(cfg.min_stripe_rows, 1), 1, wanted);
+}
+
+void AutoAim::Detector::preprocess_striped(const cv::Mat &img, int stripes) {
+    const int rows = img.rows, halo = this->dilation_radius();
+    this->binary_.create(img.size(), CV_8UC1);
+    this->stripes_.resize(stripes);
+
+    this->pool_->parallel_for(0, stripes, [&](size_t k) {
+        auto &stripe = this->stripes_[k];
+        const int y0 = rows * int(k) / stripes, y1 = rows * int(k + 1) / stripes;
+        // 上下各多处理 halo 行，[y0, y1) 内的膨胀结果与整幅图膨胀逐位一致
+        const int a0 = std::max(y0 - halo, 0), a1 = std::min(y1 + halo, rows);
+        this->preprocess_image(img.rowRange(a0, a1), stripe.binary, stripe.scratch);
+        stripe.binary.rowRange(y0 - a0, y1 - a0).copyTo(this->binary_.rowRange(y0, y1));
+    });
+}
+
+std::vector<AutoAim::LightBar> AutoAim::Detector::detect_lightbars_striped(const cv::Mat &img, int stripes) {
+    if constexpr (DetectorDebug)
+        spdlog::info("detecting lightbars in {} stripes", stripes);
+
+    const int rows = img.rows, overlap = this->tiling_config_.overlap;
+    std::atomic<bool> too_tall{false};
+
+    this->pool_->parallel_for(0, stripes, [&](size_t k) {
+        auto &stripe = this->stripes_[k];
+        const int y0 = rows * int(k) / stripes, y1 = rows * int(k + 1) / stripes;
+        const int c0 = std::max(y0 - overlap, 0), c1 = std::min(y1 + overlap, rows);
+
+        std::vector<std::vector<cv::Point>> contours;
+        std::vector<cv::Vec4i> hierarchy;
+        cv::findContours(
+            this->binary_.rowRange(c0, c1), contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_NONE, cv::Point(0, c0)
+        );
+
+        stripe.lights.clear();
+        for (size_t i = 0; i < contours.size(); ++i) {
+            const cv::Rect rect = cv::boundingRect(contours[i]);
+            // 碰到条带（非图像）上下边界的轮廓被截断了，由完整包含它的相邻条带负责；
+            // 比 overlap 还高的轮廓可能没有条带能完整包含，它外面的孔洞层级也可能被截断
+            if ((c0 > 0 && rect.y == c0) || (c1 < rows && rect.br().y == c1)) {
+                if (rect.height >= overlap)
+                    too_tall.store(true, std::memory_order_relaxed);
+                continue;
+            }
+            // 每个轮廓只由其最上一行所在的条带负责，避免重复
+            if (rect.y < y0 || rect.y >= y1 || contours[i].size() < 5 || hierarchy[i][3] != -1)
+                continue;
+
+            LightBar light(contours[i]);
+            if (light.is_valid(this->light_bar_config_))
+                stripe.lights.push_back(light);
+        }
+    });
+
+    if (too_tall.load()) {
+        if constexpr (DetectorDebug)
+            spdlog::info("contour taller than stripe overlap, extracting lightbars serially");
+        return this->detect_lightbars(img, this->binary_);
+    }
+
+    std::vector<LightBar> lights;
+    for (const auto &stripe : this->stripes_)
+        lights.insert(lights.end(), stripe.lights.begin(), stripe.lights.end());
+
+    if constexpr (DetectorDebug)
+        spdlog::info("detected {} lightbars", lights.size());
+
+    return lights;
+}
+
+int AutoAim::Detector::dilation_radius() const {
+    // 矩形、椭圆、十字的锚点都在中心，每次膨胀最多扩展 kernel_size / 2 个像素
+    const auto &morph = this->morphology_config_;
+    return std::max(morph.iterations, 0) * (morph.kernel_size / 2);
+}
+
+void AutoAim::Detector::set_thread_pool(std::shared_ptr<ThreadPool<>> pool) { pool_ = std::move(pool); }
 
-    // 提取亮度
-    cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
-    cv::threshold(gray, binary_brightness, this->light_bar_config_.brightness_threshold, 255, cv::THRESH_BINARY);
+std::vector<cv::Rect> AutoAim::Detector::make_windows(const std::vector<cv::Rect> &rois, const cv::Size &size) const {
+    // 窗口边缘的灯条会被膨胀截断，额外留出膨胀半径
+    const int margin = this->dilation_radius() + 1;
+    const cv::Rect frame(cv::Point(0, 0), size);
 
-    // 红蓝通道作差，提取颜色
-    std::vector<cv::Mat> channels;
-    cv::split(src, channels);
-    int enemy_color = EnemyColor == RMColor::Blue ? 0 : 2;
-    int ally_color  = EnemyColor == RMColor::Blue ? 2 : 0;
-    cv::subtract(channels[enemy_color], channels[ally_color], grayColor);
+    std::vector<cv::Rect> windows;
+    for (const auto &roi : rois) {
+        const int w  = std::max(roi.width, 0);
+        const int h  = std::max(roi.height, 0);
+        const int px = std::max(int(w * this->roi_config_.padding), (this->roi_config_.min_size - w + 1) / 2) + margin;
+        const int py = std::max(int(h * this->roi_config_.padding), (this->roi_config_.min_size - h + 1) / 2) + margin;
+
+        cv::Rect window = cv::Rect(roi.x - px, roi.y - py, w + 2 * px, h + 2 * py) & frame;
+        if (!window.empty())
+            windows.push_back(window);
+    }
+
+    // 合并相交的窗口，避免同一个灯条被检测两次
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < windows.size() && !merged; ++i)
+            for (size_t j = i + 1; j < windows.size() && !merged; ++j)
+                if ((windows[i] & windows[j]).area() > 0) {
+                    windows[i] |= windows[j];
+                    windows.erase(windows.begin() + j);
+                    merged = true;
+                }
+    }
+
+    return windows;
+}
+
+void AutoAim::Detector::preprocess_image(const cv::Mat &src, cv::Mat &binary, cv::Mat &scratch) {
+    // 一次遍历完成：灰度阈值 && 红蓝通道作差阈值
+    Kernels::LightBarMaskParams params{
+        .enemy_channel        = EnemyColor == RMColor::Blue ? 0 : 2,
+        .ally_channel         = EnemyColor == RMColor::Blue ? 2 : 0,
+        .brightness_threshold = this->light_bar_config_.brightness_threshold,
+        .color_threshold      = this->light_bar_config_.color_threshold,
+    };
+    Kernels::lightbar_mask(src, binary, params);
 
-    cv::threshold(grayColor, binary_color, light_bar_config_.color_threshold, 255, cv::THRESH_BINARY);
-    cv::bitwise_and(binary_brightness, binary_color, binary);
     // cv::erode(binary, binary, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3)), cv::Point(0, 0), 7);
-    cv::dilate(binary, binary, cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3)), cv::Point(-1, -1), 7);
+    this->dilate_binary(binary, scratch);
 
     if constexpr (DetectorDebug)
         spdlog::info("preprocessed image");
+}
+
+void AutoAim::Detector::dilate_binary(cv::Mat &binary, cv::Mat &scratch) {
+    const auto &cfg = this->morphology_config_;
+    if (cfg.iterations <= 0)
+        return;
 
-    return binary;
+    // 3x3 椭圆就是 3x3 十字，膨胀 n 次恰好是半径 n 的 L1 菱形
+    const bool diamond = (cfg.shape == cv::MORPH_ELLIPSE || cfg.shape == cv::MORPH_CROSS) && cfg.kernel_size == 3;
+    // 矩形膨胀 n 次等价于一次边长 n * (k - 1) + 1 的矩形（锚点同样放大 n 倍，与 cv::dilate 一致）；
+    // 窗口较小时 cv::dilate 的逐像素开销更低，较大时 van Herk/Gil-Werman 与窗口大小无关
+    constexpr int kRunningMaxMinSize = 31;
+    const int rect_size = cfg.iterations * (cfg.kernel_size - 1) + 1;
+    const int anchor    = cfg.iterations * (cfg.kernel_size / 2);
+
+    if (!cfg.use_opencv && diamond && cfg.iterations < 255)
+        Kernels::dilate_diamond(binary, binary, cfg.iterations, scratch);
+    else if (!cfg.use_opencv && cfg.shape == cv::MORPH_RECT && rect_size >= kRunningMaxMinSize)
+        Kernels::dilate_rect(binary, binary, cv::Size(rect_size, rect_size), scratch, cv::Point(anchor, anchor));
+    else
+        cv::dilate(binary, binary, this->morph_kernel_, cv::Point(-1, -1), cfg.iterations);
 }
 
-std::vector<AutoAim::LightBar> AutoAim::Detector::detect_lightbars(const cv::Mat &rgb, const cv::Mat &binary) {
+std::vector<AutoAim::LightBar>
+AutoAim::Detector::detect_lightbars(const cv::Mat &rgb, const cv::Mat &binary, cv::Point offset) {
     // 用 contour 轮廓找出灯条
     if constexpr (DetectorDebug)
         spdlog::info("detecting lightbars");
 
     std::vector<std::vector<cv::Point>> contours;
     std::vector<cv::Vec4i> hierarchy;
-    cv::findContours(binary, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_NONE);
+    cv::findContours(binary, contours, hierarchy, cv::RETR_TREE, cv::CHAIN_APPROX_NONE, offset);
 
     if constexpr (DetectorDebug)
         spdlog::info("found {} contours, filtering lightbars", contours.size());
@@ -90,14 +285,37 @@ std::vector<AutoAim::Armor> AutoAim::Detector::pair_lightbars(std::vector<AutoAi
     if constexpr (DetectorDebug)
         spdlog::info("start pairing");
     std::vector<AutoAim::Armor> armors;
+    // 横坐标相同时按轮廓起点排序，使结果与灯条的输入顺序无关（串行、分条带并行的结果一致）
     std::sort(lights.begin(), lights.end(), [](const LightBar &a, const LightBar &b) {
-        return a.center().x < b.center().x;
+        const cv::Point &pa = a.contour.front(), &pb = b.contour.front();
+        return std::make_tuple(a.center().x, pa.y, pa.x) < std::make_tuple(b.center().x, pb.y, pb.x);
     });
 
-    // 两两枚举进行匹配
-    for (auto light1 = lights.begin(); light1 != lights.end(); light1++) {
-        for (auto light2 = light1 + 1; light2 != lights.end(); light2++) {
-            Armor tmp(*light1, *light2);
+    // 合法装甲板满足 |dx| <= 灯条中心距 <= max_aspect_ratio * 平均灯条长度，
+    // 因此从左往右扫描时，右侧灯条超出这个距离即可停止（多留一点余量避免浮点误差）
+    double max_long_axis = 0;
+    for (const auto &light : lights)
+        max_long_axis = std::max(max_long_axis, light.long_axis);
+    const double reach_scale = this->armor_config_.max_aspect_ratio / 2.0 * (1 + 1e-6);
+
+    for (size_t i = 0; i < lights.size(); ++i) {
+        const double reach = reach_scale * (lights[i].long_axis + max_long_axis);
+        for (size_t j = i + 1; j < lights.size() && lights[j].center().x - lights[i].center().x <= reach; ++j) {
+            // 只依赖两个灯条的门限（y 方向重叠、面积比、长度差、角度差等），不满足时不必构造装甲板
+            if (!Armor::may_pair(lights[i], lights[j], this->armor_config_))
+                continue;
+
+            // 检查组成的装甲板是否合法
+            Armor tmp(lights[i], lights[j]);
+            if constexpr (DetectorDebug)
+                spdlog::info("doing armor_validation check");
+            if (!tmp.is_valid(this->armor_config_)) {
+                if constexpr (DetectorDebug)
+                    spdlog::error("armor_validation failed");
+                continue;
+            } else if constexpr (DetectorDebug)
+                spdlog::info("armor_validation passed");
+
             // 检查灯条中间是否还夹着其他灯条，是的话不可能组成装甲板
             if constexpr (DetectorDebug)
                 spdlog::info("checking mispair");
@@ -108,15 +326,7 @@ std::vector<AutoAim::Armor> AutoAim::Detector::pair_lightbars(std::vector<AutoAi
             } else if constexpr (DetectorDebug)
                 spdlog::info("mispair_check passed");
 
-            // 检查组成的装甲板是否合法
-            if constexpr (DetectorDebug)
-                spdlog::info("doing armor_validation check");
-            if (tmp.is_valid(this->armor_config_)) {
-                if constexpr (DetectorDebug)
-                    spdlog::info("armor_validation passed");
-                armors.push_back(tmp);
-            } else if constexpr (DetectorDebug)
-                spdlog::error("armor_validation failed");
+            armors.push_back(tmp);
         }
     }
     if constexpr (DetectorDebug)
@@ -127,12 +337,24 @@ std::vector<AutoAim::Armor> AutoAim::Detector::pair_lightbars(std::vector<AutoAi
 
 bool AutoAim::Detector::check_mispair(const Armor &armor, const std::vector<AutoAim::LightBar> &lights) {
     auto &points = armor.vertices;
-    auto rect    = cv::boundingRect(points);
-    for (const auto &light : lights) {
-        if (light.center() == armor.left.center() || light.center() == armor.right.center())
+    float min_x = points[0].x, max_x = points[0].x, min_y = points[0].y, max_y = points[0].y;
+    for (const auto &p : points) {
+        min_x = std::min(min_x, p.x), max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y), max_y = std::max(max_y, p.y);
+    }
+
+    // lights 按中心横坐标升序，二分找到横坐标落在装甲板外接矩形内的灯条
+    auto first = std::lower_bound(lights.begin(), lights.end(), min_x, [](const LightBar &light, float x) {
+        return light.center().x < x;
+    });
+    for (auto light = first; light != lights.end() && light->center().x <= max_x; ++light) {
+        const cv::Point2f c = light->center();
+        if (c.y < min_y || c.y > max_y)
+            continue;
+        if (c == armor.left.center() || c == armor.right.center())
             continue; // 忽略已经匹配的灯条
 
-        if (cv::pointPolygonTest(points, light.center(), false) >= 0)
+        if (cv::pointPolygonTest(points, c, false) >= 0)
             return true;
     }
 
@@ -0,0 +1,681 @@
+#include "image_kernels.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define IMAGE_KERNELS_X86 1
+#endif
+
+namespace {
+
+// cv::cvtColor(COLOR_BGR2GRAY) 对 8 位图像使用的 15 位定点系数
+constexpr int kGrayShift = 15;
+constexpr int kBY        = 3735;
+constexpr int kGY        = 19235;
+constexpr int kRY        = 9798;
+constexpr int kRound     = 1 << (kGrayShift - 1);
+
+/**
+ * @brief 归一化后的阈值：x > t 等价于 x >= t + 1，t + 1 ∈ [0, 255]
+ */
+struct Thresholds {
+    int enemy, ally;
+    uint8_t brightness_min, color_min;
+};
+
+inline uint8_t gray_of(const uint8_t *px) { return (px[0] * kBY + px[1] * kGY + px[2] * kRY + kRound) >> kGrayShift; }
+
+void mask_row_scalar(const uint8_t *src, uint8_t *dst, int begin, int end, const Thresholds &t) {
+    for (int x = begin; x < end; ++x) {
+        const uint8_t *px = src + 3 * x;
+        const int diff    = std::max(px[t.enemy] - px[t.ally], 0);
+        dst[x]            = (gray_of(px) >= t.brightness_min && diff >= t.color_min) ? 255 : 0;
+    }
+}
+
+#ifdef IMAGE_KERNELS_X86
+
+/**
+ * @brief 8 个 16 位像素 -> 8 个 32 位灰度。High 选择 lane 内的高 4 个还是低 4 个像素
+ */
+template <bool High>
+__attribute__((target("avx2"))) inline __m256i
+gray_epi32(__m256i b16, __m256i g16, __m256i r16, __m256i coeff_bg, __m256i coeff_r1) {
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i bg        = High ? _mm256_unpackhi_epi16(b16, g16) : _mm256_unpacklo_epi16(b16, g16);
+    __m256i r1        = High ? _mm256_unpackhi_epi16(r16, one) : _mm256_unpacklo_epi16(r16, one);
+    __m256i y         = _mm256_add_epi32(_mm256_madd_epi16(bg, coeff_bg), _mm256_madd_epi16(r1, coeff_r1));
+    return _mm256_srli_epi32(y, kGrayShift);
+}
+
+/**
+ * @brief 每次处理 32 个像素，返回已处理的像素数，剩余部分交给标量实现
+ * @details 两个 128 位 lane 各自处理 16 个像素（48 字节），用 pshufb 拆出 B/G/R 三个通道，
+ * 灰度用 pmaddwd 在 32 位上精确计算，再打包回 8 位。所有操作都不跨 lane，像素顺序不变。
+ */
+__attribute__((target("avx2"))) int mask_row_avx2(const uint8_t *src, uint8_t *dst, int cols, const Thresholds &t) {
+    // 48 字节中 B/G/R 在三个 16 字节块内的位置，-1 表示置零
+    const __m256i b0 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+    );
+    const __m256i b1 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1)
+    );
+    const __m256i b2 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)
+    );
+    const __m256i g0 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+    );
+    const __m256i g1 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1)
+    );
+    const __m256i g2 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)
+    );
+    const __m256i r0 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)
+    );
+    const __m256i r1 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1)
+    );
+    const __m256i r2 = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)
+    );
+
+    const __m256i zero     = _mm256_setzero_si256();
+    const __m256i coeff_bg = _mm256_set1_epi32((kGY << 16) | kBY);    // (B, G) * (kBY, kGY)
+    const __m256i coeff_r1 = _mm256_set1_epi32((kRound << 16) | kRY); // (R, 1) * (kRY, kRound)
+    const __m256i bt       = _mm256_set1_epi8(static_cast<char>(t.brightness_min));
+    const __m256i ct       = _mm256_set1_epi8(static_cast<char>(t.color_min));
+
+    int x = 0;
+    for (; x + 32 <= cols; x += 32) {
+        const uint8_t *p = src + 3 * x;
+        __m256i v0       = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 48)),
+            1
+        );
+        __m256i v1 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 16))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 64)),
+            1
+        );
+        __m256i v2 = _mm256_inserti128_si256(
+            _mm256_castsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 32))),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 80)),
+            1
+        );
+
+        __m256i ch[3];
+        ch[0] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, b0), _mm256_shuffle_epi8(v1, b1)), _mm256_shuffle_epi8(v2, b2)
+        );
+        ch[1] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, g0), _mm256_shuffle_epi8(v1, g1)), _mm256_shuffle_epi8(v2, g2)
+        );
+        ch[2] = _mm256_or_si256(
+            _mm256_or_si256(_mm256_shuffle_epi8(v0, r0), _mm256_shuffle_epi8(v1, r1)), _mm256_shuffle_epi8(v2, r2)
+        );
+
+        // 灰度：低 8 个、高 8 个像素分别扩展到 16 位，再在 32 位上乘加
+        __m256i blo = _mm256_unpacklo_epi8(ch[0], zero), bhi = _mm256_unpackhi_epi8(ch[0], zero);
+        __m256i glo = _mm256_unpacklo_epi8(ch[1], zero), ghi = _mm256_unpackhi_epi8(ch[1], zero);
+        __m256i rlo = _mm256_unpacklo_epi8(ch[2], zero), rhi = _mm256_unpackhi_epi8(ch[2], zero);
+
+        __m256i ylo = _mm256_packs_epi32(
+            gray_epi32<false>(blo, glo, rlo, coeff_bg, coeff_r1), gray_epi32<true>(blo, glo, rlo, coeff_bg, coeff_r1)
+        );
+        __m256i yhi = _mm256_packs_epi32(
+            gray_epi32<false>(bhi, ghi, rhi, coeff_bg, coeff_r1), gray_epi32<true>(bhi, ghi, rhi, coeff_bg, coeff_r1)
+        );
+        __m256i y   = _mm256_packus_epi16(ylo, yhi);
+
+        // x >= t  <=>  max(x, t) == x
+        __m256i diff    = _mm256_subs_epu8(ch[t.enemy], ch[t.ally]);
+        __m256i bright  = _mm256_cmpeq_epi8(_mm256_max_epu8(y, bt), y);
+        __m256i colored = _mm256_cmpeq_epi8(_mm256_max_epu8(diff, ct), diff);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + x), _mm256_and_si256(bright, colored));
+    }
+    return x;
+}
+
+#endif // IMAGE_KERNELS_X86
+
+bool resolve(const AutoAim::Kernels::LightBarMaskParams &params, Thresholds &t) {
+    // threshold(THRESH_BINARY) 在阈值 >= 255 时输出全 0，阈值 < 0 时输出全 255
+    if (params.brightness_threshold >= 255 || params.color_threshold >= 255)
+        return false;
+    t.enemy          = params.enemy_channel;
+    t.ally           = params.ally_channel;
+    t.brightness_min = static_cast<uint8_t>(std::max(params.brightness_threshold, -1) + 1);
+    t.color_min      = static_cast<uint8_t>(std::max(params.color_threshold, -1) + 1);
+    return true;
+}
+
+// ========================================================
+// Morphology helpers
+// 以整行为单位的逐元素运算，SSE2 向量化，尾部标量处理
+// ========================================================
+
+// 行内是否有非 0 像素
+bool row_has_foreground(const uint8_t *row, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    __m128i any = _mm_setzero_si128();
+    for (; x + 16 <= cols; x += 16)
+        any = _mm_or_si128(any, _mm_loadu_si128(reinterpret_cast<const __m128i *>(row + x)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xFFFF)
+        return true;
+#endif
+    for (; x < cols; ++x)
+        if (row[x])
+            return true;
+    return false;
+}
+
+// v[x] = src[x] ? 0 : min(prev[x] + 1, cap)；prev 为空时视为全 cap
+void seed_row(uint8_t *v, const uint8_t *src, const uint8_t *prev, uint8_t cap, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vcap = _mm_set1_epi8(static_cast<char>(cap));
+    const __m128i one  = _mm_set1_epi8(1);
+    const __m128i zero = _mm_setzero_si128();
+    for (; x + 16 <= cols; x += 16) {
+        __m128i background = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + x)), zero);
+        __m128i base       = vcap;
+        if (prev)
+            base = _mm_min_epu8(_mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + x)), one), vcap);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(v + x), _mm_and_si128(background, base));
+    }
+#endif
+    for (; x < cols; ++x)
+        v[x] = src[x] ? 0 : (prev ? std::min(prev[x] + 1, static_cast<int>(cap)) : cap);
+}
+
+// v[x] = min(v[x], prev[x] + step)，饱和加法
+void min_add_row(uint8_t *v, const uint8_t *prev, uint8_t step, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vs = _mm_set1_epi8(static_cast<char>(step));
+    for (; x + 16 <= cols; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x));
+        __m128i b = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + x)), vs);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(v + x), _mm_min_epu8(a, b));
+    }
+#endif
+    for (; x < cols; ++x)
+        v[x] = std::min<int>(v[x], std::min(prev[x] + step, 255));
+}
+
+// v[x] = prev[x] + step，饱和加法
+void add_row(uint8_t *v, const uint8_t *prev, uint8_t step, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vs = _mm_set1_epi8(static_cast<char>(step));
+    for (; x + 16 <= cols; x += 16) {
+        __m128i b = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(prev + x)), vs);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(v + x), b);
+    }
+#endif
+    for (; x < cols; ++x)
+        v[x] = std::min(prev[x] + step, 255);
+}
+
+// out[x] = min(in[x], in[x - s] + s, in[x + s] + s)，in 两侧需各有 s 个可读元素
+void shifted_min_row(uint8_t *out, const uint8_t *in, int s, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vs = _mm_set1_epi8(static_cast<char>(s));
+    for (; x + 16 <= cols; x += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+        __m128i l = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x - s)), vs);
+        __m128i r = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x + s)), vs);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_min_epu8(c, _mm_min_epu8(l, r)));
+    }
+#endif
+    for (; x < cols; ++x)
+        out[x] = std::min<int>(in[x], std::min(std::min(in[x - s], in[x + s]) + s, 255));
+}
+
+// dst[x] = min(in[x], in[x - s] + s, in[x + s] + s) <= radius ? 255 : 0
+void shifted_min_threshold_row(uint8_t *dst, const uint8_t *in, int s, uint8_t radius, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vs = _mm_set1_epi8(static_cast<char>(s));
+    const __m128i vr = _mm_set1_epi8(static_cast<char>(radius));
+    for (; x + 16 <= cols; x += 16) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x));
+        __m128i l = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x - s)), vs);
+        __m128i r = _mm_adds_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + x + s)), vs);
+        __m128i m = _mm_min_epu8(c, _mm_min_epu8(l, r));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_cmpeq_epi8(_mm_min_epu8(m, vr), m));
+    }
+#endif
+    for (; x < cols; ++x)
+        dst[x] = std::min<int>(in[x], std::min(in[x - s], in[x + s]) + s) <= radius ? 255 : 0;
+}
+
+// dst[x] = v[x] <= radius ? 255 : 0
+void threshold_row(uint8_t *dst, const uint8_t *v, uint8_t radius, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    const __m128i vr = _mm_set1_epi8(static_cast<char>(radius));
+    for (; x + 16 <= cols; x += 16) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(v + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + x), _mm_cmpeq_epi8(_mm_min_epu8(a, vr), a));
+    }
+#endif
+    for (; x < cols; ++x)
+        dst[x] = v[x] <= radius ? 255 : 0;
+}
+
+// out[x] = max(a[x], b[x])
+void max_row(uint8_t *out, const uint8_t *a, const uint8_t *b, int cols) {
+    int x = 0;
+#ifdef __SSE2__
+    for (; x + 16 <= cols; x += 16) {
+        __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + x));
+        __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + x));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + x), _mm_max_epu8(va, vb));
+    }
+#endif
+    for (; x < cols; ++x)
+        out[x] = std::max(a[x], b[x]);
+}
+
+// 源坐标的截断范围，超出后 4 个邻点都在图像外，转换为 int 也不会溢出
+constexpr float kCoordLimit = 1 << 24;
+// 每次计算这么多个输出像素的源坐标，放在栈上
+constexpr int kCoordChunk = 64;
+// 定点亮度 -> 灰度值
+constexpr float kLumaScale = 1.0f / (1 << kGrayShift);
+
+/**
+ * @brief 求第 y 行 [x0, x0 + n) 输出像素的源坐标
+ */
+void warp_coords(const double *M, int x0, int y, int n, float *X, float *Y) {
+    const double sx0 = M[1] * y + M[2], sy0 = M[4] * y + M[5], w0 = M[7] * y + M[8];
+    for (int i = 0; i < n; ++i) {
+        const int x = x0 + i;
+        double w    = w0 + M[6] * x;
+        w           = w ? 1 / w : 0;
+        X[i]        = static_cast<float>(std::clamp((sx0 + M[0] * x) * w, double(-kCoordLimit), double(kCoordLimit)));
+        Y[i]        = static_cast<float>(std::clamp((sy0 + M[3] * x) * w, double(-kCoordLimit), double(kCoordLimit)));
+    }
+}
+
+// 未舍入的 15 位定点亮度
+inline int luma_of(const uint8_t *px) { return px[0] * kBY + px[1] * kGY + px[2] * kRY; }
+
+/**
+ * @brief 标量采样 [begin, end) 的输出像素，图像外的邻点按 0 处理（BORDER_CONSTANT）
+ * @details 4 个邻点的亮度不舍入，在 float 上双线性插值后只舍入一次，运算顺序与 AVX2 实现相同
+ */
+void warp_row_scalar(
+    const uint8_t *bgr, size_t step, int rows, int cols, const float *X, const float *Y, uint8_t *dst, int begin,
+    int end
+) {
+    auto luma = [&](int x, int y) {
+        const bool inside = unsigned(x) < unsigned(cols) && unsigned(y) < unsigned(rows);
+        return static_cast<float>(inside ? luma_of(bgr + size_t(y) * step + 3 * size_t(x)) : 0);
+    };
+    for (int i = begin; i < end; ++i) {
+        // |X|, |Y| <= kCoordLimit，截断后修正即为 floor
+        const int sx    = static_cast<int>(X[i]) - (X[i] < static_cast<int>(X[i]));
+        const int sy    = static_cast<int>(Y[i]) - (Y[i] < static_cast<int>(Y[i]));
+        const float fx  = X[i] - sx, fy = Y[i] - sy;
+        const float top = luma(sx, sy) * (1 - fx) + luma(sx + 1, sy) * fx;
+        const float bot = luma(sx, sy + 1) * (1 - fx) + luma(sx + 1, sy + 1) * fx;
+        dst[i]          = static_cast<uint8_t>(std::lrint((top * (1 - fy) + bot * fy) * kLumaScale));
+    }
+}
+
+#ifdef IMAGE_KERNELS_X86
+
+// 每个 32 位 lane 的低 3 字节是一个 BGR 像素 -> 未舍入的 15 位定点亮度
+__attribute__((target("avx2"))) inline __m256 luma_ps(__m256i px) {
+    // (B, G) 与 (R, 0) 扩展为 16 位后各做一次 pmaddwd
+    const __m256i shuf_bg = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(0, -1, 1, -1, 4, -1, 5, -1, 8, -1, 9, -1, 12, -1, 13, -1)
+    );
+    const __m256i shuf_r = _mm256_broadcastsi128_si256(
+        _mm_setr_epi8(2, -1, -1, -1, 6, -1, -1, -1, 10, -1, -1, -1, 14, -1, -1, -1)
+    );
+    const __m256i bg = _mm256_madd_epi16(_mm256_shuffle_epi8(px, shuf_bg), _mm256_set1_epi32((kGY << 16) | kBY));
+    const __m256i r  = _mm256_madd_epi16(_mm256_shuffle_epi8(px, shuf_r), _mm256_set1_epi32(kRY));
+    return _mm256_cvtepi32_ps(_mm256_add_epi32(bg, r));
+}
+
+// a * wa + b * wb，不使用 FMA，与标量实现的舍入相同
+__attribute__((target("avx2"))) inline __m256 lerp_ps(__m256 a, __m256 b, __m256 wa, __m256 wb) {
+    return _mm256_add_ps(_mm256_mul_ps(a, wa), _mm256_mul_ps(b, wb));
+}
+
+/**
+ * @brief 第 x 列起 4 个输出像素的源坐标，运算顺序与 warp_coords 相同，结果逐位一致
+ * @param sx0, sy0, w0 当前行的常数项，见 warp_coords
+ */
+__attribute__((target("avx2"))) inline void
+coords_pd(const double *M, __m256d sx0, __m256d sy0, __m256d w0, int x, __m128 &X, __m128 &Y) {
+    const __m256d lo = _mm256_set1_pd(-kCoordLimit), hi = _mm256_set1_pd(kCoordLimit);
+    const __m256d vx = _mm256_add_pd(_mm256_set1_pd(x), _mm256_setr_pd(0, 1, 2, 3));
+
+    __m256d w          = _mm256_add_pd(w0, _mm256_mul_pd(_mm256_set1_pd(M[6]), vx));
+    const __m256d zero = _mm256_cmp_pd(w, _mm256_setzero_pd(), _CMP_EQ_OQ);
+    w                  = _mm256_andnot_pd(zero, _mm256_div_pd(_mm256_set1_pd(1), w)); // w == 0 时取 0
+
+    const __m256d sx = _mm256_mul_pd(_mm256_add_pd(sx0, _mm256_mul_pd(_mm256_set1_pd(M[0]), vx)), w);
+    const __m256d sy = _mm256_mul_pd(_mm256_add_pd(sy0, _mm256_mul_pd(_mm256_set1_pd(M[3]), vx)), w);
+    X                = _mm256_cvtpd_ps(_mm256_min_pd(_mm256_max_pd(sx, lo), hi));
+    Y                = _mm256_cvtpd_ps(_mm256_min_pd(_mm256_max_pd(sy, lo), hi));
+}
+
+/**
+ * @brief 采样第 y 行的输出像素，每次 8 个，4 个邻点用 4 次 gather 读取
+ * @details 源坐标用 double 向量计算，运算顺序与 warp_coords 相同。
+ * 每次 gather 读 4 字节（一个 BGR 像素加下一个像素的 B），因此要求 sx + 2 < cols、sy + 1 < rows，
+ * 不满足的一组（靠近图像边缘）交给标量实现。要求 rows * step 不超过 32 位偏移的范围
+ */
+__attribute__((target("avx2"))) void warp_row_avx2(
+    const uint8_t *bgr, size_t step, int rows, int cols, const double *M, int y, uint8_t *dst, int width
+) {
+    const int *p00 = reinterpret_cast<const int *>(bgr);
+    const int *p01 = reinterpret_cast<const int *>(bgr + 3);
+    const int *p10 = reinterpret_cast<const int *>(bgr + step);
+    const int *p11 = reinterpret_cast<const int *>(bgr + step + 3);
+
+    const __m256d sx0   = _mm256_set1_pd(M[1] * y + M[2]);
+    const __m256d sy0   = _mm256_set1_pd(M[4] * y + M[5]);
+    const __m256d w0    = _mm256_set1_pd(M[7] * y + M[8]);
+    const __m256i neg   = _mm256_set1_epi32(-1);
+    const __m256i lim_x = _mm256_set1_epi32(cols - 2);
+    const __m256i lim_y = _mm256_set1_epi32(rows - 1);
+    const __m256i vstep = _mm256_set1_epi32(static_cast<int>(step));
+    const __m256i lanes = _mm256_setr_epi32(0, 4, 0, 0, 0, 0, 0, 0);
+    const __m256 one    = _mm256_set1_ps(1.0f);
+    const __m256 scale  = _mm256_set1_ps(kLumaScale);
+
+    int i = 0;
+    for (; i + 8 <= width; i += 8) {
+        __m128 x_lo, y_lo, x_hi, y_hi;
+        coords_pd(M, sx0, sy0, w0, i, x_lo, y_lo);
+        coords_pd(M, sx0, sy0, w0, i + 4, x_hi, y_hi);
+        const __m256 vx  = _mm256_set_m128(x_hi, x_lo), vy = _mm256_set_m128(y_hi, y_lo);
+        const __m256 flx = _mm256_floor_ps(vx), fly = _mm256_floor_ps(vy);
+        const __m256i sx = _mm256_cvttps_epi32(flx), sy = _mm256_cvttps_epi32(fly);
+
+        const __m256i inside = _mm256_and_si256(
+            _mm256_and_si256(_mm256_cmpgt_epi32(sx, neg), _mm256_cmpgt_epi32(lim_x, sx)),
+            _mm256_and_si256(_mm256_cmpgt_epi32(sy, neg), _mm256_cmpgt_epi32(lim_y, sy))
+        );
+        if (_mm256_movemask_epi8(inside) != -1) {
+            float X[8], Y[8];
+            _mm256_storeu_ps(X, vx);
+            _mm256_storeu_ps(Y, vy);
+            warp_row_scalar(bgr, step, rows, cols, X, Y, dst + i, 0, 8);
+            continue;
+        }
+
+        const __m256i off
+            = _mm256_add_epi32(_mm256_mullo_epi32(sy, vstep), _mm256_add_epi32(sx, _mm256_add_epi32(sx, sx)));
+        const __m256 fx  = _mm256_sub_ps(vx, flx), fy = _mm256_sub_ps(vy, fly);
+        const __m256 ifx = _mm256_sub_ps(one, fx), ify = _mm256_sub_ps(one, fy);
+
+        const __m256 top = lerp_ps(
+            luma_ps(_mm256_i32gather_epi32(p00, off, 1)), luma_ps(_mm256_i32gather_epi32(p01, off, 1)), ifx, fx
+        );
+        const __m256 bot = lerp_ps(
+            luma_ps(_mm256_i32gather_epi32(p10, off, 1)), luma_ps(_mm256_i32gather_epi32(p11, off, 1)), ifx, fx
+        );
+        const __m256i v = _mm256_cvtps_epi32(_mm256_mul_ps(lerp_ps(top, bot, ify, fy), scale));
+
+        // 8 个 32 位 -> 8 字节：两次饱和打包后每个 lane 的第一个 32 位分别是前 4 个、后 4 个像素
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(v, v), _mm256_setzero_si256());
+        packed         = _mm256_permutevar8x32_epi32(packed, lanes);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst + i), _mm256_castsi256_si128(packed));
+    }
+    if (i < width) {
+        float X[8], Y[8];
+        warp_coords(M, i, y, width - i, X, Y);
+        warp_row_scalar(bgr, step, rows, cols, X, Y, dst + i, 0, width - i);
+    }
+}
+
+#endif // IMAGE_KERNELS_X86
+
+} // namespace
+
+bool AutoAim::Kernels::has_avx2() {
+#ifdef IMAGE_KERNELS_X86
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void AutoAim::Kernels::lightbar_mask_scalar(
+    const uint8_t *bgr, size_t bgr_step, uint8_t *mask, size_t mask_step, int rows, int cols,
+    const LightBarMaskParams &params
+) {
+    Thresholds t;
+    if (!resolve(params, t)) {
+        for (int y = 0; y < rows; ++y)
+            std::memset(mask + y * mask_step, 0, cols);
+        return;
+    }
+    for (int y = 0; y < rows; ++y)
+        mask_row_scalar(bgr + y * bgr_step, mask + y * mask_step, 0, cols, t);
+}
+
+void AutoAim::Kernels::lightbar_mask(
+    const uint8_t *bgr, size_t bgr_step, uint8_t *mask, size_t mask_step, int rows, int cols,
+    const LightBarMaskParams &params
+) {
+#ifdef IMAGE_KERNELS_X86
+    Thresholds t;
+    if (has_avx2() && resolve(params, t)) {
+        for (int y = 0; y < rows; ++y) {
+            const uint8_t *src = bgr + y * bgr_step;
+            uint8_t *dst       = mask + y * mask_step;
+            mask_row_scalar(src, dst, mask_row_avx2(src, dst, cols, t), cols, t);
+        }
+        return;
+    }
+#endif
+    lightbar_mask_scalar(bgr, bgr_step, mask, mask_step, rows, cols, params);
+}
+
+void AutoAim::Kernels::lightbar_mask(const cv::Mat &bgr, cv::Mat &mask, const LightBarMaskParams &params) {
+    CV_Assert(bgr.type() == CV_8UC3);
+    mask.create(bgr.size(), CV_8UC1); // 尺寸、类型一致时不会重新分配
+    lightbar_mask(bgr.ptr<uint8_t>(), bgr.step, mask.ptr<uint8_t>(), mask.step, bgr.rows, bgr.cols, params);
+}
+
+void AutoAim::Kernels::dilate_diamond(const cv::Mat &src, cv::Mat &dst, int radius, cv::Mat &scratch) {
+    CV_Assert(src.type() == CV_8UC1 && radius >= 0 && radius < 255);
+    const int rows = src.rows, cols = src.cols;
+    const uint8_t cap = radius + 1; // 距离截断值，> radius 即为背景
+    const int pad     = std::max(radius, 1);
+
+    // L1 距离可分离：先求每列到最近前景像素的竖直距离 V，再沿行做 min_k(V(x + k) + |k|)
+    // scratch 前 rows 行存 V，最后两行是水平方向的乒乓缓冲；每行两侧各留 pad 个 cap
+    scratch.create(rows + 2, cols + 2 * pad, CV_8UC1);
+    for (int y = 0; y < rows + 2; ++y) {
+        std::memset(scratch.ptr<uint8_t>(y), cap, pad);
+        std::memset(scratch.ptr<uint8_t>(y) + pad + cols, cap, pad);
+    }
+    auto V          = [&](int y) { return scratch.ptr<uint8_t>(y) + pad; };
+    uint8_t *buf[2] = {V(rows), V(rows + 1)};
+
+    //* 竖直方向正向：V(y) = min(seed(y), V(y - 1) + 1)。离上一个非空行超过 radius 的行不计算
+    thread_local std::vector<int> last_filled;
+    last_filled.resize(rows);
+    int last = -2 * (radius + 1);
+    for (int y = 0; y < rows; ++y) {
+        const uint8_t *row    = src.ptr<uint8_t>(y);
+        const bool prev_valid = y > 0 && y - 1 - last <= radius;
+        if (row_has_foreground(row, cols)) {
+            seed_row(V(y), row, prev_valid ? V(y - 1) : nullptr, cap, cols);
+            last = y;
+        } else if (y - last <= radius)
+            add_row(V(y), V(y - 1), 1, cols);
+        last_filled[y] = last;
+    }
+
+    //* 竖直方向反向 + 水平方向 + 输出。src 已经读完，dst 可以就是 src
+    dst.create(src.size(), CV_8UC1);
+    bool next_valid = false;             // V(y + 1) 是否有效
+    int below       = rows + radius + 1; // y 及以下最近的非空行
+    for (int y = rows - 1; y >= 0; --y) {
+        if (last_filled[y] == y)
+            below = y;
+        const bool fwd_valid = y - last_filled[y] <= radius;
+        const bool bwd_valid = below - y <= radius;
+
+        uint8_t *out = dst.ptr<uint8_t>(y);
+        if (!fwd_valid && !bwd_valid) { // 上下 radius 行内都没有前景
+            std::memset(out, 0, cols);
+            next_valid = false;
+            continue;
+        }
+        if (fwd_valid && next_valid)
+            min_add_row(V(y), V(y + 1), 1, cols);
+        else if (next_valid)
+            add_row(V(y), V(y + 1), 1, cols);
+        next_valid = true;
+
+        if (radius == 0) {
+            threshold_row(out, V(y), radius, cols);
+            continue;
+        }
+
+        // 偏移 1, 2, 4, ... 的三点最小值依次复合，等价于 |k| <= radius 的 min(V(x + k) + |k|)，最后一步直接输出
+        const uint8_t *in = V(y);
+        for (int step = 1, done = 0, cur = 0; done < radius; step <<= 1, cur ^= 1) {
+            const int s = std::min(step, radius - done);
+            done += s;
+            if (done == radius)
+                shifted_min_threshold_row(out, in, s, radius, cols);
+            else {
+                shifted_min_row(buf[cur], in, s, cols);
+                in = buf[cur];
+            }
+        }
+    }
+}
+
+void AutoAim::Kernels::dilate_rect(
+    const cv::Mat &src, cv::Mat &dst, cv::Size ksize, cv::Mat &scratch, cv::Point anchor
+) {
+    CV_Assert(src.type() == CV_8UC1 && ksize.width > 0 && ksize.height > 0);
+    const int rows = src.rows, cols = src.cols;
+    const int kw = ksize.width, kh = ksize.height;
+    const int ax = anchor.x < 0 ? kw / 2 : anchor.x, ay = anchor.y < 0 ? kh / 2 : anchor.y;
+    const int pad = kw;
+
+    // scratch：rows 行水平结果 H，kh 行后缀最大值 h，kh 行前缀最大值 g，2 行水平乒乓缓冲，1 行全 0
+    scratch.create(rows + 2 * kh + 3, cols + 2 * pad, CV_8UC1);
+    auto H          = [&](int y) { return scratch.ptr<uint8_t>(y); };
+    auto h_row      = [&](int j) { return scratch.ptr<uint8_t>(rows + j); };
+    auto g_row      = [&](int j) { return scratch.ptr<uint8_t>(rows + kh + j); };
+    uint8_t *buf[2] = {scratch.ptr<uint8_t>(rows + 2 * kh) + pad, scratch.ptr<uint8_t>(rows + 2 * kh + 1) + pad};
+    uint8_t *zeros  = scratch.ptr<uint8_t>(rows + 2 * kh + 2);
+    std::memset(zeros, 0, cols);
+
+    //* 水平方向：M_2k(x) = max(M_k(x), M_k(x + k))，窗口 [x - ax, x - ax + kw) 由两个 M_p 覆盖
+    int p = 1;
+    while (p * 2 <= kw)
+        p *= 2;
+    for (int y = 0; y < rows; ++y) {
+        int cur = 0;
+        std::memset(buf[cur] - pad, 0, pad);
+        std::memcpy(buf[cur], src.ptr<uint8_t>(y), cols);
+        std::memset(buf[cur] + cols, 0, pad);
+        for (int k = 1; k < p; k <<= 1) {
+            max_row(buf[cur ^ 1] - pad, buf[cur] - pad, buf[cur] - pad + k, cols + 2 * pad - 2 * k);
+            cur ^= 1;
+        }
+        max_row(H(y), buf[cur] - ax, buf[cur] - ax + kw - p, cols);
+    }
+
+    //* 竖直方向：van Herk/Gil-Werman。窗口起点 i 对应输入行 i - ay，按 kh 分块；
+    // 起点在块 b 内的窗口跨越块 b、b + 1，结果为 max(块 b 后缀最大值, 块 b + 1 前缀最大值)
+    auto row_in = [&](int i) -> const uint8_t * {
+        int y = i - ay;
+        return y >= 0 && y < rows ? H(y) : zeros;
+    };
+
+    dst.create(src.size(), CV_8UC1);
+    for (int b = 0; b * kh < rows; ++b) {
+        const int begin = b * kh, next = begin + kh;
+        std::memcpy(h_row(kh - 1), row_in(next - 1), cols);
+        for (int j = kh - 2; j >= 0; --j)
+            max_row(h_row(j), h_row(j + 1), row_in(begin + j), cols);
+        std::memcpy(g_row(0), row_in(next), cols);
+        for (int j = 1; j < kh - 1; ++j)
+            max_row(g_row(j), g_row(j - 1), row_in(next + j), cols);
+
+        // 起点恰好是块首时窗口就是整个块 b
+        std::memcpy(dst.ptr<uint8_t>(begin), h_row(0), cols);
+        for (int j = 1; j < kh && begin + j < rows; ++j)
+            max_row(dst.ptr<uint8_t>(begin + j), h_row(j), g_row(j - 1), cols);
+    }
+}
+
+void AutoAim::Kernels::warp_gray_patch_scalar(
+    const uint8_t *bgr, size_t bgr_step, int rows, int cols, const double dst_to_src[9], uint8_t *patch,
+    size_t patch_step, int width, int height
+) {
+    float X[kCoordChunk], Y[kCoordChunk];
+    for (int y = 0; y < height; ++y) {
+        for (int x0 = 0; x0 < width; x0 += kCoordChunk) {
+            const int n = std::min(kCoordChunk, width - x0);
+            warp_coords(dst_to_src, x0, y, n, X, Y);
+            warp_row_scalar(bgr, bgr_step, rows, cols, X, Y, patch + y * patch_step + x0, 0, n);
+        }
+    }
+}
+
+void AutoAim::Kernels::warp_gray_patch(
+    const uint8_t *bgr, size_t bgr_step, int rows, int cols, const double dst_to_src[9], uint8_t *patch,
+    size_t patch_step, int width, int height
+) {
+#ifdef IMAGE_KERNELS_X86
+    // gather 使用 32 位偏移
+    if (has_avx2() && rows > 1 && cols > 2 && size_t(rows) * bgr_step <= size_t(INT_MAX)) {
+        for (int y = 0; y < height; ++y)
+            warp_row_avx2(bgr, bgr_step, rows, cols, dst_to_src, y, patch + y * patch_step, width);
+        return;
+    }
+#endif
+    warp_gray_patch_scalar(bgr, bgr_step, rows, cols, dst_to_src, patch, patch_step, width, height);
+}
+
+void AutoAim::Kernels::warp_gray_patch(
+    const cv::Mat &bgr, const cv::Matx33d &src_to_dst, cv::Mat &patch, cv::Size size
+) {
+    CV_Assert(bgr.type() == CV_8UC3);
+    patch.create(size, CV_8UC1); // 尺寸、类型一致时不会重新分配
+    const cv::Matx33d dst_to_src = src_to_dst.inv(cv::DECOMP_LU); // 与 warpPerspective 相同
+    warp_gray_patch(
+        bgr.ptr<uint8_t>(),
+        bgr.step,
+        bgr.rows,
+        bgr.cols,
+        dst_to_src.val,
+        patch.ptr<uint8_t>(),
+        patch.step,
+        size.width,
+        size.height
+    );
+}
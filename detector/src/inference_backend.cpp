@@ -0,0 +1,248 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "inference_backend.hpp"
+#include "config.hpp"
+#include "int8_mlp.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+namespace {
+
+std::shared_ptr<const std::vector<uchar>> read_model_file(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("cannot open model " + path);
+    return std::make_shared<const std::vector<uchar>>(
+        std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()
+    );
+}
+
+} // namespace
+
+namespace AutoAim {
+#ifdef AUTOAIM_WITH_ONNXRUNTIME
+// 见 onnxruntime_backend.cpp
+std::unique_ptr<InferenceBackend> make_onnxruntime_backend(const std::string &model_path);
+#endif
+} // namespace AutoAim
+
+// ========================================================
+// InferenceBackend
+// ========================================================
+
+cv::Mat AutoAim::InferenceBackend::forward_each(const cv::Mat &blob) {
+    const int n = blob.size[0];
+    std::vector<int> shape(blob.size.p, blob.size.p + blob.dims);
+    shape[0]            = 1;
+    const size_t sample = blob.total() / n;
+
+    cv::Mat output;
+    for (int i = 0; i < n; ++i) {
+        const cv::Mat one(shape, CV_32F, const_cast<float *>(blob.ptr<float>()) + i * sample);
+        output.push_back(forward(one).reshape(1, 1));
+    }
+    return output;
+}
+
+// ========================================================
+// OpenCV DNN
+// ========================================================
+
+AutoAim::OpenCvDnnBackend::OpenCvDnnBackend(const std::string &model_path)
+    : OpenCvDnnBackend(read_model_file(model_path)) {}
+
+AutoAim::OpenCvDnnBackend::OpenCvDnnBackend(std::shared_ptr<const std::vector<uchar>> model)
+    : model_(std::move(model)), net_(cv::dnn::readNetFromONNX(*model_)) {}
+
+std::unique_ptr<AutoAim::InferenceBackend> AutoAim::OpenCvDnnBackend::clone() const {
+    std::unique_ptr<OpenCvDnnBackend> copy(new OpenCvDnnBackend(model_));
+    copy->batch_supported_ = batch_supported_;
+    return copy;
+}
+
+cv::Mat AutoAim::OpenCvDnnBackend::forward(const cv::Mat &blob) {
+    const int n = blob.size[0];
+    if (batch_supported_ || n == 1) {
+        try {
+            net_.setInput(blob);
+            cv::Mat output = net_.forward();
+            CV_Assert(output.size[0] == n); // 固定 batch 的模型会在这里失败
+            return output.reshape(1, n).clone();
+        } catch (const cv::Exception &e) {
+            if (n == 1)
+                throw;
+            spdlog::warn("model does not accept batched input, classifying one by one: {}", e.what());
+            batch_supported_ = false;
+        }
+    }
+    return forward_each(blob);
+}
+
+// ========================================================
+// Native MLP
+// ========================================================
+
+AutoAim::DenseNetwork AutoAim::read_dense_network(const std::string &model_path) {
+    cv::dnn::Net net = cv::dnn::readNetFromONNX(model_path);
+    DenseNetwork network;
+    auto &layers = network.layers;
+
+    // 按拓扑顺序读取各层，只接受全连接、ReLU 以及不改变数据的层
+    for (const auto &layer_name : net.getLayerNames()) {
+        cv::Ptr<cv::dnn::Layer> layer = net.getLayer(net.getLayerId(layer_name));
+        const std::string &type       = layer->type;
+
+        if (network.softmax)
+            throw std::runtime_error("layer after softmax: " + layer_name);
+        if (type == "InnerProduct") {
+            if (layer->blobs.empty())
+                throw std::runtime_error("fully connected layer without constant weights: " + layer_name);
+            const cv::Mat weights = layer->blobs[0].reshape(1, layer->blobs[0].size[0]); // 输出 x 输入
+            CV_Assert(weights.type() == CV_32F);
+
+            DenseLayer dense;
+            dense.outputs = weights.rows;
+            dense.inputs  = weights.cols;
+            if (!layers.empty() && layers.back().outputs != dense.inputs)
+                throw std::runtime_error("layer size mismatch: " + layer_name);
+
+            dense.weights.resize(size_t(dense.inputs) * dense.outputs);
+            for (int o = 0; o < dense.outputs; ++o)
+                for (int i = 0; i < dense.inputs; ++i)
+                    dense.weights[size_t(i) * dense.outputs + o] = weights.at<float>(o, i);
+            dense.bias.assign(dense.outputs, 0.0f);
+            if (layer->blobs.size() > 1)
+                std::copy_n(layer->blobs[1].ptr<float>(), dense.outputs, dense.bias.begin());
+            layers.push_back(std::move(dense));
+        } else if (type == "ReLU") {
+            if (layers.empty() || layers.back().relu)
+                throw std::runtime_error("unexpected activation: " + layer_name);
+            layers.back().relu = true;
+        } else if (type == "Softmax") {
+            network.softmax = true;
+        } else if (type != "Flatten" && type != "Reshape" && type != "Identity" && type != "Dropout")
+            throw std::runtime_error("unsupported layer type " + type + ": " + layer_name);
+    }
+    if (layers.empty())
+        throw std::runtime_error("no fully connected layer found");
+    return network;
+}
+
+AutoAim::MlpBackend::MlpBackend(const std::string &model_path) : MlpBackend(read_dense_network(model_path)) {}
+
+AutoAim::MlpBackend::MlpBackend(DenseNetwork network) : network_(std::move(network)) {
+    if constexpr (InitializationDebug) {
+        const auto &layers   = network_.layers;
+        std::string topology = std::to_string(layers.front().inputs);
+        for (const auto &layer : layers)
+            topology += " -> " + std::to_string(layer.outputs) + (layer.relu ? " (relu)" : "");
+        spdlog::info("native mlp backend: {}{}", topology, network_.softmax ? " -> softmax" : "");
+    }
+}
+
+cv::Mat AutoAim::MlpBackend::forward(const cv::Mat &blob) {
+    const auto &layers = network_.layers;
+    const int n        = blob.size[0];
+    CV_Assert(blob.type() == CV_32F && blob.isContinuous());
+    CV_Assert(blob.total() == size_t(n) * layers.front().inputs);
+
+    cv::Mat output(n, layers.back().outputs, CV_32F);
+    const float *x = blob.ptr<float>();
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const DenseLayer &layer = layers[l];
+        float *y                = output.ptr<float>();
+        if (l + 1 < layers.size()) {
+            hidden_[l % 2].resize(size_t(n) * layer.outputs);
+            y = hidden_[l % 2].data();
+        }
+
+        for (int s = 0; s < n; ++s) {
+            const float *in = x + size_t(s) * layer.inputs;
+            float *out      = y + size_t(s) * layer.outputs;
+            std::copy(layer.bias.begin(), layer.bias.end(), out);
+            for (int i = 0; i < layer.inputs; ++i) {
+                const float v = in[i];
+                if (v == 0)
+                    continue;
+                const float *w = layer.weights.data() + size_t(i) * layer.outputs;
+                for (int o = 0; o < layer.outputs; ++o)
+                    out[o] += v * w[o];
+            }
+            if (layer.relu)
+                for (int o = 0; o < layer.outputs; ++o)
+                    out[o] = std::max(out[o], 0.0f);
+        }
+        x = y;
+    }
+
+    if (network_.softmax) {
+        for (int s = 0; s < n; ++s) {
+            float *row      = output.ptr<float>(s);
+            const float max = *std::max_element(row, row + output.cols);
+            float sum       = 0;
+            for (int o = 0; o < output.cols; ++o)
+                sum += row[o] = std::exp(row[o] - max);
+            for (int o = 0; o < output.cols; ++o)
+                row[o] /= sum;
+        }
+    }
+    return output;
+}
+
+// ========================================================
+// Factory
+// ========================================================
+
+std::unique_ptr<AutoAim::InferenceBackend>
+AutoAim::make_inference_backend(const std::string &backend, const std::string &model_path) {
+    if (backend == "opencv")
+        return std::make_unique<OpenCvDnnBackend>(model_path);
+
+    if (backend == "onnxruntime") {
+#ifdef AUTOAIM_WITH_ONNXRUNTIME
+        return make_onnxruntime_backend(model_path);
+#else
+        spdlog::warn("built without ONNX Runtime, falling back to the opencv backend");
+        return std::make_unique<OpenCvDnnBackend>(model_path);
+#endif
+    }
+
+    if (backend == "native") {
+        try {
+            return std::make_unique<MlpBackend>(model_path);
+        } catch (const std::exception &e) {
+            spdlog::warn("model is not supported by the native backend ({}), falling back to opencv", e.what());
+            return std::make_unique<OpenCvDnnBackend>(model_path);
+        }
+    }
+
+    if (backend == "int8") {
+        // 优先读取 quantize_mlp 生成的权重文件，没有的话启动时现场量化
+        try {
+            return std::make_unique<Int8MlpBackend>(Int8Mlp::load(int8_model_path(model_path)));
+        } catch (const std::exception &e) {
+            spdlog::warn("{}, quantizing {} at startup", e.what(), model_path);
+        }
+        try {
+            return std::make_unique<Int8MlpBackend>(Int8Mlp::quantize(read_dense_network(model_path)));
+        } catch (const std::exception &e) {
+            spdlog::warn("model is not supported by the int8 backend ({}), falling back to opencv", e.what());
+            return std::make_unique<OpenCvDnnBackend>(model_path);
+        }
+    }
+
+    throw std::runtime_error("unknown inference backend: " + backend);
+}
+
+std::vector<std::string> AutoAim::available_inference_backends() {
+#ifdef AUTOAIM_WITH_ONNXRUNTIME
+    return {"opencv", "onnxruntime", "native", "int8"};
+#else
+    return {"opencv", "native", "int8"};
+#endif
+}
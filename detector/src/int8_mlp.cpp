@@ -0,0 +1,408 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "int8_mlp.hpp"
+#include "config.hpp"
+#include "image_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#include <immintrin.h>
+#define INT8_MLP_X86 1
+// _mm256_dpbusd_avx_epi32（AVX-VNNI）需要 GCC 11 / Clang 12 以上
+#if (defined(__clang__) && __clang_major__ >= 12) || (!defined(__clang__) && __GNUC__ >= 11)
+#define INT8_MLP_VNNI 1
+#endif
+#endif
+
+namespace {
+
+constexpr char kMagic[4]    = {'A', 'A', 'Q', '8'};
+constexpr uint32_t kVersion = 1;
+constexpr int kAlign        = 32; // 每行权重按 32 字节补齐，一次 256 位加载
+
+int round_up(int n) { return (n + kAlign - 1) / kAlign * kAlign; }
+
+// 每个输出一行权重，acc[o] = act · weights[o]，act 与每行权重都是 stride 个元素
+void dot_rows_scalar(const uint8_t *act, const int8_t *weights, int stride, int outputs, int32_t *acc) {
+    for (int o = 0; o < outputs; ++o) {
+        const int8_t *w = weights + size_t(o) * stride;
+        int32_t sum     = 0;
+        for (int i = 0; i < stride; ++i)
+            sum += act[i] * w[i];
+        acc[o] = sum;
+    }
+}
+
+#ifdef INT8_MLP_X86
+
+__attribute__((target("avx2"))) inline int32_t hsum_epi32(__m256i v) {
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+    s         = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s         = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+}
+
+// 16 个 int8 权重扩展为 16 位后与 16 个 16 位激活做 pmaddwd
+__attribute__((target("avx2"))) inline __m256i madd_s8(__m256i act, const int8_t *w) {
+    return _mm256_madd_epi16(act, _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(w))));
+}
+
+/**
+ * @brief AVX2 实现
+ * @details pmaddubsw 的 uint8 x int8 乘积之和会饱和到 16 位（255 * 127 * 2 > 32767），
+ * 因此先把激活扩展为 16 位（act16，每层一次），再用不会饱和的 pmaddwd，每次处理四行权重
+ */
+__attribute__((target("avx2"))) void
+dot_rows_avx2(const uint8_t *act, int16_t *act16, const int8_t *weights, int stride, int outputs, int32_t *acc) {
+    for (int i = 0; i < stride; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(act + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(act16 + i), _mm256_cvtepu8_epi16(a));
+    }
+
+    int o = 0;
+    for (; o + 4 <= outputs; o += 4) {
+        const int8_t *w = weights + size_t(o) * stride;
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for (int i = 0; i < stride; i += 16) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(act16 + i));
+            s0              = _mm256_add_epi32(s0, madd_s8(a, w + i));
+            s1              = _mm256_add_epi32(s1, madd_s8(a, w + stride + i));
+            s2              = _mm256_add_epi32(s2, madd_s8(a, w + 2 * stride + i));
+            s3              = _mm256_add_epi32(s3, madd_s8(a, w + 3 * stride + i));
+        }
+        acc[o]     = hsum_epi32(s0);
+        acc[o + 1] = hsum_epi32(s1);
+        acc[o + 2] = hsum_epi32(s2);
+        acc[o + 3] = hsum_epi32(s3);
+    }
+    for (; o < outputs; ++o) {
+        const int8_t *w = weights + size_t(o) * stride;
+        __m256i s       = _mm256_setzero_si256();
+        for (int i = 0; i < stride; i += 16) {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(act16 + i));
+            s               = _mm256_add_epi32(s, madd_s8(a, w + i));
+        }
+        acc[o] = hsum_epi32(s);
+    }
+}
+
+#ifdef INT8_MLP_VNNI
+__attribute__((target("avx2"))) inline __m256i load(const void *p) {
+    return _mm256_loadu_si256(static_cast<const __m256i *>(p));
+}
+
+/**
+ * @brief AVX-VNNI 实现，vpdpbusd 一条指令完成 32 个 uint8 x int8 乘加且不饱和，每次处理四行权重
+ */
+__attribute__((target("avx2,avxvnni"))) void
+dot_rows_vnni(const uint8_t *act, const int8_t *weights, int stride, int outputs, int32_t *acc) {
+    int o = 0;
+    for (; o + 4 <= outputs; o += 4) {
+        const int8_t *w = weights + size_t(o) * stride;
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        for (int i = 0; i < stride; i += 32) {
+            const __m256i a = load(act + i);
+            s0              = _mm256_dpbusd_avx_epi32(s0, a, load(w + i));
+            s1              = _mm256_dpbusd_avx_epi32(s1, a, load(w + stride + i));
+            s2              = _mm256_dpbusd_avx_epi32(s2, a, load(w + 2 * stride + i));
+            s3              = _mm256_dpbusd_avx_epi32(s3, a, load(w + 3 * stride + i));
+        }
+        acc[o]     = hsum_epi32(s0);
+        acc[o + 1] = hsum_epi32(s1);
+        acc[o + 2] = hsum_epi32(s2);
+        acc[o + 3] = hsum_epi32(s3);
+    }
+    for (; o < outputs; ++o) {
+        const int8_t *w = weights + size_t(o) * stride;
+        __m256i s       = _mm256_setzero_si256();
+        for (int i = 0; i < stride; i += 32)
+            s = _mm256_dpbusd_avx_epi32(s, load(act + i), load(w + i));
+        acc[o] = hsum_epi32(s);
+    }
+}
+#endif // INT8_MLP_VNNI
+
+#endif // INT8_MLP_X86
+
+bool has_avx_vnni() {
+#if defined(INT8_MLP_X86) && defined(INT8_MLP_VNNI)
+    // CPUID.(EAX=7, ECX=1):EAX[4]
+    static const bool supported = [] {
+        unsigned eax, ebx, ecx, edx;
+        return AutoAim::Kernels::has_avx2() && __get_cpuid_count(7, 1, &eax, &ebx, &ecx, &edx) && (eax & (1u << 4));
+    }();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+bool isa_supported(AutoAim::Int8Mlp::Isa isa) {
+    switch (isa) {
+        case AutoAim::Int8Mlp::Isa::AvxVnni: return has_avx_vnni();
+        case AutoAim::Int8Mlp::Isa::Avx2: return AutoAim::Kernels::has_avx2();
+        default: return true;
+    }
+}
+
+const char *isa_name(AutoAim::Int8Mlp::Isa isa) {
+    switch (isa) {
+        case AutoAim::Int8Mlp::Isa::AvxVnni: return "avx-vnni";
+        case AutoAim::Int8Mlp::Isa::Avx2: return "avx2";
+        default: return "scalar";
+    }
+}
+
+template <typename T>
+void write_pod(std::ofstream &file, const T *data, size_t count = 1) {
+    file.write(reinterpret_cast<const char *>(data), sizeof(T) * count);
+}
+
+template <typename T>
+void read_pod(std::ifstream &file, T *data, size_t count = 1) {
+    if (!file.read(reinterpret_cast<char *>(data), sizeof(T) * count))
+        throw std::runtime_error("truncated int8 weight file");
+}
+
+} // namespace
+
+// ========================================================
+// Int8Mlp
+// ========================================================
+
+AutoAim::Int8Mlp AutoAim::Int8Mlp::quantize(const DenseNetwork &network) {
+    Int8Mlp mlp;
+    for (size_t l = 0; l < network.layers.size(); ++l) {
+        const DenseLayer &dense = network.layers[l];
+        if (l + 1 < network.layers.size() && !dense.relu)
+            throw std::runtime_error("hidden layer " + std::to_string(l) + " has no relu, cannot quantize to uint8");
+
+        Layer layer;
+        layer.inputs  = dense.inputs;
+        layer.outputs = dense.outputs;
+        layer.stride  = round_up(dense.inputs);
+        layer.bias    = dense.bias;
+        layer.relu    = dense.relu;
+        layer.weights.assign(size_t(layer.outputs) * layer.stride, 0);
+        layer.scales.resize(layer.outputs);
+
+        // 每个输出通道按绝对值最大的权重对称量化到 [-127, 127]
+        for (int o = 0; o < layer.outputs; ++o) {
+            float max = 0;
+            for (int i = 0; i < layer.inputs; ++i)
+                max = std::max(max, std::abs(dense.weights[size_t(i) * layer.outputs + o]));
+            const float scale = max > 0 ? max / 127 : 1;
+            layer.scales[o]   = scale;
+
+            int8_t *row = layer.weights.data() + size_t(o) * layer.stride;
+            for (int i = 0; i < layer.inputs; ++i) {
+                const long q = std::lrint(dense.weights[size_t(i) * layer.outputs + o] / scale);
+                row[i]       = int8_t(std::clamp(q, -127L, 127L));
+            }
+        }
+        mlp.layers_.push_back(std::move(layer));
+    }
+    if (mlp.layers_.empty())
+        throw std::runtime_error("empty network");
+    mlp.softmax_ = network.softmax;
+    mlp.allocate();
+    return mlp;
+}
+
+AutoAim::Int8Mlp AutoAim::Int8Mlp::load(const std::string &path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("cannot open " + path);
+
+    char magic[4];
+    uint32_t version, count, softmax;
+    read_pod(file, magic, 4);
+    read_pod(file, &version);
+    if (std::memcmp(magic, kMagic, 4) != 0 || version != kVersion)
+        throw std::runtime_error(path + " is not an int8 weight file of version " + std::to_string(kVersion));
+    read_pod(file, &count);
+    read_pod(file, &softmax);
+
+    Int8Mlp mlp;
+    for (uint32_t l = 0; l < count; ++l) {
+        int32_t shape[3]; // inputs, outputs, relu
+        read_pod(file, shape, 3);
+        if (shape[0] <= 0 || shape[1] <= 0 || (l > 0 && mlp.layers_.back().outputs != shape[0]))
+            throw std::runtime_error("invalid layer shape in " + path);
+
+        Layer layer;
+        layer.inputs  = shape[0];
+        layer.outputs = shape[1];
+        layer.stride  = round_up(layer.inputs);
+        layer.relu    = shape[2] != 0;
+        layer.scales.resize(layer.outputs);
+        layer.bias.resize(layer.outputs);
+        layer.weights.assign(size_t(layer.outputs) * layer.stride, 0);
+        read_pod(file, layer.scales.data(), layer.outputs);
+        read_pod(file, layer.bias.data(), layer.outputs);
+        for (int o = 0; o < layer.outputs; ++o)
+            read_pod(file, layer.weights.data() + size_t(o) * layer.stride, layer.inputs);
+        mlp.layers_.push_back(std::move(layer));
+    }
+    if (mlp.layers_.empty())
+        throw std::runtime_error("no layer in " + path);
+    mlp.softmax_ = softmax != 0;
+    mlp.allocate();
+    return mlp;
+}
+
+void AutoAim::Int8Mlp::save(const std::string &path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file)
+        throw std::runtime_error("cannot write " + path);
+
+    const uint32_t count = layers_.size(), softmax = softmax_;
+    write_pod(file, kMagic, 4);
+    write_pod(file, &kVersion);
+    write_pod(file, &count);
+    write_pod(file, &softmax);
+    for (const auto &layer : layers_) {
+        const int32_t shape[3] = {layer.inputs, layer.outputs, layer.relu};
+        write_pod(file, shape, 3);
+        write_pod(file, layer.scales.data(), layer.outputs);
+        write_pod(file, layer.bias.data(), layer.outputs);
+        for (int o = 0; o < layer.outputs; ++o)
+            write_pod(file, layer.weights.data() + size_t(o) * layer.stride, layer.inputs);
+    }
+    if (!file)
+        throw std::runtime_error("failed to write " + path);
+}
+
+void AutoAim::Int8Mlp::allocate() {
+    int stride = 0, width = 0;
+    for (const auto &layer : layers_) {
+        stride = std::max({stride, layer.stride, round_up(layer.outputs)});
+        width  = std::max(width, layer.outputs);
+    }
+    act_.assign(stride, 0);
+    act16_.assign(stride, 0);
+    acc_.assign(width, 0);
+    out_.assign(width, 0);
+    set_isa(Isa::AvxVnni);
+}
+
+void AutoAim::Int8Mlp::set_isa(Isa isa) {
+    while (!isa_supported(isa))
+        isa = isa == Isa::AvxVnni ? Isa::Avx2 : Isa::Scalar;
+    isa_ = isa;
+}
+
+void AutoAim::Int8Mlp::predict(const cv::Mat &patch, int &class_id, float &confidence, float *outputs) {
+    CV_Assert(patch.type() == CV_8UC1 && patch.total() == size_t(inputs()));
+    uint8_t *act = act_.data();
+    for (int r = 0; r < patch.rows; ++r)
+        std::memcpy(act + size_t(r) * patch.cols, patch.ptr<uint8_t>(r), patch.cols);
+
+    float in_scale = 1.0f / 255; // 输入层的激活就是像素
+    float *y       = out_.data();
+    for (size_t l = 0; l < layers_.size(); ++l) {
+        const Layer &layer = layers_[l];
+        const int8_t *w    = layer.weights.data();
+        switch (isa_) {
+#ifdef INT8_MLP_X86
+#ifdef INT8_MLP_VNNI
+            case Isa::AvxVnni: dot_rows_vnni(act, w, layer.stride, layer.outputs, acc_.data()); break;
+#endif
+            case Isa::Avx2: dot_rows_avx2(act, act16_.data(), w, layer.stride, layer.outputs, acc_.data()); break;
+#endif
+            default: dot_rows_scalar(act, w, layer.stride, layer.outputs, acc_.data()); break;
+        }
+
+        for (int o = 0; o < layer.outputs; ++o) {
+            y[o] = acc_[o] * (in_scale * layer.scales[o]) + layer.bias[o];
+            if (layer.relu)
+                y[o] = std::max(y[o], 0.0f);
+        }
+        if (l + 1 == layers_.size())
+            break;
+
+        // ReLU 之后非负，按本样本的最大值量化为下一层的 uint8 输入
+        const float max   = *std::max_element(y, y + layer.outputs);
+        in_scale          = max > 0 ? max / 255 : 1;
+        const float scale = 1 / in_scale;
+        for (int o = 0; o < layer.outputs; ++o)
+            act[o] = uint8_t(std::min(std::lrint(y[o] * scale), 255L));
+    }
+
+    const int n = classes();
+    if (softmax_) {
+        const float max = *std::max_element(y, y + n);
+        float sum       = 0;
+        for (int o = 0; o < n; ++o)
+            sum += y[o] = std::exp(y[o] - max);
+        for (int o = 0; o < n; ++o)
+            y[o] /= sum;
+    }
+    if (outputs)
+        std::copy(y, y + n, outputs);
+
+    // softmax 的最大值 = 1 / Σ exp(y - max)
+    class_id  = int(std::max_element(y, y + n) - y);
+    float sum = 0;
+    for (int o = 0; o < n; ++o)
+        sum += std::exp(y[o] - y[class_id]);
+    confidence = 1 / sum;
+}
+
+// ========================================================
+// Int8MlpBackend
+// ========================================================
+
+AutoAim::Int8MlpBackend::Int8MlpBackend(Int8Mlp mlp) : mlp_(std::move(mlp)) {
+    if constexpr (InitializationDebug) {
+        std::string topology = std::to_string(mlp_.inputs());
+        for (const auto &layer : mlp_.layers())
+            topology += " -> " + std::to_string(layer.outputs) + (layer.relu ? " (relu)" : "");
+        spdlog::info(
+            "int8 mlp backend: {}{}, {}", topology, mlp_.softmax() ? " -> softmax" : "", isa_name(mlp_.isa())
+        );
+    }
+}
+
+cv::Mat AutoAim::Int8MlpBackend::forward(const cv::Mat &blob) {
+    const int n = blob.size[0];
+    CV_Assert(blob.type() == CV_32F && blob.isContinuous());
+    CV_Assert(blob.total() == size_t(n) * mlp_.inputs());
+
+    cv::Mat output(n, mlp_.classes(), CV_32F);
+    for (int s = 0; s < n; ++s) {
+        // blob 是 像素 / 255，乘回 255 后舍入即还原出原来的像素
+        float *data = const_cast<float *>(blob.ptr<float>()) + size_t(s) * mlp_.inputs();
+        cv::Mat(1, mlp_.inputs(), CV_32F, data).convertTo(patch_, CV_8U, 255);
+
+        int class_id;
+        float confidence;
+        mlp_.predict(patch_, class_id, confidence, output.ptr<float>(s));
+    }
+    return output;
+}
+
+bool AutoAim::Int8MlpBackend::predict(const cv::Mat &patch, int &class_id, float &confidence) {
+    if (patch.type() != CV_8UC1 || patch.total() != size_t(mlp_.inputs()))
+        return false;
+    mlp_.predict(patch, class_id, confidence);
+    return true;
+}
+
+std::unique_ptr<AutoAim::InferenceBackend> AutoAim::Int8MlpBackend::clone() const {
+    auto copy    = std::make_unique<Int8MlpBackend>(*this); // Int8Mlp 的权重与缓冲区都是深拷贝
+    copy->patch_ = cv::Mat();                               // cv::Mat 的拷贝共享内存，不能沿用
+    return copy;
+}
+
+std::string AutoAim::int8_model_path(const std::string &model_path) {
+    return std::filesystem::path(model_path).replace_extension(".int8").string();
+}
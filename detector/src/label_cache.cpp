@@ -0,0 +1,152 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "label_cache.hpp"
+#include "config.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <opencv2/imgproc.hpp>
+#include <spdlog/spdlog.h>
+#include <tuple>
+
+AutoAim::LabelCache::LabelCache(const LabelCacheConfig &config) : config_(config) {}
+
+double AutoAim::LabelCache::iou(const std::vector<cv::Point2f> &a, const std::vector<cv::Point2f> &b) {
+    if (a.size() < 3 || b.size() < 3 || (cv::boundingRect(a) & cv::boundingRect(b)).empty())
+        return 0;
+
+    std::vector<cv::Point2f> intersection;
+    const double overlap = cv::intersectConvexConvex(a, b, intersection, true);
+    if (overlap <= 0)
+        return 0;
+    const double union_area = std::abs(cv::contourArea(a)) + std::abs(cv::contourArea(b)) - overlap;
+    return union_area > 0 ? overlap / union_area : 0;
+}
+
+const std::vector<size_t> &AutoAim::LabelCache::lookup(const std::vector<Armor> &armors) {
+    matches_.assign(armors.size(), -1);
+    pending_.clear();
+    stats_.lookups += armors.size();
+
+    if (!config_.enable) {
+        pending_.resize(armors.size());
+        std::iota(pending_.begin(), pending_.end(), 0);
+        return pending_;
+    }
+
+    // 候选关联按 IoU 从大到小贪心一对一匹配
+    std::vector<std::tuple<double, size_t, size_t>> candidates;
+    for (size_t i = 0; i < armors.size(); ++i)
+        for (size_t j = 0; j < tracks_.size(); ++j)
+            if (const double overlap = iou(armors[i].vertices, tracks_[j].vertices); overlap >= config_.min_iou)
+                candidates.emplace_back(overlap, i, j);
+    std::sort(candidates.begin(), candidates.end(), std::greater<>());
+
+    std::vector<bool> taken(tracks_.size(), false);
+    for (const auto &[overlap, i, j] : candidates) {
+        if (matches_[i] >= 0 || taken[j])
+            continue;
+        matches_[i] = static_cast<int>(j);
+        taken[j]    = true;
+    }
+
+    for (size_t i = 0; i < armors.size(); ++i) {
+        if (matches_[i] < 0) {
+            ++stats_.new_tracks;
+            pending_.push_back(i);
+            continue;
+        }
+
+        const Track &track = tracks_[matches_[i]];
+        if (!confirmed(track)) {
+            ++stats_.unconfirmed;
+            pending_.push_back(i);
+        } else if (track.since_verify + 1 >= config_.reverify_interval
+                   || track.confidence * config_.confidence_decay < config_.confirm_confidence) {
+            ++stats_.reverifications;
+            pending_.push_back(i);
+        } else
+            ++stats_.hits;
+    }
+
+    if constexpr (ClassifierDebug)
+        spdlog::info(
+            "LabelCache::{} armors, {} tracks, {} to classify", armors.size(), tracks_.size(), pending_.size()
+        );
+    return pending_;
+}
+
+std::vector<AutoAim::ClassifyResult>
+AutoAim::LabelCache::update(const std::vector<Armor> &armors, const std::vector<ClassifyResult> &classified) {
+    CV_Assert(armors.size() == matches_.size() && classified.size() == pending_.size());
+    if (!config_.enable)
+        return classified;
+
+    std::vector<ClassifyResult> results(armors.size());
+    std::vector<bool> seen(tracks_.size(), false);
+    size_t next = 0; // classified 中下一个结果的下标
+    for (size_t i = 0; i < armors.size(); ++i) {
+        if (matches_[i] < 0) {
+            matches_[i] = static_cast<int>(tracks_.size());
+            tracks_.emplace_back();
+            seen.push_back(false);
+        }
+
+        Track &track      = tracks_[matches_[i]];
+        seen[matches_[i]] = true;
+        track.vertices    = armors[i].vertices;
+        track.missed      = 0;
+
+        if (next < pending_.size() && pending_[next] == i)
+            vote(track, classified[next++]);
+        else {
+            track.confidence *= config_.confidence_decay;
+            ++track.since_verify;
+        }
+        results[i] = {track.label, track.confidence};
+    }
+
+    for (size_t j = 0; j < seen.size(); ++j)
+        tracks_[j].missed += !seen[j];
+    std::erase_if(tracks_, [&](const Track &track) { return track.missed > config_.max_missed; });
+
+    return results;
+}
+
+void AutoAim::LabelCache::clear() {
+    tracks_.clear();
+    matches_.clear();
+    pending_.clear();
+}
+
+bool AutoAim::LabelCache::confirmed(const Track &track) const {
+    return track.label != Labels::None && track.streak >= config_.confirm_frames
+        && track.confidence >= config_.confirm_confidence;
+}
+
+void AutoAim::LabelCache::vote(Track &track, const ClassifyResult &result) {
+    const bool voted = std::any_of(track.votes.begin(), track.votes.end(), [](double v) { return v > 0; });
+    for (double &v : track.votes)
+        v *= config_.vote_decay;
+    track.votes[static_cast<size_t>(result.label)] += result.confidence;
+
+    const auto best    = std::max_element(track.votes.begin(), track.votes.end());
+    const Labels label = static_cast<Labels>(best - track.votes.begin());
+    if (voted && label != track.label)
+        ++stats_.label_changes;
+
+    if (result.label == label) {
+        // 与投票结果一致：累计连续次数，置信度取本次推理的结果
+        track.streak     = label == track.label ? track.streak + 1 : 1;
+        track.confidence = result.confidence;
+    } else {
+        // 单次结果被投票否决：重新确认，置信度取投票结果所占的比例
+        const double total = std::accumulate(track.votes.begin(), track.votes.end(), 0.0);
+        track.streak       = 0;
+        track.confidence   = total > 0 ? *best / total : 0;
+    }
+    track.label        = label;
+    track.since_verify = 0;
+}
@@ -0,0 +1,86 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "config.hpp"
+#include "inference_backend.hpp"
+
+#include <onnxruntime_cxx_api.h>
+#include <spdlog/spdlog.h>
+
+namespace AutoAim {
+
+/**
+ * @brief ONNX Runtime CPU 后端，只在启用 meson 选项 onnxruntime 时编译
+ * @details 单线程执行（intra_op_num_threads = 1），并行交给上层的线程池。
+ * Ort::Session::Run 可以被多个线程同时调用，clone() 得到的实例共享同一个 session。
+ * 模型输入的 batch 维度固定为 1 时逐个推理
+ */
+class OnnxRuntimeBackend : public InferenceBackend {
+  public:
+    explicit OnnxRuntimeBackend(const std::string &model_path);
+
+    const char *name() const override { return "onnxruntime"; }
+    cv::Mat forward(const cv::Mat &blob) override;
+    std::unique_ptr<InferenceBackend> clone() const override;
+
+  protected:
+    OnnxRuntimeBackend(const OnnxRuntimeBackend &) = default;
+
+    std::shared_ptr<Ort::Env> env_;
+    std::shared_ptr<Ort::Session> session_;
+    std::shared_ptr<Ort::MemoryInfo> memory_info_;
+    std::string input_name_, output_name_;
+    bool batch_supported_{true};
+};
+
+std::unique_ptr<InferenceBackend> make_onnxruntime_backend(const std::string &model_path) {
+    return std::make_unique<OnnxRuntimeBackend>(model_path);
+}
+
+} // namespace AutoAim
+
+AutoAim::OnnxRuntimeBackend::OnnxRuntimeBackend(const std::string &model_path)
+    : env_(std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "classifier")) {
+    Ort::SessionOptions options;
+    options.SetIntraOpNumThreads(1);
+    options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+    session_     = std::make_shared<Ort::Session>(*env_, model_path.c_str(), options);
+    memory_info_ = std::make_shared<Ort::MemoryInfo>(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault));
+
+    Ort::AllocatorWithDefaultOptions allocator;
+    input_name_  = session_->GetInputNameAllocated(0, allocator).get();
+    output_name_ = session_->GetOutputNameAllocated(0, allocator).get();
+
+    // batch 维度为固定值（而不是 -1 这样的动态维度）时只能逐个推理
+    const auto shape = session_->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+    batch_supported_ = !shape.empty() && shape[0] <= 0;
+
+    if constexpr (InitializationDebug)
+        spdlog::info(
+            "onnxruntime backend: input \"{}\", output \"{}\", batch {}",
+            input_name_,
+            output_name_,
+            batch_supported_ ? "dynamic" : "fixed"
+        );
+}
+
+cv::Mat AutoAim::OnnxRuntimeBackend::forward(const cv::Mat &blob) {
+    CV_Assert(blob.type() == CV_32F && blob.isContinuous());
+    const int n = blob.size[0];
+    if (!batch_supported_ && n > 1)
+        return forward_each(blob);
+
+    const std::vector<int64_t> shape(blob.size.p, blob.size.p + blob.dims);
+    Ort::Value input = Ort::Value::CreateTensor<float>(
+        *memory_info_, const_cast<float *>(blob.ptr<float>()), blob.total(), shape.data(), shape.size()
+    );
+    const char *input_name = input_name_.c_str(), *output_name = output_name_.c_str();
+    auto outputs           = session_->Run(Ort::RunOptions{nullptr}, &input_name, &input, 1, &output_name, 1);
+
+    const size_t count = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+    const cv::Mat logits(n, static_cast<int>(count / n), CV_32F, outputs[0].GetTensorMutableData<float>());
+    return logits.clone();
+}
+
+std::unique_ptr<AutoAim::InferenceBackend> AutoAim::OnnxRuntimeBackend::clone() const {
+    return std::unique_ptr<OnnxRuntimeBackend>(new OnnxRuntimeBackend(*this));
+}
@@ -9,17 +9,23 @@
 AutoAim::Publisher::Publisher(const std::string &config_path) {
     if constexpr (PublisherDebug)
         spdlog::info("Publisher::initializing with config path: {}", config_path);
-    detector_   = std::make_shared<Detector>(config_path);
-    classifier_ = std::make_shared<Classifier>(config_path);
+    detector_    = std::make_shared<Detector>(config_path);
+    classifiers_ = std::make_shared<ClassifierPool>(config_path);
+    label_cache_ = std::make_shared<LabelCache>(LabelCacheConfig(config_path));
 }
 
-std::vector<AnnotatedArmorInfo> AutoAim::Publisher::annotate_image(const RawFrameInfo &raw, const IMUInfo &imu) {
+std::vector<AnnotatedArmorInfo>
+AutoAim::Publisher::annotate_image(const RawFrameInfo &raw, const IMUInfo &imu, const std::vector<cv::Rect> &rois) {
     if constexpr (PublisherDebug)
         spdlog::info("Publisher::annotating image");
 
-    auto armors = detector_->detect(raw.frame);
+    auto armors = detector_->detect(raw.frame, rois);
     if constexpr (PublisherDebug)
-        spdlog::info("Publisher::number of armors detected: {}", armors.size());
+        spdlog::info(
+            "Publisher::number of armors detected: {} ({})",
+            armors.size(),
+            detector_->stats().last_frame_roi ? "roi" : "full frame"
+        );
 
     if constexpr (PublisherDiaplayImageDebug) {
         cv::Mat frame = raw.frame;
@@ -28,14 +34,34 @@ std::vector<AnnotatedArmorInfo> AutoAim::Publisher::annotate_image(const RawFram
 
     std::vector<AnnotatedArmorInfo> annotated;
 
-    for (auto &armor : armors) {
-        auto roi   = classifier_->extract_region_of_interest(raw.frame, armor);
-        auto label = classifier_->classify(roi);
+    // 命中分类缓存的装甲板跳过数字区域提取与推理
+    const auto &pending = label_cache_->lookup(armors);
+
+    // 数字区域直接采样为灰度图，缓冲区在帧间复用
+    rois_.resize(pending.size());
+    auto extract = [&](size_t k) {
+        classifiers_->extract_gray_region_of_interest(raw.frame, armors[pending[k]], rois_[k]);
+    };
+    if (pool_)
+        pool_->parallel_for(0, pending.size(), extract);
+    else
+        for (size_t k = 0; k < pending.size(); ++k)
+            extract(k);
+
+    // 需要推理的数字区域分给各分类器实例 batch 推理，再按轨迹投票
+    auto results = label_cache_->update(armors, classifiers_->classify_batch(rois_));
+    for (size_t i = 0; i < armors.size(); ++i) {
         if constexpr (PublisherDebug)
-            spdlog::info("Publisher::label: {}", (int)label);
+            spdlog::info("Publisher::label: {} ({:.3f})", (int)results[i].label, results[i].confidence);
 
-        annotated.emplace_back(armor, label, imu, raw.timestamp);
+        annotated.emplace_back(armors[i], results[i].label, imu, raw.timestamp);
     }
 
     return annotated;
+}
+
+void AutoAim::Publisher::set_thread_pool(std::shared_ptr<ThreadPool<>> pool) {
+    detector_->set_thread_pool(pool);
+    classifiers_->set_thread_pool(pool);
+    pool_ = std::move(pool);
 }
\ No newline at end of file
@@ -13,7 +13,7 @@ FireController::FireController() {
     SPDLOG_LOGGER_INFO(this->log_, "FireController initialized");
 }
 
-void FireController::set_port(std::shared_ptr<SerialPort> port) { this->port_ = port; }
+void FireController::set_sender(std::shared_ptr<CommandSender> sender) { this->sender_ = sender; }
 
 void FireController::set_allow(const AutoAim::Labels &label) { this->allowed_label_ = label; }
 
@@ -96,5 +96,5 @@ bool FireController::_check_done_fitting(const PredictedPosition &pred, const st
 
 void FireController::try_fire(const PredictedPosition &pred, const std::vector<Armor3d> &context) {
     auto pack = this->_pack(pred, context);
-    this->port_->send_data(pack);
+    this->sender_->submit(pack); // 只覆盖待发送的指令，由发送线程按固定频率发出
 }
\ No newline at end of file
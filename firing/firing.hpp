@@ -1,7 +1,7 @@
 #ifndef __FIRING_HPP__
 #define __FIRING_HPP__
 
-#include "serial_port.hpp"
+#include "command_sender.hpp"
 #include "structs.hpp"
 
 #include <atomic>
@@ -17,7 +17,7 @@ class FireController {
   protected:
     volatile std::atomic<AutoAim::Labels> allowed_label_; // can be changed by other threads
     uint8_t updated{0};
-    std::shared_ptr<SerialPort> port_;
+    std::shared_ptr<CommandSender> sender_;
     std::shared_ptr<spdlog::logger> log_;
 
   private:
@@ -31,7 +31,7 @@ class FireController {
 
   public:
     FireController();
-    void set_port(std::shared_ptr<SerialPort> port);
+    void set_sender(std::shared_ptr<CommandSender> sender);
     void set_allow(const AutoAim::Labels &label);
     void try_fire(const PredictedPosition &pred, const std::vector<Armor3d> &context);
 };
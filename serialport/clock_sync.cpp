@@ -0,0 +1,91 @@
+#include "clock_sync.hpp"
+
+using namespace std::chrono;
+
+ClockSync::ClockSync(milliseconds window, nanoseconds tx_time)
+    : window_us_(duration_cast<microseconds>(window).count()),
+      tx_us_(static_cast<uint32_t>(duration_cast<microseconds>(tx_time).count())) {}
+
+uint32_t ClockSync::to_us32(time_point t) {
+    return static_cast<uint32_t>(duration_cast<microseconds>(t.time_since_epoch()).count());
+}
+
+SendTimestamps ClockSync::stamp_now() {
+    const uint32_t now = to_us32(clock::now());
+    return {now ? now : 1};
+}
+
+bool ClockSync::add(const RecvTimestamps &stamps, time_point arrival) {
+    if (stamps.host_echo == 0)
+        return false; // 下位机还没有收到过指令
+
+    //* 同一时钟内的两个时间戳相减，按有符号数解释回绕后的差值
+    const int64_t t4_us   = duration_cast<microseconds>(arrival.time_since_epoch()).count();
+    const uint32_t t1     = stamps.host_echo + this->tx_us_; // 发送帧全部发出的时间
+    const uint32_t t4     = static_cast<uint32_t>(t4_us);
+    const int64_t elapsed = static_cast<int32_t>(t4 - t1);                           // 主机：发出指令 -> 收到回显
+    const int64_t hold    = static_cast<int32_t>(stamps.mcu_send - stamps.mcu_recv); // 下位机：收到指令 -> 发出回显
+    const int64_t rtt     = elapsed - hold;
+    if (elapsed < 0 || hold < 0 || rtt < 0 || rtt > kMaxRttUs)
+        return false;
+
+    // t2 - t1 = offset + 上行延迟，上下行对称时上行延迟为 rtt / 2
+    const uint32_t offset = stamps.mcu_recv - t1 - static_cast<uint32_t>(rtt / 2);
+
+    //* 窗口内 rtt 的最小值：新样本之前 rtt 不比它小的样本不会再成为最小值
+    while (!this->min_queue_.empty() && this->min_queue_.back().rtt_us >= rtt)
+        this->min_queue_.pop_back();
+    this->min_queue_.push_back({t4_us, rtt, offset});
+    while (this->min_queue_.front().arrival_us < t4_us - this->window_us_)
+        this->min_queue_.pop_front();
+    const Sample &best = this->min_queue_.front();
+
+    //* 按估计的 offset 把 rtt 分为上行、下行两段
+    const int64_t uplink   = static_cast<int32_t>(stamps.mcu_recv - stamps.host_echo - best.offset_us);
+    const int64_t downlink = static_cast<int32_t>(t4 - stamps.mcu_send + best.offset_us);
+
+    std::lock_guard lock(this->mutex_);
+    if (this->estimate_.samples == 0) {
+        this->srtt_us8_      = rtt * 8;
+        this->suplink_us8_   = uplink * 8;
+        this->sdownlink_us8_ = downlink * 8;
+    } else {
+        this->srtt_us8_ += rtt - this->srtt_us8_ / 8;
+        this->suplink_us8_ += uplink - this->suplink_us8_ / 8;
+        this->sdownlink_us8_ += downlink - this->sdownlink_us8_ / 8;
+    }
+    this->estimate_.rtt      = microseconds(this->srtt_us8_ / 8);
+    this->estimate_.min_rtt  = microseconds(best.rtt_us);
+    this->estimate_.uplink   = microseconds(this->suplink_us8_ / 8);
+    this->estimate_.downlink = microseconds(this->sdownlink_us8_ / 8);
+    this->estimate_.offset   = microseconds(static_cast<int32_t>(best.offset_us));
+    ++this->estimate_.samples;
+    return true;
+}
+
+void ClockSync::reset() {
+    this->min_queue_.clear();
+
+    std::lock_guard lock(this->mutex_);
+    this->estimate_ = Estimate{};
+}
+
+ClockSync::Estimate ClockSync::estimate() const {
+    std::lock_guard lock(this->mutex_);
+    return this->estimate_;
+}
+
+std::optional<ClockSync::time_point> ClockSync::to_host(uint32_t mcu_time, time_point near) const {
+    uint32_t offset;
+    {
+        std::lock_guard lock(this->mutex_);
+        if (!this->estimate_.valid())
+            return std::nullopt;
+        offset = static_cast<uint32_t>(this->estimate_.offset.count());
+    }
+
+    //* 在 near 附近展开回绕
+    const auto near_us = duration_cast<microseconds>(near.time_since_epoch());
+    const int32_t diff = static_cast<int32_t>(mcu_time - offset - static_cast<uint32_t>(near_us.count()));
+    return time_point(duration_cast<clock::duration>(near_us + microseconds(diff)));
+}
@@ -0,0 +1,110 @@
+#ifndef __CLOCK_SYNC_HPP__
+#define __CLOCK_SYNC_HPP__
+
+#include "structs.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+
+/**
+ * @brief 由协议 v3 的时间戳测量串口往返时间，并估计主机与下位机的时钟偏差（NTP 的最小延迟滤波）
+ * @details 每个带回显的接收帧给出 NTP 的四个时间戳：
+ * - t1：主机写入指令帧的时间（主机时钟）；
+ * - t2：下位机收完该指令帧的时间（下位机时钟）；
+ * - t3：下位机开始发送本帧的时间（下位机时钟）；
+ * - t4：本帧帧头到达主机的时间（主机时钟，由 RecvFrameParser 估计）。
+ *
+ * 往返时间 rtt = (t4 - t1) - (t3 - t2)，扣除了下位机持有回显的时间；时钟偏差 offset = ((t2 - t1) + (t3 - t4)) / 2。
+ * 上下行延迟不对称时，单个样本的 offset 误差不超过 rtt / 2。排队、USB 轮询只会使延迟变大，
+ * 因此取窗口内 rtt 最小的样本的 offset 作为估计；窗口内的最小值用单调队列维护，每个样本均摊 O(1)。
+ *
+ * t1 是写入时刻，而 t2 是下位机收完整帧的时刻，计算前给 t1 加上发送帧的传输时间 tx_time，上下行都按帧头计时。
+ *
+ * 有了 offset，每个样本可以分别算出上行（主机 -> 下位机）与下行的单程延迟，平滑后供跟踪器补偿指令的传输延迟。
+ * 时间戳都是按 2^32 回绕的 us，只要求同一个样本的时间戳相差不超过约 35 min。
+ *
+ * @remark add()、reset() 只能由一个线程调用（串口 I/O 线程）；estimate()、to_host() 可在任意线程调用
+ */
+class ClockSync {
+  public:
+    using clock      = std::chrono::system_clock;
+    using time_point = clock::time_point;
+
+    static constexpr int64_t kMaxRttUs = 1'000'000; // 往返时间超过 1 s 的样本认为回显错误，丢弃
+
+    struct Estimate {
+        std::chrono::microseconds rtt{};      // 平滑后的往返时间
+        std::chrono::microseconds min_rtt{};  // 窗口内最小的往返时间
+        std::chrono::microseconds uplink{};   // 平滑后的上行延迟：主机写入 -> 下位机收完指令，含发送帧的传输时间
+        std::chrono::microseconds downlink{}; // 平滑后的下行延迟：下位机开始发送 -> 帧头到达主机
+        std::chrono::microseconds offset{};   // 下位机时钟 - 主机时钟，按 2^32 us 回绕后的有符号值
+        uint64_t samples{0};                  // 自上次 reset() 以来的有效样本数
+
+        bool valid() const { return samples > 0; }
+    };
+
+    /**
+     * @param window 时钟偏差取这么久内往返时间最小的样本。越长越不受排队延迟影响，越短越能跟上时钟漂移
+     * @param tx_time 发送帧的传输时间，帧长 × 单字节传输时间
+     */
+    explicit ClockSync(
+        std::chrono::milliseconds window = std::chrono::milliseconds(2000), std::chrono::nanoseconds tx_time = {}
+    );
+
+    ClockSync(const ClockSync &)            = delete;
+    ClockSync &operator=(const ClockSync &) = delete;
+
+    /**
+     * @brief 加入一个样本
+     * @param arrival 帧头的到达时间 t4
+     * @return 有回显且往返时间合理时为 true
+     */
+    bool add(const RecvTimestamps &stamps, time_point arrival);
+
+    /**
+     * @brief 丢弃所有样本，例如串口重连之后（下位机可能已经重启）
+     */
+    void reset();
+
+    Estimate estimate() const;
+
+    /**
+     * @brief 把下位机时间换算为主机时间
+     * @param near 与结果相差不超过约 35 min 的主机时间，用于展开回绕，例如帧的到达时间
+     * @return 还没有有效样本时为 std::nullopt
+     */
+    std::optional<time_point> to_host(uint32_t mcu_time, time_point near) const;
+
+    /**
+     * @brief 当前时间，作为发送帧的 host_send。0 表示没有回显，因此不会返回 0
+     */
+    static SendTimestamps stamp_now();
+
+    /**
+     * @brief 主机时间按 2^32 回绕的 us
+     */
+    static uint32_t to_us32(time_point t);
+
+  private:
+    struct Sample {
+        int64_t arrival_us; // t4，用于滑出窗口
+        int64_t rtt_us;
+        uint32_t offset_us;
+    };
+
+    const int64_t window_us_;
+    const uint32_t tx_us_;
+
+    std::deque<Sample> min_queue_; // rtt 单调递增，队首为窗口内 rtt 最小的样本。只在写线程中访问
+
+    // 平滑值 × 8，与 TCP 的 SRTT 一样取 1/8 的增益。只在写线程中访问
+    int64_t srtt_us8_{0}, suplink_us8_{0}, sdownlink_us8_{0};
+
+    mutable std::mutex mutex_;
+    Estimate estimate_; // 由 mutex_ 保护
+};
+
+#endif // __CLOCK_SYNC_HPP__
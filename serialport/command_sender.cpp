@@ -0,0 +1,135 @@
+#define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
+
+#include "command_sender.hpp"
+
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+CommandSender::CommandSender(std::shared_ptr<SerialPort> port)
+    : CommandSender(
+          port,
+          std::chrono::milliseconds(port->config().send_interval),
+          std::chrono::milliseconds(port->config().command_timeout)
+      ) {}
+
+CommandSender::CommandSender(
+    std::shared_ptr<SerialPort> port, std::chrono::milliseconds send_interval, std::chrono::milliseconds timeout
+)
+    : port_(std::move(port)),
+      interval_(send_interval),
+      timeout_(timeout) {
+    this->log_ = spdlog::get("command_sender");
+    if (!this->log_) {
+        this->log_ = spdlog::stdout_color_mt("command_sender");
+        this->log_->set_level(spdlog::level::trace);
+        this->log_->set_pattern("[%H:%M:%S, +%4oms] [%15s:%3# in %!] [%^%l%$] %v");
+    }
+
+    // 两次发送之间的空闲远长于发送本身，直接挂起
+    this->mailbox_.set_parking_policy(ParkingPolicy{0, 0});
+}
+
+CommandSender::~CommandSender() { this->stop(); }
+
+void CommandSender::start() {
+    if (this->running_.exchange(true))
+        return;
+
+    this->thread_ = std::thread([this] { this->__run(); });
+    SPDLOG_LOGGER_INFO(
+        this->log_,
+        "command sender started, interval = {} ms, timeout = {} ms",
+        this->interval_.count(),
+        this->timeout_.count()
+    );
+}
+
+void CommandSender::stop() {
+    // send_interval = 0 时发送线程最多在 command_timeout 后醒来并退出
+    if (!this->running_.exchange(false))
+        return;
+    if (this->thread_.joinable())
+        this->thread_.join();
+    SPDLOG_LOGGER_INFO(this->log_, "command sender stopped");
+}
+
+void CommandSender::submit(const VisionPLCSendMsg &msg, time_point produced) {
+    this->mailbox_.write(PendingCommand{msg, produced});
+}
+
+std::optional<CommandSender::SentCommand> CommandSender::last_sent() const {
+    std::lock_guard<std::mutex> lock(this->last_mutex_);
+    return this->last_;
+}
+
+std::chrono::nanoseconds CommandSender::mean_latency() const {
+    const uint64_t n = this->updates_.load(std::memory_order_relaxed);
+    return std::chrono::nanoseconds(n ? this->total_latency_ns_.load(std::memory_order_relaxed) / int64_t(n) : 0);
+}
+
+void CommandSender::__run() {
+    using steady = std::chrono::steady_clock;
+
+    std::optional<PendingCommand> last; // 最近一条新指令
+    auto last_update = steady::now();   // 取到最近一条新指令的时间
+    auto next        = steady::now();   // 下一次发送的时间
+    bool was_stale   = false;
+
+    while (this->running_.load(std::memory_order_acquire)) {
+        std::optional<PendingCommand> fresh;
+        if (this->interval_.count() > 0) {
+            // 落后超过一个周期时不补发，从现在重新计时
+            next = std::max(next + this->interval_, steady::now());
+            std::this_thread::sleep_until(next);
+            fresh = this->mailbox_.take();
+        } else {
+            fresh = this->mailbox_.take_wait_for(this->timeout_);
+        }
+
+        const auto now = steady::now();
+        if (fresh) {
+            last        = fresh;
+            last_update = now;
+        }
+        if (!last)
+            continue;
+
+        const bool stale = !fresh && now - last_update >= this->timeout_;
+        if (this->interval_.count() == 0 && !fresh && !stale)
+            continue; // 立即发送模式下，只在过期时重发
+
+        if (stale != was_stale) {
+            if (stale)
+                SPDLOG_LOGGER_WARN(
+                    this->log_, "no new command for {} ms, resending the last one as stale", this->timeout_.count()
+                );
+            else
+                SPDLOG_LOGGER_INFO(this->log_, "commands resumed");
+            was_stale = stale;
+        }
+
+        SentCommand cmd{last->msg, last->produced, clock::now(), fresh.has_value(), stale};
+        if (stale)
+            cmd.msg.flag_fire = 0; // 过期的瞄准结果不能用于开火
+        this->__send(cmd);
+    }
+}
+
+void CommandSender::__send(const SentCommand &cmd) {
+    this->port_->send_data(cmd.msg, cmd.updated);
+
+    this->sent_.fetch_add(1, std::memory_order_relaxed);
+    if (cmd.stale)
+        this->stale_.fetch_add(1, std::memory_order_relaxed);
+    if (cmd.updated) {
+        const int64_t latency = std::chrono::duration_cast<std::chrono::nanoseconds>(cmd.sent - cmd.produced).count();
+        this->total_latency_ns_.fetch_add(latency, std::memory_order_relaxed);
+        int64_t max = this->max_latency_ns_.load(std::memory_order_relaxed);
+        while (latency > max && !this->max_latency_ns_.compare_exchange_weak(max, latency, std::memory_order_relaxed))
+            ;
+        this->updates_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::lock_guard<std::mutex> lock(this->last_mutex_);
+    this->last_ = cmd;
+}
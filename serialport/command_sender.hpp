@@ -0,0 +1,108 @@
+#ifndef __COMMAND_SENDER_HPP__
+#define __COMMAND_SENDER_HPP__
+
+#include "mailbox.hpp"
+#include "serial_port.hpp"
+#include "structs.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <spdlog/logger.h>
+#include <thread>
+
+/**
+ * @brief 只保留最新指令的串口发送线程
+ * @details 开火控制每处理完一帧就 submit() 一次，提交只是写入 Mailbox，新指令覆盖还没发出的旧指令。
+ * 发送线程按 comm.toml 中的 send_interval 定时发送：
+ * - 有新指令时发送最新的一条，翻转 flag_have_updated；
+ * - 没有新指令时重发上一条，不翻转 flag_have_updated，下位机据此知道视觉没有更新；
+ * - 距离上一条新指令超过 command_timeout 时认为指令已过期（看门狗），重发时清除 flag_fire。
+ *
+ * send_interval = 0 时收到新指令立即发送，没有新指令时每隔 command_timeout 发送一次过期指令作为心跳。
+ * 这样流水线追赶时不会突发地连续发送，流水线卡顿时下位机也能持续收到数据。
+ *
+ * @remark submit() 只能由一个线程调用（Mailbox 单写单读）
+ */
+class CommandSender {
+  public:
+    using clock      = std::chrono::system_clock;
+    using time_point = clock::time_point;
+
+    /**
+     * @brief 一次发送的记录，用于统计延迟
+     */
+    struct SentCommand {
+        VisionPLCSendMsg msg;
+        time_point produced; // 指令的生成时间，由 submit() 传入
+        time_point sent;     // 交给串口的时间
+        bool updated{false}; // 是否为新指令
+        bool stale{false};   // 是否已过期
+    };
+
+    /**
+     * @param port 串口，发送周期与过期时间读取自 port->config()
+     */
+    explicit CommandSender(std::shared_ptr<SerialPort> port);
+    CommandSender(
+        std::shared_ptr<SerialPort> port, std::chrono::milliseconds send_interval, std::chrono::milliseconds timeout
+    );
+    ~CommandSender();
+
+    CommandSender(const CommandSender &)            = delete;
+    CommandSender &operator=(const CommandSender &) = delete;
+
+    void start();
+    void stop();
+
+    /**
+     * @brief 提交新指令，不阻塞
+     * @param produced 指令的生成时间，例如对应图像的时间戳
+     */
+    void submit(const VisionPLCSendMsg &msg, time_point produced = clock::now());
+
+    /**
+     * @brief 最近一次发送的记录
+     */
+    std::optional<SentCommand> last_sent() const;
+
+    uint64_t sent() const { return sent_.load(std::memory_order_relaxed); }            // 发送的总数
+    uint64_t updates_sent() const { return updates_.load(std::memory_order_relaxed); } // 其中新指令的数量
+    uint64_t stale_sent() const { return stale_.load(std::memory_order_relaxed); }     // 其中过期指令的数量
+    uint64_t coalesced() const { return mailbox_.dropped(); }                          // 被覆盖、没有发出的指令数
+
+    /**
+     * @brief 新指令从生成到发送的平均与最大延迟
+     */
+    std::chrono::nanoseconds mean_latency() const;
+    std::chrono::nanoseconds max_latency() const { return std::chrono::nanoseconds(max_latency_ns_.load()); }
+
+  private:
+    void __run();
+    void __send(const SentCommand &cmd);
+
+    struct PendingCommand {
+        VisionPLCSendMsg msg;
+        time_point produced;
+    };
+
+    std::shared_ptr<SerialPort> port_;
+    std::chrono::milliseconds interval_;
+    std::chrono::milliseconds timeout_;
+
+    Mailbox<PendingCommand> mailbox_;
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex last_mutex_;
+    std::optional<SentCommand> last_; // 由发送线程写入
+
+    std::atomic<uint64_t> sent_{0}, updates_{0}, stale_{0};
+    std::atomic<int64_t> total_latency_ns_{0}, max_latency_ns_{0};
+
+    std::shared_ptr<spdlog::logger> log_;
+};
+
+#endif // __COMMAND_SENDER_HPP__
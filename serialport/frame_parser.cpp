@@ -0,0 +1,104 @@
+#include "frame_parser.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+RecvFrameParser::RecvFrameParser(std::chrono::nanoseconds byte_time, ProtocolVersion version)
+    : byte_time_(byte_time),
+      version_(version),
+      frame_size_(frame_size_of<VisionPLCRecvMsg>(version)) {}
+
+std::chrono::nanoseconds RecvFrameParser::byte_time_of(int baud_rate, int data_bits, int stop_bits, int parity) {
+    const int bits = 1 + data_bits + stop_bits + (parity != 0); // 起始位 + 数据位 + 停止位 + 校验位
+    return std::chrono::nanoseconds(int64_t(bits) * 1'000'000'000 / std::max(baud_rate, 1));
+}
+
+void RecvFrameParser::push(const uint8_t *data, size_t size, time_point arrival) {
+    //* 一次读到的字节比缓冲区还多时，只保留最后 kCapacity 个
+    if (size > kCapacity) {
+        dropped_bytes_ += size - kCapacity;
+        data += size - kCapacity;
+        size = kCapacity;
+    }
+    this->compact(size);
+
+    //* 倒推每个字节的到达时间
+    const int64_t last = std::chrono::duration_cast<clock::duration>(arrival.time_since_epoch()).count();
+    const int64_t step = std::chrono::duration_cast<clock::duration>(byte_time_).count();
+    std::memcpy(bytes_.data() + end_, data, size);
+    for (size_t i = 0; i < size; ++i) {
+        last_stamp_       = std::max(last - int64_t(size - 1 - i) * step, last_stamp_ + 1);
+        stamps_[end_ + i] = last_stamp_;
+    }
+    end_ += size;
+}
+
+bool RecvFrameParser::pop(StampedRecvMsg &msg) {
+    while (end_ - begin_ >= frame_size_) {
+        //* 查找帧头
+        const auto *head = static_cast<const uint8_t *>(
+            std::memchr(bytes_.data() + begin_, kProtocolRecvHead, end_ - begin_ - frame_size_ + 1)
+        );
+        if (!head) {
+            // 剩下的字节中不可能有完整的帧，只保留可能是下一帧开头的部分
+            skipped_bytes_ += end_ - begin_ - frame_size_ + 1;
+            begin_ = end_ - frame_size_ + 1;
+            return false;
+        }
+        const size_t offset = head - bytes_.data();
+        skipped_bytes_ += offset - begin_;
+        begin_ = offset;
+
+        //* 帧尾不对说明帧头是数据中的 0x3A，跳过它继续查找
+        if (bytes_[begin_ + frame_size_ - 1] != kProtocolTail) {
+            ++skipped_bytes_;
+            ++begin_;
+            continue;
+        }
+
+        //* 帧头帧尾碰巧对上，或传输中有字节出错
+        uint16_t seq;
+        if (!decode_frame(bytes_.data() + begin_, version_, msg.msg, seq, msg.stamps)) {
+            ++crc_errors_;
+            ++skipped_bytes_;
+            ++begin_;
+            continue;
+        }
+
+        if (version_ != ProtocolVersion::V1 && have_seq_) {
+            const uint16_t gap = seq - last_seq_ - 1;
+            if (gap < 0x8000) // 序号回退（下位机重启）时不计
+                lost_frames_ += gap;
+        }
+        last_seq_     = seq;
+        have_seq_     = true;
+        msg.seq       = seq;
+        msg.timestamp = time_point(clock::duration(stamps_[begin_]));
+        begin_ += frame_size_;
+        ++frames_;
+        return true;
+    }
+    return false;
+}
+
+void RecvFrameParser::reset() {
+    begin_    = end_ = 0;
+    have_seq_ = false;
+}
+
+void RecvFrameParser::compact(size_t free_needed) {
+    if (kCapacity - end_ >= free_needed)
+        return;
+
+    //* 移到开头后仍放不下，丢弃最旧的字节
+    const size_t size = end_ - begin_;
+    if (size + free_needed > kCapacity) {
+        const size_t drop = size + free_needed - kCapacity;
+        dropped_bytes_ += drop;
+        begin_ += drop;
+    }
+    std::memmove(bytes_.data(), bytes_.data() + begin_, end_ - begin_);
+    std::memmove(stamps_.data(), stamps_.data() + begin_, (end_ - begin_) * sizeof(int64_t));
+    end_ -= begin_;
+    begin_ = 0;
+}
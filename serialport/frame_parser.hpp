@@ -0,0 +1,88 @@
+#ifndef __FRAME_PARSER_HPP__
+#define __FRAME_PARSER_HPP__
+
+#include "protocol.hpp"
+#include "structs.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 串口接收帧的流式解析器
+ * @details 串口按字节流到达，一次读取到的字节数是任意的，帧可以从任意位置开始、被拆到多次读取中。
+ * 解析器把读到的字节追加到内部缓冲区，从中查找帧头 kProtocolRecvHead，帧尾也正确才认为是一帧；
+ * 否则只丢弃这一个字节，从下一个字节开始重新查找，因此丢失、多出字节后只影响附近的一两帧。
+ *
+ * 每个字节按 “读取完成的时间 - 之后到达的字节数 × 单字节传输时间” 估计到达时间，帧的时间戳为帧头字节的到达时间。
+ *
+ * 协议 v2 起，帧头、帧尾都正确后再计算 CRC，CRC 错误同样只跳过一个字节；
+ * 数据中的 0x3A 绝大多数在检查帧尾时就被排除，CRC 只对少数候选帧计算。序号不连续时计入 lost_frames()。
+ * 协议 v3 的时间戳原样放入 StampedRecvMsg::stamps，由 ClockSync 使用。
+ *
+ * @remark 单生产单消费，不是线程安全的，由串口处理线程独占
+ */
+class RecvFrameParser {
+  public:
+    using clock      = std::chrono::system_clock;
+    using time_point = clock::time_point;
+
+    static constexpr size_t kCapacity = 1024; // 缓冲区可容纳的字节数，调用方应在每次 push() 后取完所有帧
+
+    /**
+     * @param byte_time 传输一个字节的时间。8N1 时为 10 bit / 波特率
+     */
+    explicit RecvFrameParser(
+        std::chrono::nanoseconds byte_time = std::chrono::nanoseconds(0), ProtocolVersion version = ProtocolVersion::V1
+    );
+
+    /**
+     * @brief 追加一次读取到的字节
+     * @param arrival 读取完成的时间，即最后一个字节的到达时间
+     * @remark 缓冲区放不下时丢弃最旧的字节，计入 dropped_bytes()
+     */
+    void push(const uint8_t *data, size_t size, time_point arrival);
+
+    /**
+     * @brief 取出下一个完整的帧
+     * @return 缓冲区中没有完整的帧时返回 false
+     */
+    bool pop(StampedRecvMsg &msg);
+
+    /**
+     * @brief 清空缓冲区并忘记上一帧的序号，例如串口重连之后
+     * @details 重连后的第一帧不与断开前的序号比较，不计入 lost_frames()。各项统计是累计值，不清零
+     */
+    void reset();
+
+    static std::chrono::nanoseconds byte_time_of(int baud_rate, int data_bits = 8, int stop_bits = 1, int parity = 0);
+
+    ProtocolVersion version() const { return version_; }
+    size_t frame_size() const { return frame_size_; }
+
+    uint64_t frames() const { return frames_; }               // 解析出的帧数
+    uint64_t skipped_bytes() const { return skipped_bytes_; } // 重新同步时跳过的字节数
+    uint64_t dropped_bytes() const { return dropped_bytes_; } // 缓冲区溢出丢弃的字节数
+    uint64_t crc_errors() const { return crc_errors_; }       // 帧头帧尾正确但 CRC 错误的次数（v2 起）
+    uint64_t lost_frames() const { return lost_frames_; }     // 按序号推算的丢帧数（v2 起）
+
+  private:
+    void compact(size_t free_needed);
+
+    std::chrono::nanoseconds byte_time_;
+    ProtocolVersion version_;
+    size_t frame_size_;
+
+    // 有效字节为 [begin_, end_)，尾部空间不够时整体移到开头
+    std::array<uint8_t, kCapacity> bytes_;
+    std::array<int64_t, kCapacity> stamps_; // 每个字节的到达时间
+    size_t begin_{0}, end_{0};
+    int64_t last_stamp_{0}; // 上一个字节的到达时间，保证时间戳单调递增
+
+    uint16_t last_seq_{0};
+    bool have_seq_{false}; // last_seq_ 是否有效：解析出第一帧之前、reset() 之后为 false
+    uint64_t frames_{0}, skipped_bytes_{0}, dropped_bytes_{0}, crc_errors_{0}, lost_frames_{0};
+};
+
+#endif // __FRAME_PARSER_HPP__
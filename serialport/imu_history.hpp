@@ -0,0 +1,213 @@
+/**
+ * @file imu_history.hpp
+ * @author arca
+ * @brief Timestamp-ordered IMU history with interpolated lookups.
+ * @version 0.1
+ * @date 2025-03-17
+ */
+
+#ifndef __IMU_HISTORY_HPP__
+#define __IMU_HISTORY_HPP__
+
+#include "config.hpp"
+#include "structs.hpp"
+
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+
+/**
+ * @brief 按时间排序的 IMU 姿态历史，单写多读，无锁
+ * @details 写端（串口处理线程）按接收顺序追加样本，写满后覆盖最旧的样本；任意多个读端用 at() 查询任意时刻的姿态，
+ * 二分查找前后两个样本，对姿态四元数做球面插值，O(log n)。
+ *
+ * 每个槽位带一个序号（seqlock）：写端写入第 i 个样本前把序号置为 2i + 1，写完置为 2i + 2。
+ * 读端前后两次读到 2i + 2 才认为读到了完整的第 i 个样本，否则说明槽位正在被覆盖，重新查找。
+ * 槽位的字段都是原子变量，读写冲突时读到的旧值会被丢弃，不存在数据竞争。
+ *
+ * @remark 姿态按 yaw-pitch-roll（Z-Y-X）顺序转换为四元数。yaw 可能是多圈累计的角度，
+ * 查询结果的 yaw 取与前一个样本的 yaw 最接近的等价角度
+ */
+class ImuHistory {
+  public:
+    using clock      = std::chrono::system_clock;
+    using time_point = clock::time_point;
+
+    static constexpr size_t kCapacity = 1024; // 2 的幂，按 1 kHz 的 IMU 频率约保存 1 s
+
+    ImuHistory() = default;
+
+    ImuHistory(const ImuHistory &)            = delete;
+    ImuHistory &operator=(const ImuHistory &) = delete;
+
+    /**
+     * @brief 追加一个样本。写端专用
+     * @return 时间戳不晚于上一个样本时丢弃该样本并返回 false
+     */
+    bool push(const IMUInfo &imu) {
+        const int64_t stamp = imu.timestamp.time_since_epoch().count();
+        if (stamp <= last_stamp_)
+            return false;
+
+        const Eigen::Quaterniond q = to_quaternion(imu);
+        const uint64_t index       = count_.load(std::memory_order_relaxed);
+        Slot &slot                 = slots_[index & kMask];
+
+        slot.seq.store(2 * index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.stamp.store(stamp, std::memory_order_relaxed);
+        slot.yaw.store(imu.yaw, std::memory_order_relaxed);
+        slot.q[0].store(q.w(), std::memory_order_relaxed);
+        slot.q[1].store(q.x(), std::memory_order_relaxed);
+        slot.q[2].store(q.y(), std::memory_order_relaxed);
+        slot.q[3].store(q.z(), std::memory_order_relaxed);
+        slot.seq.store(2 * index + 2, std::memory_order_release);
+
+        count_.store(index + 1, std::memory_order_release);
+        last_stamp_ = stamp;
+        return true;
+    }
+
+    /**
+     * @brief 查询 t 时刻的姿态，返回的 timestamp 为 t
+     * @param tolerance t 晚于最新样本不超过 tolerance 时返回最新样本（timestamp 为该样本的时间）
+     * @return 没有样本、t 早于保存的最旧样本、或晚于最新样本超过 tolerance 时为 std::nullopt
+     */
+    std::optional<IMUInfo> at(time_point t, clock::duration tolerance = clock::duration::zero()) const {
+        const int64_t target = t.time_since_epoch().count();
+
+        while (true) {
+            const uint64_t count = count_.load(std::memory_order_acquire);
+            if (count == 0)
+                return std::nullopt;
+
+            // 留出一个槽位给写端正在写入的样本
+            uint64_t lo = count > kCapacity - 1 ? count - (kCapacity - 1) : 0;
+            uint64_t hi = count - 1;
+
+            Sample before, after;
+            if (!read(hi, after))
+                continue;
+            if (target >= after.stamp) {
+                if (target - after.stamp > tolerance.count())
+                    return std::nullopt;
+                return to_imu_info(after.q, after.yaw, time_point(clock::duration(after.stamp)));
+            }
+            if (!read(lo, before))
+                continue;
+            if (target < before.stamp)
+                return std::nullopt;
+
+            //* 二分查找，保持 before.stamp <= target < after.stamp
+            bool overwritten = false;
+            while (hi - lo > 1) {
+                const uint64_t mid = lo + (hi - lo) / 2;
+                Sample sample;
+                if (!read(mid, sample)) {
+                    overwritten = true;
+                    break;
+                }
+                if (sample.stamp <= target) {
+                    lo     = mid;
+                    before = sample;
+                } else {
+                    hi    = mid;
+                    after = sample;
+                }
+            }
+            if (overwritten)
+                continue;
+
+            const double ratio = double(target - before.stamp) / double(after.stamp - before.stamp);
+            return to_imu_info(before.q.slerp(ratio, after.q), before.yaw, t);
+        }
+    }
+
+    /**
+     * @brief 最新的样本
+     */
+    std::optional<IMUInfo> latest() const {
+        Sample sample;
+        while (true) {
+            const uint64_t count = count_.load(std::memory_order_acquire);
+            if (count == 0)
+                return std::nullopt;
+            if (read(count - 1, sample))
+                return to_imu_info(sample.q, sample.yaw, time_point(clock::duration(sample.stamp)));
+        }
+    }
+
+    // 写入的样本总数
+    uint64_t written() const { return count_.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr uint64_t kMask = kCapacity - 1;
+    static_assert((kCapacity & kMask) == 0, "kCapacity must be a power of 2");
+
+    struct Sample {
+        int64_t stamp;
+        double yaw; // 原始 yaw，用于恢复多圈角度
+        Eigen::Quaterniond q;
+    };
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+        std::atomic<int64_t> stamp{0};
+        std::atomic<double> yaw{0};
+        std::array<std::atomic<double>, 4> q{}; // w, x, y, z
+    };
+
+    /**
+     * @brief 读取第 index 个样本，槽位已被覆盖或正在写入时返回 false
+     */
+    bool read(uint64_t index, Sample &sample) const {
+        const Slot &slot        = slots_[index & kMask];
+        const uint64_t expected = 2 * index + 2;
+        if (slot.seq.load(std::memory_order_acquire) != expected)
+            return false;
+
+        sample.stamp = slot.stamp.load(std::memory_order_relaxed);
+        sample.yaw   = slot.yaw.load(std::memory_order_relaxed);
+        sample.q     = Eigen::Quaterniond(
+            slot.q[0].load(std::memory_order_relaxed),
+            slot.q[1].load(std::memory_order_relaxed),
+            slot.q[2].load(std::memory_order_relaxed),
+            slot.q[3].load(std::memory_order_relaxed)
+        );
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.seq.load(std::memory_order_relaxed) == expected;
+    }
+
+    static Eigen::Quaterniond to_quaternion(const IMUInfo &imu) {
+        return Eigen::AngleAxisd(imu.yaw * kDegreeToRadian, Eigen::Vector3d::UnitZ())
+             * Eigen::AngleAxisd(imu.pitch * kDegreeToRadian, Eigen::Vector3d::UnitY())
+             * Eigen::AngleAxisd(imu.roll * kDegreeToRadian, Eigen::Vector3d::UnitX());
+    }
+
+    /**
+     * @param reference_yaw 结果的 yaw 取与它相差不超过 180° 的等价角度
+     */
+    static IMUInfo to_imu_info(const Eigen::Quaterniond &q, double reference_yaw, time_point t) {
+        const Eigen::Matrix3d R = q.toRotationMatrix();
+        const double yaw        = std::atan2(R(1, 0), R(0, 0)) * kRadianToDegree;
+
+        IMUInfo imu;
+        imu.roll      = std::atan2(R(2, 1), R(2, 2)) * kRadianToDegree;
+        imu.pitch     = std::asin(std::clamp(-R(2, 0), -1.0, 1.0)) * kRadianToDegree;
+        imu.yaw       = yaw + 360 * std::round((reference_yaw - yaw) / 360);
+        imu.timestamp = t;
+        return imu;
+    }
+
+    std::array<Slot, kCapacity> slots_;
+    alignas(64) std::atomic<uint64_t> count_{0};              // 已写入的样本总数
+    int64_t last_stamp_{std::numeric_limits<int64_t>::min()}; // 写端独占
+};
+
+#endif // __IMU_HISTORY_HPP__
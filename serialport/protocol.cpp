@@ -0,0 +1,48 @@
+#include "protocol.hpp"
+
+#include <array>
+
+namespace {
+
+constexpr uint16_t kCrc16Poly = 0x8408; // 0x1021 按位反射
+
+/**
+ * @brief slice-by-8 的查表
+ * @details table[0] 为逐字节查表；table[k][b] 为字节 b 之后再经过 k 个 0 字节后的 CRC，
+ * 于是 8 个字节的 CRC 可以由 8 次独立的查表异或得到，没有逐字节的依赖链
+ */
+constexpr std::array<std::array<uint16_t, 256>, 8> make_crc16_table() {
+    std::array<std::array<uint16_t, 256>, 8> table{};
+    for (int b = 0; b < 256; ++b) {
+        uint16_t crc = b;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = crc & 1 ? (crc >> 1) ^ kCrc16Poly : crc >> 1;
+        table[0][b] = crc;
+    }
+    for (int k = 1; k < 8; ++k)
+        for (int b = 0; b < 256; ++b)
+            table[k][b] = (table[k - 1][b] >> 8) ^ table[0][table[k - 1][b] & 0xFF];
+    return table;
+}
+
+constexpr auto kCrc16Table = make_crc16_table();
+
+} // namespace
+
+uint16_t crc16_bytewise(const uint8_t *data, size_t size, uint16_t crc) {
+    for (size_t i = 0; i < size; ++i)
+        crc = (crc >> 8) ^ kCrc16Table[0][(crc ^ data[i]) & 0xFF];
+    return crc;
+}
+
+uint16_t crc16(const uint8_t *data, size_t size, uint16_t crc) {
+    const auto &t = kCrc16Table;
+    for (; size >= 8; data += 8, size -= 8) {
+        // 前两个字节先与当前 CRC 异或，之后 8 个字节各查一张表
+        const uint8_t b0 = data[0] ^ (crc & 0xFF);
+        const uint8_t b1 = data[1] ^ (crc >> 8);
+        crc = t[7][b0] ^ t[6][b1] ^ t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^ t[1][data[6]]
+            ^ t[0][data[7]];
+    }
+    return crc16_bytewise(data, size, crc);
+}
@@ -0,0 +1,164 @@
+#ifndef __PROTOCOL_HPP__
+#define __PROTOCOL_HPP__
+
+#include "structs.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief 串口协议版本，由 comm.toml 中的 protocol_version 指定，需与下位机一致
+ * @details
+ * - v1：帧即 VisionPLCSendMsg / VisionPLCRecvMsg 本身，只有帧头、帧尾可以校验；
+ * - v2：在帧尾之前加入 16 位序号与 CRC-16，CRC 覆盖帧头到序号的所有字节；
+ * - v3：在 v2 的序号之前再加入时间戳（SendTimestamps / RecvTimestamps），用于测量往返时间与时钟偏差，
+ *   见 clock_sync.hpp。
+ *
+ *   | 帧头 | v1 的数据 | 时间戳 (v3) | seq (uint16) | crc (uint16) | 帧尾 |
+ *
+ * 多字节字段均为小端。CRC-16 与裁判系统协议相同（多项式 0x1021 反射，初值 0xFFFF，即 CRC-16/MCRF4XX），
+ * 下位机可以直接复用裁判系统的校验代码
+ */
+enum class ProtocolVersion : int {
+    V1 = 1,
+    V2 = 2,
+    V3 = 3,
+};
+
+constexpr size_t kProtocolV2Overhead = sizeof(uint16_t) * 2; // 序号 + CRC
+
+/**
+ * @brief 消息 Msg 在协议 v3 中携带的时间戳
+ */
+template <typename Msg>
+struct FrameTimestamps;
+
+template <>
+struct FrameTimestamps<VisionPLCSendMsg> {
+    using type = SendTimestamps;
+};
+
+template <>
+struct FrameTimestamps<VisionPLCRecvMsg> {
+    using type = RecvTimestamps;
+};
+
+template <typename Msg>
+using timestamps_of = typename FrameTimestamps<Msg>::type;
+
+/**
+ * @brief 消息 Msg 在指定协议下，帧尾之前附加的字节数
+ */
+template <typename Msg>
+constexpr size_t frame_overhead_of(ProtocolVersion version) {
+    switch (version) {
+    case ProtocolVersion::V2:
+        return kProtocolV2Overhead;
+    case ProtocolVersion::V3:
+        return kProtocolV2Overhead + sizeof(timestamps_of<Msg>);
+    default:
+        return 0;
+    }
+}
+
+/**
+ * @brief 消息 Msg 在指定协议下的帧长
+ */
+template <typename Msg>
+constexpr size_t frame_size_of(ProtocolVersion version) {
+    return sizeof(Msg) + frame_overhead_of<Msg>(version);
+}
+
+/**
+ * @brief CRC-16/MCRF4XX，slice-by-8 查表，每次处理 8 个字节
+ * @param crc 上一段数据的 CRC，用于分段计算
+ */
+uint16_t crc16(const uint8_t *data, size_t size, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief 逐字节查表的 CRC-16，与 crc16() 结果相同，用于测试与对比
+ */
+uint16_t crc16_bytewise(const uint8_t *data, size_t size, uint16_t crc = 0xFFFF);
+
+/**
+ * @brief 把消息编码为帧
+ * @param out 至少 frame_size_of<Msg>(version) 字节
+ * @param stamps 协议 v3 的时间戳，之前的协议忽略
+ * @return 帧长
+ */
+template <typename Msg>
+size_t encode_frame(
+    const Msg &msg, uint16_t seq, ProtocolVersion version, uint8_t *out, const timestamps_of<Msg> &stamps = {}
+) {
+    std::memcpy(out, &msg, sizeof(Msg));
+    if (version == ProtocolVersion::V1)
+        return sizeof(Msg);
+
+    // 帧尾之前插入时间戳、序号与 CRC
+    const size_t size = frame_size_of<Msg>(version);
+    uint8_t *p        = out + sizeof(Msg) - 1;
+    if (version == ProtocolVersion::V3) {
+        std::memcpy(p, &stamps, sizeof(stamps));
+        p += sizeof(stamps);
+    }
+    p[0] = seq & 0xFF;
+    p[1] = seq >> 8;
+
+    const uint16_t crc = crc16(out, size - 3);
+    p[2]               = crc & 0xFF;
+    p[3]               = crc >> 8;
+    p[4]               = reinterpret_cast<const uint8_t *>(&msg)[sizeof(Msg) - 1];
+    return size;
+}
+
+/**
+ * @brief 把帧解码为消息，不检查帧头、帧尾
+ * @param frame frame_size_of<Msg>(version) 字节
+ * @param stamps 协议 v3 的时间戳，之前的协议置为 0
+ * @return v2 起为 CRC 是否正确；v1 总是 true
+ */
+template <typename Msg>
+bool decode_frame(const uint8_t *frame, ProtocolVersion version, Msg &msg, uint16_t &seq, timestamps_of<Msg> &stamps) {
+    stamps = {};
+    if (version == ProtocolVersion::V1) {
+        std::memcpy(&msg, frame, sizeof(Msg));
+        seq = 0;
+        return true;
+    }
+
+    const size_t size  = frame_size_of<Msg>(version);
+    const uint8_t *p   = frame + size - 5; // 序号
+    const uint16_t crc = p[2] | (p[3] << 8);
+    if (crc16(frame, size - 3) != crc)
+        return false;
+
+    std::memcpy(reinterpret_cast<uint8_t *>(&msg), frame, sizeof(Msg) - 1);
+    reinterpret_cast<uint8_t *>(&msg)[sizeof(Msg) - 1] = p[4];
+    seq                                                 = p[0] | (p[1] << 8);
+    if (version == ProtocolVersion::V3)
+        std::memcpy(&stamps, frame + sizeof(Msg) - 1, sizeof(stamps));
+    return true;
+}
+
+template <typename Msg>
+bool decode_frame(const uint8_t *frame, ProtocolVersion version, Msg &msg, uint16_t &seq) {
+    timestamps_of<Msg> stamps;
+    return decode_frame(frame, version, msg, seq, stamps);
+}
+
+/**
+ * @brief 改写 v3 帧中的时间戳并重新计算 CRC，其余字节不变
+ * @details 发送帧在队列中等待时，编码时填入的 host_send 已经过时，真正写入串口前用它改写
+ */
+template <typename Msg>
+void restamp_frame(uint8_t *frame, const timestamps_of<Msg> &stamps) {
+    constexpr size_t size = frame_size_of<Msg>(ProtocolVersion::V3);
+    std::memcpy(frame + sizeof(Msg) - 1, &stamps, sizeof(stamps));
+
+    const uint16_t crc = crc16(frame, size - 3);
+    frame[size - 3]    = crc & 0xFF;
+    frame[size - 2]    = crc >> 8;
+}
+
+#endif // __PROTOCOL_HPP__
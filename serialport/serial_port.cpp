@@ -19,8 +19,7 @@ SerialPort::SerialPort(const std::string &config_path)
     : port_index_{0},
       port_ok{false},
       updated_{0},
-      last_recv_(std::chrono::steady_clock::now()),
-      recv_buffer_(kRecvMsgCount) {
+      last_recv_(std::chrono::steady_clock::now()) {
     try {
         this->log_ = spdlog::stdout_color_mt("serial_port");
         this->log_->set_level(spdlog::level::trace);
@@ -43,15 +42,35 @@ SerialPort::SerialPort(const std::string &config_path)
             if constexpr (SerialPortDebug)
                 SPDLOG_LOGGER_INFO(this->log_, "serial_port: alternative ports = {}", ss.str());
         }();
+
+        cfg_.send_interval   = T["send_interval"].value_or(cfg_.send_interval);
+        cfg_.command_timeout = T["command_timeout"].value_or(cfg_.command_timeout);
+
+        cfg_.protocol_version  = T["protocol_version"].value_or(cfg_.protocol_version);
+        cfg_.clock_sync_window = T["clock_sync_window"].value_or(cfg_.clock_sync_window);
+        if (cfg_.protocol_version < 1 || cfg_.protocol_version > 3) {
+            SPDLOG_LOGGER_ERROR(this->log_, "serial_port: unknown protocol_version {}, using 1", cfg_.protocol_version);
+            cfg_.protocol_version = 1;
+        }
     } catch (std::exception &err) {
         SPDLOG_LOGGER_ERROR(this->log_, "serial_port: error reading config: {}, using fallback", err.what());
     }
+
+    const auto byte_time = RecvFrameParser::byte_time_of(cfg_.baud_rate, cfg_.data_bits, cfg_.stop_bits, cfg_.parity);
+
+    this->protocol_        = static_cast<ProtocolVersion>(cfg_.protocol_version);
+    this->send_frame_size_ = frame_size_of<VisionPLCSendMsg>(this->protocol_);
+    this->parser_          = RecvFrameParser(byte_time, this->protocol_);
+    this->clock_sync_      = std::make_unique<ClockSync>(
+        std::chrono::milliseconds(cfg_.clock_sync_window), byte_time * static_cast<int64_t>(this->send_frame_size_)
+    );
+    SPDLOG_LOGGER_INFO(this->log_, "serial_port: protocol v{}", cfg_.protocol_version);
 }
 
-// SerialPort::~SerialPort() {
-//     SPDLOG_LOGGER_INFO(this->log_, "serial_port: exiting......");
-//     close_port();
-// }
+SerialPort::~SerialPort() {
+    this->stop_async_io();
+    // close_port();
+}
 
 void SerialPort::initialize_port() {
     try {
@@ -93,45 +112,224 @@ void SerialPort::__set_options() {
     this->port_->set_option(serial_port_base::flow_control(serial_port_base::flow_control::none));
 }
 
-bool SerialPort::send_data(const VisionPLCSendMsg &msg) {
-    VisionPLCSendMsg msg_to_send  = msg;
-    updated_                      = 1 - updated_; // set the updated flag
+bool SerialPort::send_data(const VisionPLCSendMsg &msg, bool updated) {
+    VisionPLCSendMsg msg_to_send = msg;
+    if (updated)
+        updated_ = 1 - updated_; // set the updated flag
     msg_to_send.flag_have_updated = updated_;
     if constexpr (SerialPortDebug)
         SPDLOG_LOGGER_INFO(this->log_, "sending data");
+
+    //* 异步：交给 I/O 线程排队发送，调用方不等待串口
+    if (this->async_running_.load(std::memory_order_acquire)) {
+        std::array<uint8_t, kSendBufSize> packet;
+        encode_frame(msg_to_send, this->send_seq_++, this->protocol_, packet.data(), ClockSync::stamp_now());
+        boost::asio::post(this->io_service_, [this, packet] {
+            if (this->send_count_ == kSendQueueSize) {
+                // 队首可能正在发送，替换队尾：新的指令总是比排队中的旧指令更有用
+                this->send_queue_[(this->send_head_ + this->send_count_ - 1) % kSendQueueSize] = packet;
+                this->send_dropped_.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                this->send_queue_[(this->send_head_ + this->send_count_) % kSendQueueSize] = packet;
+                ++this->send_count_;
+            }
+            this->__async_write();
+        });
+        return true;
+    }
+
     memset(send_frame_buffer_, 0, kSendBufSize);
-    memcpy(send_frame_buffer_, &msg_to_send, kSendBufSize); // copy the data to the buffer
+    // copy the data to the buffer
+    encode_frame(msg_to_send, this->send_seq_++, this->protocol_, send_frame_buffer_, ClockSync::stamp_now());
 
     // send buffer to the port (with error handling)
     try {
         auto size_of_data_sent
-            = boost::asio::write(*this->port_, boost::asio::buffer(send_frame_buffer_, kSendBufSize));
-        return size_of_data_sent == kSendBufSize;
+            = boost::asio::write(*this->port_, boost::asio::buffer(send_frame_buffer_, this->send_frame_size_));
+        return size_of_data_sent == this->send_frame_size_;
     } catch (const std::exception &err) {
         SPDLOG_LOGGER_ERROR(this->log_, "serial_port.send_data() error: {}", err.what());
         return false;
     }
 }
 
+void SerialPort::start_async_io() {
+    if (this->async_running_.exchange(true))
+        return;
+
+    this->io_service_.restart();
+    boost::asio::post(this->io_service_, [this] {
+        this->last_recv_ = std::chrono::steady_clock::now();
+        this->__async_read();
+        this->__arm_watchdog();
+    });
+    this->io_thread_ = std::thread([this] {
+        // 读操作总在进行中，run() 不会因为没有任务而返回
+        auto work = boost::asio::make_work_guard(this->io_service_);
+        try {
+            this->io_service_.run();
+        } catch (const std::exception &err) {
+            SPDLOG_LOGGER_ERROR(this->log_, "serial_port io thread error: {}", err.what());
+        }
+    });
+    SPDLOG_LOGGER_INFO(this->log_, "serial port async io started");
+}
+
+void SerialPort::stop_async_io() {
+    if (!this->async_running_.exchange(false))
+        return;
+
+    // 在 I/O 线程中取消未完成的读写与定时器，再让 run() 返回
+    boost::asio::post(this->io_service_, [this] {
+        boost::system::error_code ec;
+        this->port_->cancel(ec);
+        this->watchdog_timer_.cancel();
+        this->reconnect_timer_.cancel();
+        this->io_service_.stop();
+    });
+    if (this->io_thread_.joinable())
+        this->io_thread_.join();
+    this->send_head_    = this->send_count_ = 0;
+    this->writing_      = false;
+    this->reconnecting_ = false;
+    SPDLOG_LOGGER_INFO(this->log_, "serial port async io stopped");
+}
+
+void SerialPort::__async_read() {
+    this->port_->async_read_some(
+        boost::asio::buffer(this->async_read_buffer_),
+        [this](const boost::system::error_code &ec, size_t size) {
+            if (ec) {
+                // 取消或关闭串口时以 operation_aborted 结束，其他错误（包括 EOF）说明串口断开
+                if (ec != boost::asio::error::operation_aborted)
+                    this->__port_down("read error: " + ec.message());
+                return;
+            }
+            this->__consume(this->async_read_buffer_.data(), size, std::chrono::system_clock::now());
+            this->__async_read();
+        }
+    );
+}
+
+void SerialPort::__async_write() {
+    if (this->writing_ || this->send_count_ == 0 || !this->port_ok)
+        return; // 重连期间消息留在队列中，重连后再发送
+
+    // 消息可能在队列中等待过，写入前才记下发送时间
+    if (this->protocol_ == ProtocolVersion::V3)
+        restamp_frame<VisionPLCSendMsg>(this->send_queue_[this->send_head_].data(), ClockSync::stamp_now());
+
+    this->writing_ = true;
+    boost::asio::async_write(
+        *this->port_,
+        boost::asio::buffer(this->send_queue_[this->send_head_].data(), this->send_frame_size_),
+        [this](const boost::system::error_code &ec, size_t) {
+            if (ec && ec != boost::asio::error::operation_aborted)
+                this->__port_down("write error: " + ec.message());
+
+            this->writing_   = false;
+            this->send_head_ = (this->send_head_ + 1) % kSendQueueSize;
+            --this->send_count_;
+            if (!ec)
+                this->__async_write();
+        }
+    );
+}
+
+void SerialPort::__arm_watchdog() {
+    this->watchdog_timer_.expires_after(std::chrono::milliseconds(kTimeout / 4));
+    this->watchdog_timer_.async_wait([this](const boost::system::error_code &ec) {
+        if (ec)
+            return; // 停止异步 I/O 时被取消
+
+        if (!this->reconnecting_
+            && std::chrono::steady_clock::now() - this->last_recv_ > std::chrono::milliseconds(kTimeout))
+            this->__port_down("no data in " + std::to_string(kTimeout) + " ms");
+        this->__arm_watchdog();
+    });
+}
+
+void SerialPort::__port_down(const std::string &reason) {
+    if (this->reconnecting_)
+        return; // 读、写、超时可能同时报告同一次断开
+
+    this->reconnecting_ = true;
+    this->port_ok       = false;
+    this->port_down_.fetch_add(1, std::memory_order_relaxed);
+    SPDLOG_LOGGER_ERROR(this->log_, "port {} down: {}, reconnecting", this->cfg_.port_name, reason);
+
+    boost::system::error_code ec;
+    this->port_->close(ec); // 未完成的读写以 operation_aborted 结束
+    this->parser_.reset();
+    this->clock_sync_->reset(); // 下位机可能已经重启，时钟不再连续
+
+    this->reconnect_delay_ = std::chrono::milliseconds(kReconnectMinDelay);
+    this->reconnect_timer_.expires_after(this->reconnect_delay_);
+    this->reconnect_timer_.async_wait([this](const boost::system::error_code &ec) {
+        if (!ec)
+            this->__try_reconnect();
+    });
+}
+
+void SerialPort::__try_reconnect() {
+    for (size_t i = 0; i < this->alt_ports_.size(); ++i) {
+        const size_t index = (this->port_index_ + i) % this->alt_ports_.size(); // 先重试当前端口
+        const auto &name   = this->alt_ports_[index];
+
+        boost::system::error_code ec;
+        this->port_->open(name, ec);
+        if (!ec) {
+            try {
+                this->__set_options();
+            } catch (const boost::system::system_error &err) {
+                ec = err.code();
+            }
+        }
+        if (ec) {
+            boost::system::error_code ignored;
+            this->port_->close(ignored);
+            if constexpr (SerialPortDebug)
+                SPDLOG_LOGGER_WARN(this->log_, "reconnect to {} failed: {}", name, ec.message());
+            continue;
+        }
+
+        this->port_index_    = index;
+        this->cfg_.port_name = name;
+        this->port_ok        = true;
+        this->reconnecting_  = false;
+        this->last_recv_     = std::chrono::steady_clock::now();
+        this->reconnects_.fetch_add(1, std::memory_order_relaxed);
+        SPDLOG_LOGGER_INFO(this->log_, "port reconnected to {}", name);
+
+        this->__async_read();
+        this->__async_write();
+        return;
+    }
+
+    //* 所有端口都失败，等待时间加倍后再试一轮
+    this->reconnect_delay_ = std::min(this->reconnect_delay_ * 2, std::chrono::milliseconds(kReconnectMaxDelay));
+    SPDLOG_LOGGER_WARN(this->log_, "no port available, retry in {} ms", this->reconnect_delay_.count());
+    this->reconnect_timer_.expires_after(this->reconnect_delay_);
+    this->reconnect_timer_.async_wait([this](const boost::system::error_code &ec) {
+        if (!ec)
+            this->__try_reconnect();
+    });
+}
+
 void SerialPort::read_raw_data_from_port() {
-    RawMessage<kRecvMsgSize> tmp_data;
+    RecvMsgBuffer tmp_data;
 
     try {
         while (true) {
-            tmp_data.data.fill(1);
-            tmp_data.timestamp = std::chrono::system_clock::now();
             if (!this->port_ok)
                 continue;
 
-            auto size_of_data_read
-                = boost::asio::read(*this->port_, boost::asio::buffer(tmp_data.data.data(), tmp_data.data.size()));
-
-            if (size_of_data_read == kRecvMsgSize)
-                this->recv_buffer_.push(tmp_data);
-            else if constexpr (SerialPortDebug)
-                SPDLOG_LOGGER_WARN(
-                    this->log_, "serial_port.read_raw_data_from_port() warning: read size mismatch, ignoring"
-                );
+            // 有多少读多少，帧的边界由处理线程中的 RecvFrameParser 确定
+            const size_t n = this->port_->read_some(boost::asio::buffer(tmp_data.data.data(), tmp_data.data.size()));
+            tmp_data.size      = n;
+            tmp_data.timestamp = std::chrono::system_clock::now(); // 读完时才是最后一个字节到达的时间
+            if (n > 0)
+                this->recv_buffer_.write_data(tmp_data);
         }
     } catch (const std::exception &err) {
         SPDLOG_LOGGER_ERROR(this->log_, "serial_port.read_raw_data_from_port() error: {}", err.what());
@@ -140,145 +338,46 @@ void SerialPort::read_raw_data_from_port() {
 }
 
 void SerialPort::process_raw_data_from_buffer() {
-    // VisionPLCRecvMsg data;
     SerialPort::RecvMsgBuffer buffer;
-    StampedRecvMsg stamped_data;
-    buffer.data.fill(0);
 
     while (true) {
-        auto data_opt = this->recv_buffer_.pop();
-        if (!data_opt.has_value())
-            continue; // wait for data
+        buffer = this->recv_buffer_.pop_wait(); // 没有数据时挂起，不占用 CPU
 
         if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_INFO(this->log_, "data received from port buffer");
-
-        buffer = data_opt.value();
-        for (size_t i = 0, n = buffer.data.size(); i < n;) { // Process raw data to msg data structure
-            size_t j = i + kRecvMsgSize;
-            if (j > n)
-                break; // range: [i, j)
-
-            //* frame verification
-            if (!this->__verify_frame<VisionPLCRecvMsg>(buffer, i, j)) {
-                // invalid frame, skip
-                SPDLOG_LOGGER_WARN(this->log_, "invalid frame, skip");
-                ++i;
-                continue;
-            }
-            // valid frame, copy to data recv buffer
-            std::memcpy(&stamped_data.msg, buffer.data.data() + i, kRecvMsgSize);
-            data_recv_buffer_.push(stamped_data);
-            i = j;
-            if constexpr (SerialPortDebug)
-                SPDLOG_LOGGER_INFO(this->log_, "data processed from bits to float");
-        }
-    }
-}
+            SPDLOG_LOGGER_INFO(this->log_, "{} bytes received from port buffer", buffer.size);
 
-template <typename MsgProtocol>
-bool SerialPort::__verify_frame(const SerialPort::RecvMsgBuffer &buffer, size_t begin, size_t end) {
-    if constexpr (SerialPortDebug)
-        SPDLOG_LOGGER_INFO(
-            this->log_,
-            "buffer[0]={:x}, buffer[1]={:x}, buffer[2]={:x}, buffer[3]={:x} buffer[4]={:x} buffer[5]={:x} "
-            "buffer[6]={:x} "
-            "buffer[7]={:x} "
-            "buffer[8]={:x} buffer[9]={:x} buffer[10]={:x} buffer[11]={:x} buffer[12]={:x} buffer[13]={:x} "
-            "buffer[14]={:x} "
-            "buffer[15]={:x} "
-            "buffer[16]={:x}",
-            buffer.data[0],
-            buffer.data[1],
-            buffer.data[2],
-            buffer.data[3],
-            buffer.data[4],
-            buffer.data[5],
-            buffer.data[6],
-            buffer.data[7],
-            buffer.data[8],
-            buffer.data[9],
-            buffer.data[10],
-            buffer.data[11],
-            buffer.data[12],
-            buffer.data[13],
-            buffer.data[14],
-            buffer.data[15],
-            buffer.data[16]
-        );
-
-    if (end - begin != sizeof(MsgProtocol)) {
-        if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_ERROR(this->log_, "invalid range size: begin={} end={}", begin, end);
-        return false;
-    } // 下标标记的 buffer 大小不对
-    else if (buffer.data.size() < sizeof(MsgProtocol)) {
-        if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_ERROR(this->log_, "buffer size {} too small", buffer.data.size());
-        return false;
-    } // buffer 太小
-    else if (begin < 0 || end < 0) {
+        this->__consume(buffer.data.data(), buffer.size, buffer.timestamp);
         if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_ERROR(this->log_, "invalid range: begin={} end={}", begin, end);
-        return false;
-    } // 下标为负数
-    else if (end > buffer.data.size() || begin > buffer.data.size()) {
-        if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_ERROR(
-                this->log_, "invalid range: begin={} end={} buffer_size={}", begin, end, buffer.data.size()
+            SPDLOG_LOGGER_INFO(
+                this->log_,
+                "frames parsed: {}, bytes skipped: {}, bytes dropped: {}",
+                this->parser_.frames(),
+                this->parser_.skipped_bytes(),
+                this->parser_.dropped_bytes()
             );
-        return false;
-    } // 下标超出范围
-    else if (buffer.data[begin] != kProtocolRecvHead || buffer.data[end - 1] != kProtocolTail) {
-        if constexpr (SerialPortDebug)
-            SPDLOG_LOGGER_ERROR(
-                this->log_, "invalid head or tail: begin={:x} end={:x}", buffer.data[begin], buffer.data[end - 1]
-            );
-        return false;
-    } // 首尾不对
-    else
-        return true;
+    }
 }
 
-void SerialPort::check_port_and_auto_reconnect() {
-    using namespace std::chrono;
-    auto last_check = high_resolution_clock::now();
-
-    while (true) {
-        if (last_recv_ == steady_clock::time_point())
-            continue;
-
-        auto now      = steady_clock::now();
-        auto duration = duration_cast<milliseconds>(now - last_recv_);
-
-        if (duration.count() < kTimeout)
-            continue; // 未超时
-        SPDLOG_LOGGER_ERROR(this->log_, "serial_port error: port timeout, reconnecting");
-
-        while (true) {
-            // test at 1Hz
-            while (1000 > duration_cast<milliseconds>(high_resolution_clock::now() - last_check).count())
-                std::this_thread::yield();
-
-            last_check = high_resolution_clock::now();
-
-            std::string next_port = alt_ports_[port_index_];               // 先重试当前端口
-            port_index_           = (port_index_ + 1) % alt_ports_.size(); // 选择下一个端口
-            port_ok               = false;                                 // 重置端口状态
-            close_port();
-            cfg_.port_name = next_port;
-
-            try {
-                initialize_port();
-                if (!port_ok)
-                    throw std::runtime_error(cfg_.port_name + " port not ok");
-                SPDLOG_LOGGER_INFO(this->log_, "port reconnected successfully");
-                break;
-            } catch (const std::exception &err) {
-                SPDLOG_LOGGER_ERROR(this->log_, "port reconnect error: {}", err.what());
-            }
+void SerialPort::__consume(const uint8_t *data, size_t size, std::chrono::system_clock::time_point arrival) {
+    StampedRecvMsg stamped_data;
+    IMUInfo imu;
+
+    this->last_recv_ = std::chrono::steady_clock::now();
+    this->parser_.push(data, size, arrival);
+    while (this->parser_.pop(stamped_data)) {
+        data_recv_buffer_.write_data(stamped_data);
+        if (this->protocol_ == ProtocolVersion::V3)
+            this->clock_sync_->add(stamped_data.stamps, stamped_data.timestamp);
+
+        imu.roll      = stamped_data.msg.imu_roll;
+        imu.pitch     = stamped_data.msg.imu_pitch;
+        imu.yaw       = stamped_data.msg.imu_yaw;
+        imu.timestamp = stamped_data.timestamp;
+        if (!imu_history_.push(imu)) {
+            if constexpr (SerialPortDebug)
+                SPDLOG_LOGGER_WARN(this->log_, "imu sample out of order, skip");
         }
     }
 }
 
-std::optional<StampedRecvMsg> SerialPort::get_data() { return data_recv_buffer_.pop(); }
\ No newline at end of file
+std::optional<StampedRecvMsg> SerialPort::get_data() { return data_recv_buffer_.pop_data(); }
\ No newline at end of file
@@ -1,21 +1,37 @@
 #ifndef __SERIAL_PORT_HPP__
 #define __SERIAL_PORT_HPP__
 
-#include "circular_buffer.hpp"
+#include "clock_sync.hpp"
+#include "frame_parser.hpp"
+#include "imu_history.hpp"
+#include "protocol.hpp"
 #include "structs.hpp"
+#include "work_queue.hpp"
+#include <array>
+#include <atomic>
 #include <boost/asio.hpp>
 #include <chrono>
 #include <memory>
 #include <optional>
 #include <spdlog/logger.h>
+#include <thread>
 
-constexpr size_t kSendBufSize  = sizeof(VisionPLCSendMsg);
-constexpr size_t kRecvMsgSize  = sizeof(VisionPLCRecvMsg);
-constexpr size_t kRecvMsgCount = 20; // buffer of 10 messages
-constexpr long long kTimeout   = 1000;
+constexpr size_t kSendBufSize   = frame_size_of<VisionPLCSendMsg>(ProtocolVersion::V3); // 最长的发送帧
+constexpr size_t kRecvMsgSize   = sizeof(VisionPLCRecvMsg);
+constexpr size_t kRecvMsgCount  = 20;  // buffer of 20 chunks
+constexpr size_t kReadChunkSize = 256; // 一次 read_some 最多读取的字节数
+constexpr size_t kSendQueueSize = 8;   // 异步发送时排队的最大消息数
+constexpr long long kTimeout    = 1000; // 超过这么久 (ms) 没有收到数据，认为串口断开
+
+constexpr long long kReconnectMinDelay = 50;   // 断开后第一次重连前的等待 (ms)
+constexpr long long kReconnectMaxDelay = 2000; // 重连等待的上限 (ms)
 
 class SerialPort {
-    using RecvMsgBuffer = RawMessage<kRecvMsgSize>; // each byte = 1 index
+    using RecvMsgBuffer = RawMessage<kReadChunkSize>; // 一次读取到的字节，帧可能跨越多个 chunk
+
+    // 串口的缓冲都是单生产者单消费者（读线程 -> 处理线程 -> 取数据线程），默认使用无锁的 SPSCRingBuffer
+    template <typename T, int Size, template <typename> class Buffer = SPSCRingBuffer>
+    using PortQueue = SyncQueue<T, Size, Buffer>;
 
   public:
     /**
@@ -27,9 +43,9 @@ class SerialPort {
 
     /**
      * @brief Destroy the Serial Port object. close port on exit
-     *
+     * @details 先停止异步 I/O，I/O 线程中的回调会访问成员
      */
-    // ~SerialPort();
+    ~SerialPort();
 
     /**
      * @brief Try to open the serial port and set the options.
@@ -46,34 +62,66 @@ class SerialPort {
 
     /**
      * @brief 向串口发送打包好的数据
+     * @details 异步 I/O 启动后只把消息放入发送队列并立即返回，不会因为串口阻塞；队列满时新消息替换队尾的消息
+     * @param updated 是否为新指令。新指令翻转 flag_have_updated；重发旧指令时不翻转，下位机据此区分
+     * @return 同步发送时为是否全部写入；异步时为是否已入队
+     */
+    bool send_data(const VisionPLCSendMsg &msg, bool updated = true);
+
+    /**
+     * @brief 启动异步 I/O：在一个线程中运行 io_context
+     * @details 读取由 async_read_some 驱动，读到的字节直接交给 RecvFrameParser；发送排队，依次 async_write。
+     * 启动后不再需要 read_raw_data_from_port() 与 process_raw_data_from_buffer() 两个线程。
+     *
+     * 读取出错（包括 EOF）或超过 kTimeout 没有收到数据时认为串口断开，在 io_context 上用定时器轮流尝试 alt_ports_，
+     * 每一轮都失败后等待时间加倍（kReconnectMinDelay ~ kReconnectMaxDelay）。重连期间 send_data() 照常入队，不会阻塞
      */
-    bool send_data(const VisionPLCSendMsg &msg);
+    void start_async_io();
+
+    /**
+     * @brief 停止 io_context 并等待 I/O 线程退出
+     */
+    void stop_async_io();
 
     /**
      * @brief 从串口读取原始数据，并放入缓冲区
+     * @details 每次 read_some 读到多少字节就放入多少字节，不要求与帧对齐
      * @remark make it `thread`
      */
     void read_raw_data_from_port();
 
     /**
-     * @brief 从缓冲区处理原始数据
+     * @brief 从缓冲区处理原始数据，用 RecvFrameParser 从字节流中解析出帧
      * @remark make it `thread`
      */
     void process_raw_data_from_buffer();
 
     /**
-     * @brief 检查串口是否正常，如果不正常则自动换串口重连
-     * @remark make it `thread`
+     * @brief 获取消息缓存里第一个数据
      */
-    void check_port_and_auto_reconnect();
+    std::optional<StampedRecvMsg> get_data();
 
     /**
-     * @brief 获取消息缓存里第一个数据
+     * @brief 收到的所有 IMU 姿态，按时间排序，可在任意线程中用 ImuHistory::at() 查询某一时刻的姿态
      */
-    std::optional<StampedRecvMsg> get_data();
+    const ImuHistory &imu_history() const { return imu_history_; }
+
+    const SerialPortConfiguration &config() const { return cfg_; }
+
+    /**
+     * @brief 串口往返时间、上下行延迟与下位机时钟偏差的估计，只有协议 v3 才有样本
+     * @details 可在任意线程中调用 ClockSync::estimate()、ClockSync::to_host()。串口断开时清空
+     */
+    const ClockSync &clock_sync() const { return *clock_sync_; }
+
+    // 异步发送时队列满而被替换的消息数
+    uint64_t send_dropped() const { return send_dropped_.load(std::memory_order_relaxed); }
+
+    uint64_t port_down_count() const { return port_down_.load(std::memory_order_relaxed); }  // 串口断开的次数
+    uint64_t reconnect_count() const { return reconnects_.load(std::memory_order_relaxed); } // 重连成功的次数
 
   protected:
-    boost::asio::io_service io_service_;             // io_service
+    boost::asio::io_service io_service_;             // io_service，异步 I/O 时由 io_thread_ 运行
     std::unique_ptr<boost::asio::serial_port> port_; // 串口
     size_t port_index_{0};                           // 端口索引
     std::string port_name_;
@@ -85,9 +133,32 @@ class SerialPort {
     uint8_t updated_;                                 // 更新位，用于判断是否是新数据
     std::chrono::steady_clock::time_point last_recv_; // 上次更新时间
 
+    ProtocolVersion protocol_{ProtocolVersion::V1}; // 串口协议版本
+    size_t send_frame_size_;                        // 当前协议下发送帧的长度
+    uint16_t send_seq_{0};                          // 协议 v2 起的发送序号
+    std::unique_ptr<ClockSync> clock_sync_;         // 由处理线程（异步时为 I/O 线程）更新
+
     uint8_t send_frame_buffer_[kSendBufSize]; // 发送缓冲区，每个 byte 一个 index
-    CircularBuffer<RecvMsgBuffer> recv_buffer_;
-    CircularBuffer<StampedRecvMsg> data_recv_buffer_;
+    PortQueue<RecvMsgBuffer, kRecvMsgCount> recv_buffer_;
+    RecvFrameParser parser_;                                        // 由处理线程（异步时为 I/O 线程）独占
+    PortQueue<StampedRecvMsg, 1, CircularBuffer> data_recv_buffer_; // 只保留最新一帧，需要覆盖语义
+    ImuHistory imu_history_;                                        // 由处理线程（异步时为 I/O 线程）写入
+
+    //* 异步 I/O，除 async_running_ 外只在 io_thread_ 中访问
+    std::thread io_thread_;
+    std::atomic<bool> async_running_{false};
+    std::array<uint8_t, kReadChunkSize> async_read_buffer_;
+    std::array<std::array<uint8_t, kSendBufSize>, kSendQueueSize> send_queue_; // 环形队列，队首正在发送
+    size_t send_head_{0}, send_count_{0};
+    bool writing_{false};                   // 是否有 async_write 未完成
+    std::atomic<uint64_t> send_dropped_{0}; // 队列满时被替换的消息数
+
+    //* 断线重连，只在 io_thread_ 中访问
+    boost::asio::steady_timer watchdog_timer_{io_service_};  // 定期检查是否长时间没有收到数据
+    boost::asio::steady_timer reconnect_timer_{io_service_}; // 下一轮重连的时间
+    std::chrono::milliseconds reconnect_delay_{kReconnectMinDelay};
+    bool reconnecting_{false};
+    std::atomic<uint64_t> port_down_{0}, reconnects_{0};
 
     std::shared_ptr<spdlog::logger> log_;
 
@@ -95,10 +166,24 @@ class SerialPort {
     void __set_options();
 
     /**
-     * @brief 检查 frame[begin, end-1] 是否符合 MsgProtocol 协议
+     * @brief 解析一次读取到的字节，更新最新消息与 IMU 历史
+     */
+    void __consume(const uint8_t *data, size_t size, std::chrono::system_clock::time_point arrival);
+
+    void __async_read();
+    void __async_write();
+
+    void __arm_watchdog();
+
+    /**
+     * @brief 串口断开：关闭串口，计数，开始重连
+     */
+    void __port_down(const std::string &reason);
+
+    /**
+     * @brief 依次尝试每个备选端口，全部失败时加倍等待时间后再试
      */
-    template <typename MsgProtocol>
-    bool __verify_frame(const RecvMsgBuffer &frame, size_t begin, size_t end);
+    void __try_reconnect();
 };
 
 #endif // __SERIAL_PORT_HPP__
\ No newline at end of file
@@ -39,6 +39,14 @@ class CircularBuffer {
         head_ = (head_ + 1) % max_size_;
         full_ = head_ == tail_;
     }
+    void push(T &&item) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        buffer_[head_] = std::move(item);
+        if (is_full())
+            tail_ = (tail_ + 1) % max_size_;
+        head_ = (head_ + 1) % max_size_;
+        full_ = head_ == tail_;
+    }
 
     /**
      * @brief Retrieve the first element from the buffer and remove it.
@@ -23,6 +23,7 @@ constexpr bool ClassifierDebug = true && EnableAllDebug;
 constexpr bool PublisherDebug  = true && EnableAllDebug;
 constexpr bool DisplayAnnotatedImageDebug = true && EnableAllDebug; // 识别完装甲板后是否显示标注装甲板的图像
 constexpr bool PublisherDiaplayImageDebug = true && EnableAllDebug;
+constexpr bool DetectorDisplayBinaryDebug = false; // 是否显示预处理后的二值图（会阻塞等待按键）
 
 constexpr bool AnnotateImageBenchmark = true;
 
@@ -0,0 +1,125 @@
+/**
+ * @file spsc_ring_buffer.hpp
+ * @author arca
+ * @brief Lock-free single-producer single-consumer ring buffer.
+ * @version 0.1
+ * @date 2025-03-02
+ */
+
+#ifndef __SPSC_RING_BUFFER_HPP__
+#define __SPSC_RING_BUFFER_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <utility>
+
+constexpr size_t kCacheLineSize = 64;
+
+/**
+ * @brief 单生产者单消费者无锁环形缓冲区
+ * @details 与 `CircularBuffer` 接口一致，但不加锁：`push()` 只能由一个线程调用，`pop()` 只能由另一个线程调用。
+ * head_（生产者写）与 tail_（消费者写）分别独占一个 cache line，并各自缓存对方下标，减少跨核同步。
+ * 缓冲区满时 `push()` 丢弃新数据并返回 false（与 `CircularBuffer` 覆盖旧数据不同）。
+ *
+ * @tparam T 元素类型，只需要可移动
+ */
+template <typename T>
+class SPSCRingBuffer {
+  public:
+    /**
+     * @param size 最少可容纳的元素数量，实际容量向上取整到 2 的幂
+     */
+    explicit SPSCRingBuffer(size_t size = 1) : max_size_(round_up(size)), mask_(max_size_ - 1) {
+        buffer_ = std::unique_ptr<T[]>(new T[max_size_]);
+    }
+
+    SPSCRingBuffer(const SPSCRingBuffer &)            = delete;
+    SPSCRingBuffer &operator=(const SPSCRingBuffer &) = delete;
+
+    /**
+     * @brief Add an item to the buffer. Producer side only.
+     *
+     * @return false if the buffer is full and the item was dropped.
+     */
+    bool push(T &&item) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_cache_ == max_size_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head - tail_cache_ == max_size_)
+                return false;
+        }
+        buffer_[head & mask_] = std::move(item);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool push(const T &item) { return push(T(item)); }
+
+    /**
+     * @brief Retrieve the first element from the buffer and remove it. Consumer side only.
+     *
+     * @return std::optional<T>
+     */
+    std::optional<T> pop() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_cache_) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail == head_cache_)
+                return std::nullopt;
+        }
+        std::optional<T> result{std::move(buffer_[tail & mask_])};
+        tail_.store(tail + 1, std::memory_order_release);
+        return result;
+    }
+
+    /**
+     * @brief Have a check at the first element inside the buffer. Consumer side only.
+     */
+    T *front() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire))
+            return nullptr;
+        return &buffer_[tail & mask_];
+    }
+
+    // Consumer side only.
+    void reset() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+    // return true if the buffer is empty
+    bool is_empty() const { return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire); }
+
+    // return true if the buffer is full
+    bool is_full() const { return size() == max_size_; }
+
+    // return the number of elements in the buffer (approximate while both sides are running)
+    size_t size() const {
+        const size_t tail = tail_.load(std::memory_order_acquire);
+        return head_.load(std::memory_order_acquire) - tail;
+    }
+
+    size_t capacity() const { return max_size_; }
+
+  private:
+    static size_t round_up(size_t size) {
+        size_t n = 1;
+        while (n < size)
+            n <<= 1;
+        return n;
+    }
+
+    const size_t max_size_;
+    const size_t mask_;
+    std::unique_ptr<T[]> buffer_;
+
+    alignas(kCacheLineSize) std::atomic<size_t> head_{0}; // 生产者写
+    size_t tail_cache_{0};                                // 生产者缓存的 tail_
+
+    alignas(kCacheLineSize) std::atomic<size_t> tail_{0}; // 消费者写
+    size_t head_cache_{0};                                // 消费者缓存的 head_
+
+    char padding_[kCacheLineSize - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+};
+
+#endif // __SPSC_RING_BUFFER_HPP__
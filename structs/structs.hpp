@@ -22,6 +22,7 @@ constexpr int kProtocolTail     = 0xAA;
 template <size_t MessageSize>
 struct RawMessage {
     std::array<uint8_t, MessageSize> data;
+    size_t size{MessageSize}; // data 中有效的字节数
     std::chrono::time_point<std::chrono::system_clock> timestamp;
 };
 
@@ -61,9 +62,32 @@ struct VisionPLCRecvMsg {
 };
 #pragma pack(pop)
 
+/**
+ * @brief 协议 v3 发送帧中的时间戳，单位 us，按 2^32 回绕
+ */
+#pragma pack(push, 1)
+struct SendTimestamps {
+    uint32_t host_send{}; // 主机写入串口的时间 (t1)，主机时钟
+};
+#pragma pack(pop)
+
+/**
+ * @brief 协议 v3 接收帧中的时间戳，单位 us，按 2^32 回绕
+ * @details 下位机回显最近收到的一帧的 host_send，并附上自己收到该帧、发出本帧的时间，构成 NTP 的四个时间戳
+ */
+#pragma pack(push, 1)
+struct RecvTimestamps {
+    uint32_t host_echo{}; // 回显的 host_send (t1)，下位机还没有收到过指令时为 0
+    uint32_t mcu_recv{};  // 下位机收完该指令帧的时间 (t2)，下位机时钟
+    uint32_t mcu_send{};  // 下位机开始发送本帧的时间 (t3)，下位机时钟
+};
+#pragma pack(pop)
+
 struct StampedRecvMsg {
     std::chrono::time_point<std::chrono::system_clock> timestamp;
     VisionPLCRecvMsg msg;
+    uint16_t seq{0};       // 协议 v2 起的帧序号，v1 时为 0
+    RecvTimestamps stamps; // 协议 v3 的时间戳，之前的协议为 0
 };
 
 struct SerialPortConfiguration {
@@ -73,7 +97,10 @@ struct SerialPortConfiguration {
     int stop_bits{1};
     int parity{0};
     int sync{1};
-    int send_interval{0};
+    int send_interval{0};        // 发送周期 (ms)，0 表示收到新指令立即发送
+    int command_timeout{50};     // 超过这么久 (ms) 没有新指令，认为指令已过期
+    int protocol_version{1};     // 串口协议版本，见 protocol.hpp
+    int clock_sync_window{2000}; // 时钟偏差取这么久 (ms) 内往返时间最小的样本（协议 v3）
 };
 
 // ========================================================
@@ -144,6 +171,94 @@ struct LightBarConfig {
     explicit LightBarConfig(std::string path = "../config/detection_tr.toml");
 };
 
+/**
+ * @brief 二值图膨胀参数
+ *
+ */
+struct MorphologyConfig {
+    int shape;       // 结构元素形状，cv::MORPH_RECT / cv::MORPH_CROSS / cv::MORPH_ELLIPSE
+    int kernel_size; // 结构元素边长
+    int iterations;  // 膨胀次数
+    bool use_opencv; // 为 true 时始终使用 cv::dilate
+
+    explicit MorphologyConfig(std::string path = "../config/detection_tr.toml");
+};
+
+/**
+ * @brief 跟踪引导的 ROI 检测参数
+ * @details 跟踪器给出的预测框按 padding 向四周扩展后，只在这些窗口内做预处理和轮廓搜索。
+ * 窗口内没有检测到装甲板，或距上次全图扫描已满 full_scan_interval 帧时，回退为全图扫描。
+ */
+struct RoiConfig {
+    bool enable;            // 是否启用 ROI 模式
+    double padding;         // 预测框每边扩展的比例（相对预测框的宽、高）
+    int min_size;           // 窗口最小边长，px
+    int full_scan_interval; // 每隔多少帧强制全图扫描一次，<= 0 表示不强制
+
+    explicit RoiConfig(std::string path = "../config/detection_tr.toml");
+};
+
+/**
+ * @brief 全图扫描分条带并行的参数
+ * @details 条带之间重叠 overlap 行，被条带边界截断的灯条由完整包含它的相邻条带负责。
+ * 高度不小于 overlap 的轮廓可能没有条带能完整包含，此时该帧回退为串行提取轮廓。
+ */
+struct TilingConfig {
+    int stripes;         // 条带数，<= 0 表示线程池线程数 + 1（调用线程也参与）
+    int overlap;         // 相邻条带重叠的行数
+    int min_stripe_rows; // 每个条带至少多少行，图像太小时减少条带数
+
+    explicit TilingConfig(std::string path = "../config/detection_tr.toml");
+};
+
+/**
+ * @brief 检测器统计信息，用于评估 ROI 模式的命中率
+ */
+struct DetectionStats {
+    uint64_t frames{0};         // 处理的帧数
+    uint64_t roi_frames{0};     // 尝试只扫描 ROI 的帧数
+    uint64_t roi_hits{0};       // ROI 内检测到装甲板的帧数
+    uint64_t full_scans{0};     // 全图扫描的帧数（含回退）
+    uint64_t miss_fallbacks{0}; // ROI 未命中而回退全图扫描的帧数
+
+    bool last_frame_roi{false};  // 上一帧的结果是否来自 ROI
+    double last_scanned_ratio{}; // 上一帧扫描的像素占全图的比例
+};
+
+/**
+ * @brief 数字分类缓存参数
+ * @details 每帧的装甲板按与上一帧装甲板四边形的 IoU 关联成短期轨迹。轨迹上连续 confirm_frames 次
+ * 推理结果与投票结果一致、且置信度不低于 confirm_confidence 后视为已确认，之后直接使用缓存的标签。
+ * 缓存的置信度每帧乘以 confidence_decay，衰减到 confirm_confidence 以下，
+ * 或距上次推理满 reverify_interval 帧时重新推理。
+ */
+struct LabelCacheConfig {
+    bool enable;               // 是否启用缓存，关闭时每帧每个装甲板都推理
+    double min_iou;            // 与上一帧装甲板关联所需的最小 IoU
+    int confirm_frames;        // 确认所需的连续一致推理次数
+    double confirm_confidence; // 确认及保持确认所需的置信度
+    double confidence_decay;   // 跳过推理的帧，缓存的置信度乘以该系数
+    int reverify_interval;     // 已确认的轨迹至少每隔多少帧推理一次
+    double vote_decay;         // 每次推理时旧投票乘以该系数，越小越相信最近的结果
+    int max_missed;            // 轨迹连续多少帧未关联上装甲板后删除
+
+    explicit LabelCacheConfig(std::string path = "../config/detection_tr.toml");
+};
+
+/**
+ * @brief 分类缓存统计信息
+ */
+struct LabelCacheStats {
+    uint64_t lookups{0};         // 查询的装甲板数
+    uint64_t hits{0};            // 命中缓存、跳过推理的装甲板数
+    uint64_t new_tracks{0};      // 未关联上已有轨迹而推理的装甲板数
+    uint64_t unconfirmed{0};     // 轨迹尚未确认而推理的装甲板数
+    uint64_t reverifications{0}; // 已确认的轨迹到期或置信度衰减而重新推理的次数
+    uint64_t label_changes{0};   // 轨迹投票结果改变的次数
+
+    double hit_rate() const { return lookups ? static_cast<double>(hits) / lookups : 0.0; }
+};
+
 /**
  * @brief 装甲板过滤参数
  *
@@ -204,6 +319,12 @@ struct Armor {
 
     // 判断装甲板是否合法
     bool is_valid(const ArmorConfig &config);
+
+    /**
+     * @brief is_valid() 中只依赖两个灯条本身的检查，不需要构造装甲板
+     * @remark 是 is_valid() 的必要条件，返回 false 的组合一定不合法，用于配对时提前剪枝
+     */
+    static bool may_pair(const LightBar &l1, const LightBar &l2, const ArmorConfig &config);
 };
 
 } // namespace AutoAim
@@ -226,12 +347,12 @@ struct AnnotatedArmorInfo {
 //! 单位均为 meter
 struct pose_under_camera_coord {
     double roll{}, pitch{}, yaw{};
-    cv::Mat rvec, tvec;
-    double direction;  // 装甲板朝向
-    double distance;   // 装甲板中心到相机的距离
-    cv::Mat center_3d; // 装甲板中心在相机坐标系下的坐标
+    cv::Vec3d rvec, tvec;
+    double direction;    // 装甲板朝向
+    double distance;     // 装甲板中心到相机的距离
+    cv::Vec3d center_3d; // 装甲板中心在相机坐标系下的坐标
 
-    void load_from_imu(const IMUInfo &imu, const cv::Mat &T_camera_to_barrel);
+    void load_from_imu(const IMUInfo &imu, const cv::Vec3d &T_camera_to_barrel);
 };
 //! 单位均为 meter
 //! Absolute: relative to barrel
@@ -239,21 +360,29 @@ struct poes_under_barrel_coord {
     double roll{}, pitch{}, yaw{};
     double direction; // 装甲板朝向
     double distance;
-    cv::Mat center_3d;
+    cv::Vec3d center_3d;
 };
 //! 单位均为 meter
 struct Armor3d : AnnotatedArmorInfo {
     double bullet_flying_time;
     double pitch_relative_to_barrel, yaw_relative_to_barrel;
 
-    cv::Mat T_armor_to_barrel; // meters
-    cv::Mat R_armor_to_barrel; // radians
+    cv::Vec3d T_armor_to_barrel;   // meters
+    cv::Matx33d R_armor_to_barrel; // 旋转矩阵
 
     //* transform information
     pose_under_camera_coord p_a2c;
     poes_under_barrel_coord p_barrel;
 };
 
+/**
+ * @brief 以跟踪器的预测为 PnP 初值的统计信息，用于调整 warmStartMaxError
+ */
+struct WarmStartStats {
+    uint64_t attempts{0}; // 以初值迭代求精的装甲板数
+    uint64_t accepted{0}; // 迭代结果被采用的装甲板数，其余退回闭式解
+};
+
 // ========================================================
 // Tracker Related Data Structures
 // ========================================================
@@ -287,11 +416,11 @@ enum class ArmorCount {
  *
  */
 struct TrackingConfig {
-    int lost_timeout;      // seconds
+    int lost_timeout{5};   // seconds
     double dt{0.01};       // s
     double max_speed{3.0}; // m/s
 
-    double kf_q, kf_r;
+    double kf_q{1}, kf_r{1};
 };
 
 } // namespace AutoAim
@@ -314,5 +443,5 @@ struct PredictedPosition {
 };
 
 struct FiringConfig {
-    double time_dalay;
+    double time_dalay{0};
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#include "bench_util.hpp"
+#include "config.hpp"
+#include "inference_backend.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.hpp>
+
+static std::vector<int> argmax_rows(const cv::Mat &logits) {
+    std::vector<int> classes;
+    for (int i = 0; i < logits.rows; ++i) {
+        cv::Point max_loc;
+        cv::minMaxLoc(logits.row(i), nullptr, nullptr, nullptr, &max_loc);
+        classes.push_back(max_loc.x);
+    }
+    return classes;
+}
+
+int main() {
+    // 后端创建时的日志会淹没耗时，只保留本程序的输出
+    spdlog::set_level(spdlog::level::off);
+    auto log = spdlog::stdout_color_mt("backend_bench");
+    log->set_level(spdlog::level::info);
+
+    constexpr int kFrames = 200, kRois = 8;
+    cv::setNumThreads(1); // 各后端都只用一个线程，比较的是推理本身
+
+    const auto config       = toml::parse_file(CONFIG_PATH + "detection_tr.toml");
+    const std::string model = PWD + config["mlp"]["model_path"].value_or("model.onnx");
+
+    cv::RNG rng(20250313);
+    std::vector<cv::Mat> rois;
+    for (int i = 0; i < kRois; ++i)
+        rois.push_back(make_roi(rng));
+    const cv::Mat batch = cv::dnn::blobFromImages(
+        rois, 1.0 / 255, cv::Size(ModelInputWidth, ModelInputHeight), cv::Scalar(0), false, false
+    );
+    const cv::Mat single = cv::dnn::blobFromImage(
+        rois.front(), 1.0 / 255, cv::Size(ModelInputWidth, ModelInputHeight), cv::Scalar(0), false, false
+    );
+
+    std::vector<int> reference; // opencv 后端的分类结果
+    for (const auto &name : AutoAim::available_inference_backends()) {
+        std::unique_ptr<AutoAim::InferenceBackend> backend;
+        try {
+            backend = AutoAim::make_inference_backend(name, model);
+        } catch (const std::exception &e) {
+            log->warn("{:<12} unavailable: {}", name, e.what());
+            continue;
+        }
+        if (name != backend->name()) {
+            log->warn("{:<12} unavailable, fell back to {}", name, backend->name());
+            continue;
+        }
+
+        cv::Mat logits;
+        double t_single = per_frame_ms(kFrames, [&] { backend->forward(single); });
+        double t_batch  = per_frame_ms(kFrames, [&] { logits = backend->forward(batch); });
+
+        const auto classes = argmax_rows(logits);
+        if (reference.empty())
+            reference = classes;
+        int agree = 0;
+        for (int i = 0; i < kRois; ++i)
+            agree += classes[i] == reference[i];
+        log->info(
+            "{:<12} 1 roi {:.3f} ms, {} rois {:.3f} ms ({:.3f} ms/roi), {}/{} classes agree with opencv",
+            name,
+            t_single,
+            kRois,
+            t_batch,
+            t_batch / kRois,
+            agree,
+            kRois
+        );
+    }
+    return 0;
+}
@@ -0,0 +1,65 @@
+#ifndef __BENCH_UTIL_HPP__
+#define __BENCH_UTIL_HPP__
+
+#include "config.hpp"
+
+#include <chrono>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 连续调用 fn frames 次，返回每次的平均耗时（ms）
+ * @remark 计时前先调用一次预热：第一次调用通常要分配输出缓冲区，推理后端也会分配内部缓冲区
+ */
+template <typename Fn>
+double per_frame_ms(int frames, Fn &&fn) {
+    fn();
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count() / frames;
+}
+
+/**
+ * @brief 依次调用 fn(0) ~ fn(rois - 1)，返回每个 ROI 的平均耗时（us）。计时前先调用 fn(0) 预热
+ */
+template <typename Fn>
+double per_roi_us(int rois, Fn &&fn) {
+    fn(0);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < rois; ++i)
+        fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / rois;
+}
+
+/**
+ * @brief 对 rois 中的每个 ROI 调用 fn，重复 rounds 轮，返回每个 ROI 的平均耗时（us）。计时前先逐个调用一次预热
+ */
+template <typename Fn>
+double per_roi_us(const std::vector<cv::Mat> &rois, int rounds, Fn &&fn) {
+    for (const auto &roi : rois)
+        fn(roi);
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        for (const auto &roi : rois)
+            fn(roi);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / (rounds * rois.size());
+}
+
+/**
+ * @brief 模拟提取出的数字区域：暗背景 + 白色数字
+ * @param type 默认与 Classifier::preprocess 之后一样为灰度图；传 CV_8UC3 得到尚未转灰度的 ROI
+ */
+inline cv::Mat make_roi(cv::RNG &rng, int type = CV_8UC1) {
+    cv::Mat roi(ModelInputHeight, ModelInputWidth, type);
+    rng.fill(roi, cv::RNG::UNIFORM, 0, 50);
+    const std::string digit = std::to_string(rng.uniform(1, 6));
+    cv::putText(roi, digit, {18, 52}, cv::FONT_HERSHEY_SIMPLEX, 1.8, cv::Scalar::all(rng.uniform(150, 256)), 5);
+    return roi;
+}
+
+#endif // __BENCH_UTIL_HPP__
@@ -1,5 +1,10 @@
 #include "circular_buffer.hpp"
+#include "spsc_ring_buffer.hpp"
 #include <iostream>
+#include <memory>
+#include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
 
 int main() {
     CircularBuffer<int> buffer(10);
@@ -14,4 +19,68 @@ int main() {
         auto val = buffer.pop();
         if (val.has_value()) { std::cout << val.value() << '\n'; }
     }
-}
\ No newline at end of file
+
+    size_t failures = 0;
+
+    // SPSCRingBuffer: 容量向上取整为 2 的幂，满时丢弃新数据
+    SPSCRingBuffer<int> ring(10);
+    if (ring.capacity() != 16) {
+        spdlog::error("spsc ring buffer: capacity {}, expected 16", ring.capacity());
+        ++failures;
+    }
+    for (int i = 0; i < 20; ++i)
+        if (ring.push(i) != (i < 16)) {
+            spdlog::error("spsc ring buffer: push #{} {}", i, i < 16 ? "rejected" : "accepted when full");
+            ++failures;
+        }
+    if (ring.size() != 16 || !ring.is_full()) {
+        spdlog::error("spsc ring buffer: size {} after filling, expected 16 and full", ring.size());
+        ++failures;
+    }
+    for (int i = 0; i < 16; ++i) {
+        auto val = ring.pop();
+        if (!val || *val != i) {
+            spdlog::error("spsc ring buffer: pop #{} returned {}", i, val ? std::to_string(*val) : "nothing");
+            ++failures;
+        }
+    }
+    if (ring.pop().has_value() || !ring.is_empty()) {
+        spdlog::error("spsc ring buffer: not empty after popping everything");
+        ++failures;
+    }
+
+    // 一个生产者、一个消费者，数据必须按顺序且不丢失地到达
+    constexpr int kCount = 100000;
+    SPSCRingBuffer<std::unique_ptr<int>> pipe(64);
+    std::thread producer([&] {
+        for (int i = 0; i < kCount;) {
+            auto item = std::make_unique<int>(i);
+            if (pipe.push(std::move(item)))
+                ++i;
+            else
+                std::this_thread::yield();
+        }
+    });
+    size_t out_of_order = 0;
+    for (int expected = 0; expected < kCount;) {
+        auto item = pipe.pop();
+        if (!item.has_value()) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (**item != expected)
+            ++out_of_order;
+        ++expected;
+    }
+    producer.join();
+    if (out_of_order) {
+        spdlog::error("spsc ring buffer: {} of {} items arrived out of order", out_of_order, kCount);
+        ++failures;
+    }
+
+    if (failures)
+        spdlog::error("cbuffer test failed: {} failures", failures);
+    else
+        spdlog::info("spsc ring buffer: {} items transferred in order, cbuffer test passed", kCount);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,54 @@
+#include "bench_util.hpp"
+#include "classifier.hpp"
+#include "config.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+int main() {
+    // 分类过程中的调试日志会淹没耗时，只保留本程序的输出
+    spdlog::set_level(spdlog::level::off);
+    auto log = spdlog::stdout_color_mt("classifier_bench");
+    log->set_level(spdlog::level::info);
+
+    constexpr int kFrames = 200;
+    cv::RNG rng(20250311);
+    AutoAim::Classifier classifier(CONFIG_PATH + "detection_tr.toml");
+
+    for (int n : {1, 2, 4, 8, 16}) {
+        std::vector<cv::Mat> rois;
+        for (int i = 0; i < n; ++i)
+            rois.push_back(make_roi(rng, CV_8UC3));
+
+        // 两种方式都会把 ROI 原地转为灰度图，每帧使用拷贝
+        std::vector<AutoAim::Labels> single(n);
+        std::vector<AutoAim::ClassifyResult> batched;
+        double t_single = per_frame_ms(kFrames, [&] {
+            for (int i = 0; i < n; ++i) {
+                cv::Mat roi = rois[i].clone();
+                single[i]   = classifier.classify(roi);
+            }
+        });
+        double t_batch = per_frame_ms(kFrames, [&] {
+            std::vector<cv::Mat> frame_rois;
+            for (const auto &roi : rois)
+                frame_rois.push_back(roi.clone());
+            batched = classifier.classify_batch(frame_rois);
+        });
+
+        int agree = 0;
+        for (int i = 0; i < n; ++i)
+            agree += single[i] == batched[i].label;
+        log->info(
+            "{:>2} rois: per-roi forward {:.3f} ms, batched forward {:.3f} ms, speedup {:.2f}x, {}/{} labels agree",
+            n,
+            t_single,
+            t_batch,
+            t_single / t_batch,
+            agree,
+            n
+        );
+    }
+    return 0;
+}
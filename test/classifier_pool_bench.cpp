@@ -0,0 +1,54 @@
+#include "bench_util.hpp"
+#include "classifier_pool.hpp"
+#include "config.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+int main() {
+    // 分类过程中的调试日志会淹没耗时，只保留本程序的输出
+    spdlog::set_level(spdlog::level::off);
+    auto log = spdlog::stdout_color_mt("classifier_pool_bench");
+    log->set_level(spdlog::level::info);
+
+    constexpr int kFrames = 100;
+    cv::setNumThreads(1); // 只比较实例间的并行
+    cv::RNG rng(20250315);
+
+    const size_t cores = std::max(1u, std::thread::hardware_concurrency());
+    auto pool          = std::make_shared<ThreadPool<>>(cores);
+    AutoAim::Classifier reference(CONFIG_PATH + "detection_tr.toml");
+
+    bool all_identical = true;
+    for (size_t size = 1; size <= std::min<size_t>(cores, 8); size *= 2) {
+        AutoAim::ClassifierPool classifiers(CONFIG_PATH + "detection_tr.toml", size);
+        classifiers.set_thread_pool(pool);
+
+        for (int n : {4, 8, 16}) {
+            std::vector<cv::Mat> rois;
+            for (int i = 0; i < n; ++i)
+                rois.push_back(make_roi(rng));
+
+            const auto expected = reference.classify_batch(rois);
+            std::vector<AutoAim::ClassifyResult> result;
+            double t = per_frame_ms(kFrames, [&] { result = classifiers.classify_batch(rois); });
+
+            bool identical = result.size() == expected.size();
+            for (size_t i = 0; identical && i < result.size(); ++i)
+                identical = result[i].label == expected[i].label
+                         && std::abs(result[i].confidence - expected[i].confidence) < 1e-4;
+            all_identical &= identical;
+            log->info(
+                "{} instances, {:>2} rois: {:.3f} ms/frame, {:.1f} rois/ms, {}",
+                size,
+                n,
+                t,
+                n / t,
+                identical ? "identical" : "MISMATCH"
+            );
+        }
+    }
+    return all_identical ? 0 : 1;
+}
@@ -0,0 +1,327 @@
+#include "clock_sync.hpp"
+#include "frame_parser.hpp"
+#include "protocol.hpp"
+#include "pty_util.hpp"
+#include "serial_port.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+using std::chrono::microseconds;
+
+constexpr uint32_t kMcuOffset = 0xF0001234; // 下位机时钟 - 主机时钟 (us)，使下位机时间很快回绕
+
+static int64_t us_of(ClockSync::time_point t) {
+    return std::chrono::duration_cast<microseconds>(t.time_since_epoch()).count();
+}
+
+/**
+ * @brief 直接构造 NTP 的四个时间戳：对称延迟、部分样本带排队抖动、主机与下位机的时间都跨过 2^32 us 回绕
+ */
+static size_t test_estimator() {
+    size_t failures = 0;
+    std::mt19937 rng(20250322);
+    std::uniform_int_distribution<int> jitter(0, 3000), percent(0, 99);
+
+    constexpr int64_t kTx = 500; // 发送帧的传输时间
+    ClockSync sync(500ms, microseconds(kTx));
+
+    // 第 3 ms 时主机时间回绕。t1 避开 0，0 表示没有回显
+    const int64_t base = (((us_of(ClockSync::clock::now()) >> 32) + 1) << 32) - 2500;
+
+    auto feed = [&](int64_t t1, int64_t up, int64_t down) {
+        const int64_t t2 = t1 + kTx + up, t3 = t2 + 300, t4 = t3 + down; // 主机时间
+        RecvTimestamps stamps;
+        stamps.host_echo = static_cast<uint32_t>(t1);
+        stamps.mcu_recv  = static_cast<uint32_t>(t2) + kMcuOffset;
+        stamps.mcu_send  = static_cast<uint32_t>(t3) + kMcuOffset;
+        return sync.add(stamps, ClockSync::time_point(microseconds(t4)));
+    };
+
+    //* 上下行各 2 ms，80% 的样本带最多 3 ms 的抖动：取到的是没有抖动的样本
+    for (int i = 0; i < 1000; ++i) {
+        const bool queued = percent(rng) < 80;
+        feed(base + i * 1000, 2000 + (queued ? jitter(rng) : 0), 2000 + (queued ? jitter(rng) : 0));
+    }
+    auto est = sync.estimate();
+    if (est.samples != 1000 || est.min_rtt != 4000us || uint32_t(est.offset.count()) != kMcuOffset
+        || est.rtt < est.min_rtt) {
+        spdlog::error(
+            "estimator: {} samples, min rtt {} us, offset {:#x}, rtt {} us",
+            est.samples,
+            est.min_rtt.count(),
+            uint32_t(est.offset.count()),
+            est.rtt.count()
+        );
+        ++failures;
+    }
+
+    // 下位机时间换算回主机时间，跨过回绕
+    const int64_t host = base + 999 * 1000 + 123;
+    const auto near    = ClockSync::time_point(microseconds(base + 1000 * 1000));
+    const auto mapped  = sync.to_host(static_cast<uint32_t>(host) + kMcuOffset, near);
+    if (!mapped || us_of(*mapped) != host) {
+        spdlog::error("estimator: to_host() is off by {} us", mapped ? us_of(*mapped) - host : 0);
+        ++failures;
+    }
+
+    //* 延迟变大：窗口内仍有更小的往返时间时保持原估计，滑出窗口后跟上
+    for (int i = 1000; i < 1200; ++i)
+        feed(base + i * 1000, 5000, 5000);
+    const auto before = sync.estimate().min_rtt;
+    for (int i = 1200; i < 2000; ++i)
+        feed(base + i * 1000, 5000, 5000);
+    est = sync.estimate();
+    if (before != 4000us || est.min_rtt != 10000us || uint32_t(est.offset.count()) != kMcuOffset
+        || est.uplink < 5000us + microseconds(kTx) - 100us || est.downlink > 5000us + 100us) {
+        spdlog::error(
+            "estimator: min rtt {} us -> {} us after the delay grew, uplink {} us, downlink {} us",
+            before.count(),
+            est.min_rtt.count(),
+            est.uplink.count(),
+            est.downlink.count()
+        );
+        ++failures;
+    }
+
+    //* 没有回显、往返时间不合理的样本被丢弃；reset() 后没有估计
+    RecvTimestamps no_echo;
+    if (sync.add(no_echo, ClockSync::clock::now()) || feed(base, 2'000'000, 0) || feed(base + 5000, -3000, 0)) {
+        spdlog::error("estimator: invalid samples were accepted");
+        ++failures;
+    }
+    sync.reset();
+    if (sync.estimate().valid() || sync.to_host(0, near)) {
+        spdlog::error("estimator: estimate survived reset()");
+        ++failures;
+    }
+    return failures;
+}
+
+/**
+ * @brief 在伪终端主端模拟下位机：回显指令的时间戳，上下行延迟可调
+ * @details 把下位机时钟取为主机时钟加 kMcuOffset。收到的指令经过 “发送帧的传输时间 + 上行延迟” 后才算下位机收到 (t2)；
+ * 每 1 ms 发送一帧 (t3)，经过 “下行延迟 + 抖动 + 接收帧的传输时间” 后才写入主端，
+ * 与真实串口上帧尾到达、读取完成的时间一致。轮询间隔带来的额外延迟只会使往返时间变大
+ */
+class McuStandIn {
+  public:
+    McuStandIn(int master, std::chrono::nanoseconds byte_time) : master_(master), byte_time_(byte_time) {
+        thread_ = std::thread([this] { this->run(); });
+    }
+
+    ~McuStandIn() { stop(); }
+
+    void stop() {
+        running_ = false;
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void set_delay(microseconds up, microseconds down, int jitter_percent = 0) {
+        up_us_          = up.count();
+        down_us_        = down.count();
+        jitter_percent_ = jitter_percent;
+    }
+
+  private:
+    using clock = std::chrono::system_clock;
+
+    static uint32_t mcu_time(clock::time_point t) { return ClockSync::to_us32(t) + kMcuOffset; }
+
+    void run() {
+        constexpr size_t kCmdSize  = frame_size_of<VisionPLCSendMsg>(ProtocolVersion::V3);
+        constexpr size_t kRecvSize = frame_size_of<VisionPLCRecvMsg>(ProtocolVersion::V3);
+        const auto cmd_time        = byte_time_ * static_cast<int64_t>(kCmdSize);
+        const auto recv_time       = byte_time_ * static_cast<int64_t>(kRecvSize);
+
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> percent(0, 99), jitter(0, 3000);
+        std::vector<uint8_t> rx;
+        std::deque<std::pair<clock::time_point, uint32_t>> incoming;             // 下位机收到的时间，host_send
+        std::deque<std::pair<clock::time_point, std::vector<uint8_t>>> outgoing; // 写入主端的时间，帧
+        RecvTimestamps stamps;
+        uint16_t seq   = 0;
+        auto next_send = clock::now();
+
+        while (running_) {
+            //* 收指令
+            uint8_t chunk[256];
+            for (ssize_t n; (n = read(master_, chunk, sizeof(chunk))) > 0;) {
+                const auto arrival = clock::now();
+                rx.insert(rx.end(), chunk, chunk + n);
+                size_t pos = 0;
+                for (; pos + kCmdSize <= rx.size(); ++pos) {
+                    VisionPLCSendMsg cmd;
+                    uint16_t cmd_seq;
+                    SendTimestamps sent;
+                    if (rx[pos] != kProtocolSendHead || rx[pos + kCmdSize - 1] != kProtocolTail
+                        || !decode_frame(rx.data() + pos, ProtocolVersion::V3, cmd, cmd_seq, sent))
+                        continue;
+                    incoming.emplace_back(arrival + cmd_time + microseconds(up_us_), sent.host_send);
+                    pos += kCmdSize - 1;
+                }
+                rx.erase(rx.begin(), rx.begin() + pos);
+            }
+
+            const auto now = clock::now();
+            while (!incoming.empty() && incoming.front().first <= now) {
+                stamps.host_echo = incoming.front().second;
+                stamps.mcu_recv  = mcu_time(incoming.front().first);
+                incoming.pop_front();
+            }
+
+            //* 每 1 ms 发送一帧，回显最近收到的指令
+            if (now >= next_send) {
+                next_send += 1ms;
+                stamps.mcu_send = mcu_time(now);
+
+                VisionPLCRecvMsg msg;
+                msg.aim_mode = 0;
+                std::vector<uint8_t> frame(kRecvSize);
+                encode_frame(msg, seq++, ProtocolVersion::V3, frame.data(), stamps);
+
+                int64_t delay = down_us_;
+                if (percent(rng) < jitter_percent_)
+                    delay += jitter(rng);
+                // 与串口一样逐帧传输：不早于前一帧传输完，保持顺序
+                auto due = now + microseconds(delay) + recv_time;
+                if (!outgoing.empty())
+                    due = std::max(due, outgoing.back().first + recv_time);
+                outgoing.emplace_back(due, std::move(frame));
+            }
+            while (!outgoing.empty() && outgoing.front().first <= now) {
+                write(master_, outgoing.front().second.data(), outgoing.front().second.size());
+                outgoing.pop_front();
+            }
+            std::this_thread::sleep_for(50us);
+        }
+    }
+
+    int master_;
+    std::chrono::nanoseconds byte_time_;
+    std::atomic<int64_t> up_us_{0}, down_us_{0};
+    std::atomic<int> jitter_percent_{0};
+    std::atomic<bool> running_{true};
+    std::thread thread_;
+};
+
+/**
+ * @brief 下位机时间 t3 换算回主机时间的误差
+ */
+static int64_t mapping_error(const SerialPort &port, const StampedRecvMsg &msg) {
+    const auto host = port.clock_sync().to_host(msg.stamps.mcu_send, msg.timestamp);
+    if (!host)
+        return INT32_MAX;
+    const uint32_t truth = msg.stamps.mcu_send - kMcuOffset;
+    return static_cast<int32_t>(ClockSync::to_us32(*host) - truth);
+}
+
+static size_t test_echo() {
+    std::string slave;
+    const int master = open_pty(slave);
+    if (master < 0) {
+        spdlog::error("failed to open a pty pair");
+        return 1;
+    }
+
+    const auto config = std::filesystem::temp_directory_path() / "clock_sync_test.toml";
+    std::ofstream(config) << "protocol_version = 3\nclock_sync_window = 500\nalternative_ports = [\"" << slave
+                          << "\"]\n";
+
+    auto port = std::make_shared<SerialPort>(config.string());
+    port->initialize_port();
+    port->start_async_io();
+
+    const auto byte_time = RecvFrameParser::byte_time_of(port->config().baud_rate);
+    const auto tx_time   = std::chrono::duration_cast<microseconds>(
+        byte_time * static_cast<int64_t>(frame_size_of<VisionPLCSendMsg>(ProtocolVersion::V3))
+    );
+    McuStandIn mcu(master, byte_time);
+
+    // 指令每 4 ms 发送一次，与 send_interval 相同
+    std::atomic<bool> sending{true};
+    std::thread commands([&] {
+        while (sending) {
+            port->send_data(VisionPLCSendMsg{});
+            std::this_thread::sleep_for(4ms);
+        }
+    });
+
+    size_t failures = 0;
+    auto check      = [&](const char *name, microseconds up, microseconds down, microseconds offset_error) {
+        const auto est       = port->clock_sync().estimate();
+        const auto msg       = port->get_data();
+        const int64_t mapped = msg ? mapping_error(*port, *msg) : INT32_MAX;
+        const int64_t offset = static_cast<int32_t>(uint32_t(est.offset.count()) - kMcuOffset);
+        spdlog::info(
+            "{}: {} samples, rtt {} us (min {} us), uplink {} us, downlink {} us, offset error {} us, "
+            "t3 mapped {} us off",
+            name,
+            est.samples,
+            est.rtt.count(),
+            est.min_rtt.count(),
+            est.uplink.count(),
+            est.downlink.count(),
+            offset,
+            mapped
+        );
+        // 轮询与调度只会让往返时间变大；按最小往返时间的样本估计，误差在几百 us 以内
+        const auto slack = 400us;
+        if (est.samples < 500 || est.min_rtt < up + down - 50us || est.min_rtt > up + down + slack
+            || std::abs(offset - offset_error.count()) > slack.count()
+            || std::abs(mapped - offset_error.count()) > slack.count()
+            || est.uplink < up + tx_time - 50us || est.uplink > up + tx_time + slack || est.downlink < down - slack) {
+            spdlog::error("{}: estimate does not match the simulated link", name);
+            ++failures;
+        }
+    };
+
+    //* 上下行各 2 ms，30% 的帧在下行带最多 3 ms 的排队
+    mcu.set_delay(2ms, 2ms, 30);
+    std::this_thread::sleep_for(1500ms);
+    check("2 ms + 2 ms", 2ms, 2ms, 0us);
+
+    //* 上行 4 ms、下行 1 ms：NTP 看不出不对称，时钟偏差的误差为 (4 - 1) / 2 ms，往返时间仍然正确
+    mcu.set_delay(4ms, 1ms);
+    std::this_thread::sleep_for(1500ms);
+    const auto est       = port->clock_sync().estimate();
+    const int64_t offset = static_cast<int32_t>(uint32_t(est.offset.count()) - kMcuOffset);
+    spdlog::info("4 ms + 1 ms: min rtt {} us, offset error {} us", est.min_rtt.count(), offset);
+    if (est.min_rtt < 5ms || est.min_rtt > 5ms + 400us || std::abs(offset - 1500) > 400) {
+        spdlog::error("4 ms + 1 ms: estimate does not match the simulated link");
+        ++failures;
+    }
+
+    sending = false;
+    commands.join();
+    port->stop_async_io();
+    mcu.stop();
+    close(master);
+    std::filesystem::remove(config);
+    return failures;
+}
+
+int main() {
+    size_t failures = 0;
+    failures += test_estimator();
+    failures += test_echo();
+
+    if (failures)
+        spdlog::error("clock sync test failed: {} failures", failures);
+    else
+        spdlog::info("clock sync test passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,196 @@
+#include "command_sender.hpp"
+#include "pty_util.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief 下位机收到的帧及其到达时间
+ */
+struct Received {
+    std::chrono::steady_clock::time_point arrival;
+    VisionPLCSendMsg msg;
+};
+
+/**
+ * @brief 在 duration 内持续读取主端，按帧切分
+ */
+static std::vector<Received> collect(int master, std::chrono::milliseconds duration) {
+    std::vector<Received> frames;
+    std::vector<uint8_t> bytes;
+    const auto end = std::chrono::steady_clock::now() + duration;
+    while (std::chrono::steady_clock::now() < end) {
+        uint8_t chunk[1024];
+        for (ssize_t n; (n = read(master, chunk, sizeof(chunk))) > 0;)
+            bytes.insert(bytes.end(), chunk, chunk + n);
+
+        size_t pos = 0;
+        for (; pos + sizeof(VisionPLCSendMsg) <= bytes.size(); pos += sizeof(VisionPLCSendMsg)) {
+            Received r{std::chrono::steady_clock::now(), {}};
+            std::memcpy(&r.msg, bytes.data() + pos, sizeof(r.msg));
+            frames.push_back(r);
+        }
+        bytes.erase(bytes.begin(), bytes.begin() + pos);
+        std::this_thread::sleep_for(200us);
+    }
+    return frames;
+}
+
+static VisionPLCSendMsg command(float pitch) {
+    VisionPLCSendMsg msg;
+    msg.pitch      = pitch;
+    msg.flag_found = 1;
+    msg.flag_fire  = 1;
+    return msg;
+}
+
+/**
+ * @brief 固定频率：突发的指令被合并，没有新指令时重发，超时后以过期指令重发且不开火
+ */
+static size_t test_fixed_rate(std::shared_ptr<SerialPort> port, int master) {
+    size_t failures = 0;
+    CommandSender sender(port, 5ms, 40ms);
+    sender.start();
+
+    for (int i = 0; i < 100; ++i)
+        sender.submit(command(float(i)));
+    auto frames = collect(master, 100ms);
+
+    if (sender.coalesced() == 0 || frames.size() >= 50) {
+        spdlog::error("fixed rate: a burst of 100 commands was sent as {} frames", frames.size());
+        ++failures;
+    }
+    // 5 ms 周期，100 ms 内约 20 帧，留出调度误差
+    if (frames.size() < 10 || frames.size() > 30) {
+        spdlog::error("fixed rate: {} frames in 100 ms with a 5 ms interval", frames.size());
+        ++failures;
+    }
+    if (frames.empty() || frames.back().msg.pitch != 99) {
+        spdlog::error("fixed rate: the newest command was not the one being held");
+        ++failures;
+    }
+
+    //* 超时后：仍持续发送，但 flag_fire 清零，flag_have_updated 不再翻转
+    size_t stale = 0, fired = 0;
+    for (size_t i = 1; i < frames.size(); ++i) {
+        if (frames[i].msg.flag_fire == 0) {
+            ++stale;
+            if (frames[i].msg.flag_have_updated != frames[i - 1].msg.flag_have_updated) {
+                spdlog::error("fixed rate: a stale resend toggled flag_have_updated");
+                ++failures;
+                break;
+            }
+        } else {
+            ++fired;
+        }
+    }
+    if (stale == 0 || fired == 0 || sender.stale_sent() == 0) {
+        spdlog::error("fixed rate: {} frames with fire, {} stale frames", fired, stale);
+        ++failures;
+    }
+    auto last = sender.last_sent();
+    if (!last || !last->stale || last->updated) {
+        spdlog::error("fixed rate: the last sent record should be a stale resend");
+        ++failures;
+    }
+
+    //* 新指令：flag_have_updated 翻转，恢复开火。提交前可能还有一个过期指令正在发送
+    uint8_t updated_before = frames.empty() ? 0 : frames.back().msg.flag_have_updated;
+    sender.submit(command(1000));
+    frames     = collect(master, 20ms);
+    auto fresh = std::find_if(frames.begin(), frames.end(), [](const Received &r) { return r.msg.pitch == 1000; });
+    if (fresh != frames.begin() && fresh != frames.end())
+        updated_before = std::prev(fresh)->msg.flag_have_updated;
+    if (fresh == frames.end() || fresh->msg.flag_fire != 1 || fresh->msg.flag_have_updated == updated_before) {
+        spdlog::error("fixed rate: a new command after timeout was not sent as an update");
+        ++failures;
+    }
+    if (sender.max_latency() > 20ms) {
+        spdlog::error("fixed rate: max latency {} us", sender.max_latency().count() / 1000);
+        ++failures;
+    }
+    spdlog::info(
+        "fixed rate: {} sent, {} updates, {} stale, {} coalesced, latency mean {} us max {} us",
+        sender.sent(),
+        sender.updates_sent(),
+        sender.stale_sent(),
+        sender.coalesced(),
+        sender.mean_latency().count() / 1000,
+        sender.max_latency().count() / 1000
+    );
+    sender.stop();
+    collect(master, 10ms); // 丢弃停止前最后发出的帧
+    return failures;
+}
+
+/**
+ * @brief send_interval = 0：收到新指令立即发送，之后只按 command_timeout 发送过期指令作为心跳
+ */
+static size_t test_immediate(std::shared_ptr<SerialPort> port, int master) {
+    size_t failures = 0;
+    CommandSender sender(port, 0ms, 40ms);
+    sender.start();
+
+    const auto submitted = std::chrono::steady_clock::now();
+    sender.submit(command(7));
+    auto frames = collect(master, 130ms);
+
+    if (frames.empty() || frames.front().msg.pitch != 7 || frames.front().arrival - submitted > 10ms) {
+        spdlog::error("immediate: the command was not sent right away");
+        ++failures;
+    }
+    // 之后约每 40 ms 一个心跳
+    if (frames.size() < 2 || frames.size() > 5) {
+        spdlog::error("immediate: {} frames in 130 ms with a 40 ms timeout", frames.size());
+        ++failures;
+    }
+    for (size_t i = 1; i < frames.size(); ++i)
+        if (frames[i].msg.flag_fire != 0 || frames[i].arrival - frames[i - 1].arrival < 25ms) {
+            spdlog::error("immediate: heartbeat {} was not a stale resend after the timeout", i);
+            ++failures;
+            break;
+        }
+    spdlog::info("immediate: {} frames, {} stale", frames.size(), sender.stale_sent());
+    sender.stop();
+    return failures;
+}
+
+int main() {
+    std::string slave;
+    const int master = open_pty(slave);
+    if (master < 0) {
+        spdlog::error("failed to open a pty pair");
+        return 1;
+    }
+
+    const auto config = std::filesystem::temp_directory_path() / "command_sender_test.toml";
+    std::ofstream(config) << "alternative_ports = [\"" << slave << "\"]\n";
+
+    auto port = std::make_shared<SerialPort>(config.string());
+    port->initialize_port();
+    port->start_async_io();
+
+    size_t failures = 0;
+    failures += test_fixed_rate(port, master);
+    failures += test_immediate(port, master);
+
+    port->stop_async_io();
+    close(master);
+    std::filesystem::remove(config);
+
+    if (failures)
+        spdlog::error("command sender test failed: {} failures", failures);
+    else
+        spdlog::info("command sender test passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,103 @@
+#include "frame_parser.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+/**
+ * @brief 随机帧组成的字节流，每帧以 loss_percent% 的概率丢失一个字节
+ */
+static std::vector<uint8_t> make_stream(std::mt19937 &rng, int frames, int loss_percent, int &intact) {
+    std::vector<uint8_t> bytes;
+    std::uniform_real_distribution<float> angle(-180, 180);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    intact = 0;
+    for (int i = 0; i < frames; ++i) {
+        VisionPLCRecvMsg msg;
+        msg.imu_roll  = angle(rng);
+        msg.imu_pitch = angle(rng);
+        msg.imu_yaw   = angle(rng);
+
+        std::vector<uint8_t> frame(sizeof(msg));
+        std::memcpy(frame.data(), &msg, sizeof(msg));
+        if (percent(rng) < loss_percent)
+            frame.erase(frame.begin() + percent(rng) % frame.size());
+        else
+            ++intact;
+        bytes.insert(bytes.end(), frame.begin(), frame.end());
+    }
+    return bytes;
+}
+
+/**
+ * @brief 原实现：每次读取恰好一帧大小的字节，只有帧头在块首时才能解析
+ */
+static int parse_fixed_reads(const std::vector<uint8_t> &bytes) {
+    constexpr size_t n = sizeof(VisionPLCRecvMsg);
+    int frames         = 0;
+    for (size_t pos = 0; pos + n <= bytes.size(); pos += n)
+        frames += bytes[pos] == kProtocolRecvHead && bytes[pos + n - 1] == kProtocolTail;
+    return frames;
+}
+
+static int parse_stream(const std::vector<uint8_t> &bytes, size_t chunk, RecvFrameParser &parser) {
+    int frames = 0;
+    StampedRecvMsg msg;
+    const auto now = RecvFrameParser::clock::now();
+    for (size_t pos = 0; pos < bytes.size(); pos += chunk) {
+        parser.push(bytes.data() + pos, std::min(chunk, bytes.size() - pos), now);
+        while (parser.pop(msg))
+            ++frames;
+    }
+    return frames;
+}
+
+int main() {
+    auto log = spdlog::stdout_color_mt("frame_parser_bench");
+    std::mt19937 rng(20250318);
+
+    // 460800 baud, 8N1：每秒 46080 字节，约 2710 帧
+    const double line_rate = 1e9 / RecvFrameParser::byte_time_of(460800).count();
+    log->info("460800 baud carries {:.0f} bytes/s", line_rate);
+
+    for (int loss : {0, 1, 5}) {
+        int intact        = 0;
+        const auto stream = make_stream(rng, 200000, loss, intact);
+
+        for (size_t chunk : {1, 17, 64, 256}) {
+            RecvFrameParser parser(RecvFrameParser::byte_time_of(460800));
+            int frames = 0;
+            parse_stream(stream, chunk, parser); // 预热
+
+            constexpr int kRounds = 5;
+            auto start            = std::chrono::steady_clock::now();
+            for (int r = 0; r < kRounds; ++r)
+                frames = parse_stream(stream, chunk, parser);
+            auto end = std::chrono::steady_clock::now();
+
+            const double seconds = std::chrono::duration<double>(end - start).count() / kRounds;
+            const double rate    = stream.size() / seconds;
+            log->info(
+                "{}% bytes lost, {:>3}-byte reads: {:.1f} MB/s ({:.0f}x line rate), frames {}/{} intact",
+                loss,
+                chunk,
+                rate / 1e6,
+                rate / line_rate,
+                frames,
+                intact
+            );
+        }
+        log->info(
+            "{}% bytes lost, fixed {}-byte reads (previous implementation): frames {}/{} intact",
+            loss,
+            sizeof(VisionPLCRecvMsg),
+            parse_fixed_reads(stream),
+            intact
+        );
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "frame_parser.hpp"
+
+#include <cstring>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+/**
+ * @brief 带损坏的字节流，以及其中没有被破坏的帧
+ */
+struct CorruptedStream {
+    std::vector<uint8_t> bytes;
+    std::vector<VisionPLCRecvMsg> intact;
+    std::vector<size_t> intact_offsets; // 帧头在 bytes 中的位置
+};
+
+static bool contains_tail(const VisionPLCRecvMsg &msg) {
+    const auto *p = reinterpret_cast<const uint8_t *>(&msg);
+    for (size_t i = 1; i + 1 < sizeof(msg); ++i)
+        if (p[i] == kProtocolTail)
+            return true;
+    return false;
+}
+
+/**
+ * @brief 随机生成帧，并随机插入垃圾字节、丢字节、破坏帧尾
+ * @details 数据中常出现 0x3A（帧头），但不出现 0xAA（帧尾），此时每个没被破坏的帧都应该被解析出来，且不会误锁定
+ */
+static CorruptedStream make_stream(std::mt19937 &rng, int frames) {
+    CorruptedStream stream;
+    std::uniform_real_distribution<float> angle(-180, 180);
+    std::uniform_int_distribution<int> byte(0, 255), percent(0, 99);
+
+    for (int i = 0; i < frames; ++i) {
+        VisionPLCRecvMsg msg;
+        do {
+            msg.imu_roll  = angle(rng);
+            msg.imu_pitch = angle(rng);
+            msg.imu_yaw   = angle(rng);
+            msg.my_color  = i % 3 ? 1 : kProtocolRecvHead;
+            msg.aim_mode  = i % 5 ? 0 : kProtocolRecvHead;
+        } while (contains_tail(msg));
+
+        //* 帧前插入垃圾字节，其中可能有帧头
+        if (percent(rng) < 5)
+            for (int k = byte(rng) % 6; k >= 0; --k) {
+                uint8_t garbage = k % 2 ? kProtocolRecvHead : byte(rng);
+                stream.bytes.push_back(garbage == kProtocolTail ? 0 : garbage);
+            }
+
+        std::vector<uint8_t> frame(sizeof(msg));
+        std::memcpy(frame.data(), &msg, sizeof(msg));
+        const int damage = percent(rng);
+        if (damage < 3)
+            frame.erase(frame.begin() + byte(rng) % frame.size()); // 丢一个字节
+        else if (damage < 5)
+            frame.back() = 0x55; // 帧尾错误
+        else {
+            stream.intact.push_back(msg);
+            stream.intact_offsets.push_back(stream.bytes.size());
+        }
+        stream.bytes.insert(stream.bytes.end(), frame.begin(), frame.end());
+    }
+    return stream;
+}
+
+/**
+ * @brief 按随机大小（1 ~ max_chunk 字节）分块送入解析器，模拟 read_some
+ * @return 解析出的帧是否恰好是所有完整的帧，时间戳是否为帧头字节的到达时间
+ */
+static bool parse_in_chunks(const CorruptedStream &stream, std::mt19937 &rng, size_t max_chunk) {
+    const auto byte_time = RecvFrameParser::byte_time_of(460800);
+    const auto start     = RecvFrameParser::time_point(std::chrono::seconds(1742200000));
+    RecvFrameParser parser(byte_time);
+
+    std::vector<StampedRecvMsg> parsed;
+    std::uniform_int_distribution<size_t> chunk(1, max_chunk);
+    for (size_t pos = 0; pos < stream.bytes.size();) {
+        const size_t n = std::min(chunk(rng), stream.bytes.size() - pos);
+        pos += n;
+        // 最后一个字节在第 pos 个字节传输完时到达
+        parser.push(stream.bytes.data() + pos - n, n, start + byte_time * pos);
+
+        StampedRecvMsg msg;
+        while (parser.pop(msg))
+            parsed.push_back(msg);
+    }
+
+    if (parsed.size() != stream.intact.size()) {
+        spdlog::error(
+            "chunks up to {} bytes: {} frames parsed, {} intact frames", max_chunk, parsed.size(), stream.intact.size()
+        );
+        return false;
+    }
+    for (size_t i = 0; i < parsed.size(); ++i) {
+        if (std::memcmp(&parsed[i].msg, &stream.intact[i], sizeof(VisionPLCRecvMsg)) != 0) {
+            spdlog::error("chunks up to {} bytes: frame {} differs", max_chunk, i);
+            return false;
+        }
+        if (parsed[i].timestamp != start + byte_time * (stream.intact_offsets[i] + 1)) {
+            spdlog::error("chunks up to {} bytes: frame {} has a wrong timestamp", max_chunk, i);
+            return false;
+        }
+    }
+    spdlog::info(
+        "chunks up to {} bytes: {} frames, {} bytes skipped while resynchronizing",
+        max_chunk,
+        parser.frames(),
+        parser.skipped_bytes()
+    );
+    return true;
+}
+
+int main() {
+    std::mt19937 rng(20250318);
+    const CorruptedStream stream = make_stream(rng, 20000);
+
+    size_t failures = 0;
+    for (size_t max_chunk : {1, 7, 17, 64, 256})
+        failures += !parse_in_chunks(stream, rng, max_chunk);
+
+    //* 超过缓冲区容量的一次读取只保留最后的字节
+    RecvFrameParser parser;
+    std::vector<uint8_t> huge(RecvFrameParser::kCapacity * 2, 0);
+    VisionPLCRecvMsg msg;
+    msg.imu_yaw = 42;
+    std::memcpy(huge.data() + huge.size() - sizeof(msg), &msg, sizeof(msg));
+    parser.push(huge.data(), huge.size(), RecvFrameParser::clock::now());
+    StampedRecvMsg out;
+    if (!parser.pop(out) || out.msg.imu_yaw != 42 || parser.dropped_bytes() != RecvFrameParser::kCapacity) {
+        spdlog::error("oversized chunk: the last frame was not kept");
+        ++failures;
+    }
+
+    if (failures)
+        spdlog::error("frame parser test failed: {} failures", failures);
+    else
+        spdlog::info("frame parser test passed");
+    return failures ? 1 : 0;
+}
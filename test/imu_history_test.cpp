@@ -0,0 +1,154 @@
+#include "imu_history.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+static const ImuHistory::time_point kStart = ImuHistory::time_point(std::chrono::seconds(1742200000));
+
+/**
+ * @brief 第 i 个样本：1 kHz，yaw 每个样本转 0.05°（多圈累计），pitch、roll 缓慢摆动
+ */
+static IMUInfo sample(int i) {
+    IMUInfo imu;
+    imu.roll      = 2 * std::sin(i * 1e-3);
+    imu.pitch     = 10 * std::sin(i * 2e-3);
+    imu.yaw       = 170 + 0.05 * i;
+    imu.timestamp = kStart + std::chrono::milliseconds(i);
+    return imu;
+}
+
+static bool near(const IMUInfo &a, const IMUInfo &b, double eps) {
+    return std::abs(a.roll - b.roll) < eps && std::abs(a.pitch - b.pitch) < eps && std::abs(a.yaw - b.yaw) < eps;
+}
+
+int main() {
+    size_t failures = 0;
+
+    //* 单线程：插值、越界、过期样本
+    {
+        ImuHistory history;
+        if (history.at(kStart) || history.latest()) {
+            spdlog::error("empty history returned a sample");
+            ++failures;
+        }
+
+        constexpr int kSamples = 400; // yaw 从 170° 转到 190°，跨过 ±180°
+        for (int i = 0; i < kSamples; ++i)
+            history.push(sample(i));
+
+        if (history.push(sample(kSamples / 2))) {
+            spdlog::error("out-of-order sample was accepted");
+            ++failures;
+        }
+
+        for (int i = 0; i + 1 < kSamples; ++i) {
+            auto exact = history.at(kStart + std::chrono::milliseconds(i));
+            if (!exact || !near(*exact, sample(i), 1e-9)) {
+                spdlog::error("sample {} is not returned as is", i);
+                ++failures;
+            }
+
+            // 相邻样本只差 0.05°，球面插值与欧拉角线性插值几乎相同
+            const auto t = kStart + std::chrono::milliseconds(i) + 250us;
+            auto mid     = history.at(t);
+            IMUInfo expected;
+            expected.roll  = 0.75 * sample(i).roll + 0.25 * sample(i + 1).roll;
+            expected.pitch = 0.75 * sample(i).pitch + 0.25 * sample(i + 1).pitch;
+            expected.yaw   = 0.75 * sample(i).yaw + 0.25 * sample(i + 1).yaw;
+            if (!mid || !near(*mid, expected, 1e-5) || mid->timestamp != t) {
+                spdlog::error("interpolation between sample {} and {} is wrong", i, i + 1);
+                ++failures;
+            }
+        }
+
+        const auto newest = kStart + std::chrono::milliseconds(kSamples - 1);
+        if (history.at(kStart - 1us)) {
+            spdlog::error("query before the oldest sample returned a value");
+            ++failures;
+        }
+        if (history.at(newest + 1ms)) {
+            spdlog::error("query after the newest sample returned a value without tolerance");
+            ++failures;
+        }
+        auto late = history.at(newest + 5ms, 10ms);
+        if (!late || late->timestamp != newest || !near(*late, sample(kSamples - 1), 1e-9)) {
+            spdlog::error("query within tolerance did not return the newest sample");
+            ++failures;
+        }
+    }
+
+    //* 写满后覆盖最旧的样本
+    {
+        ImuHistory history;
+        const int n = ImuHistory::kCapacity * 3;
+        for (int i = 0; i < n; ++i)
+            history.push(sample(i));
+        if (history.at(kStart + std::chrono::milliseconds(n - ImuHistory::kCapacity - 1))) {
+            spdlog::error("overwritten sample is still visible");
+            ++failures;
+        }
+        if (!history.at(kStart + std::chrono::milliseconds(n - ImuHistory::kCapacity / 2))) {
+            spdlog::error("recent sample is missing after wrapping");
+            ++failures;
+        }
+    }
+
+    //* 一写多读：读端查询正在被覆盖的区间，拿到的结果必须是完整的
+    {
+        ImuHistory history;
+        constexpr int kSamples = 200000;
+        std::atomic<bool> done{false};
+        std::atomic<size_t> queries{0}, mismatches{0};
+
+        std::vector<std::thread> readers;
+        for (int r = 0; r < 3; ++r)
+            readers.emplace_back([&, r] {
+                std::mt19937 rng(r);
+                while (!done.load(std::memory_order_relaxed)) {
+                    const auto written = history.written();
+                    if (written < 2)
+                        continue;
+                    // 在最近 kCapacity 个样本中随机取一个时刻，最旧的一段可能正被覆盖
+                    const int64_t span = std::min<int64_t>(written - 1, ImuHistory::kCapacity) * 1000;
+                    const int64_t us   = (written - 1) * 1000 - std::uniform_int_distribution<int64_t>(0, span)(rng);
+                    const int i        = int(us / 1000);
+                    const auto t       = kStart + std::chrono::microseconds(us);
+
+                    auto imu = history.at(t);
+                    if (!imu)
+                        continue;
+                    const double ratio = (us % 1000) / 1000.0;
+                    const double yaw   = (1 - ratio) * sample(i).yaw + ratio * sample(i + 1).yaw;
+                    if (std::abs(imu->yaw - yaw) > 1e-3)
+                        mismatches.fetch_add(1, std::memory_order_relaxed);
+                    queries.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+
+        for (int i = 0; i < kSamples; ++i)
+            history.push(sample(i));
+        done = true;
+        for (auto &reader : readers)
+            reader.join();
+
+        if (mismatches) {
+            spdlog::error(
+                "{} of {} concurrent queries returned a torn or wrong sample", mismatches.load(), queries.load()
+            );
+            ++failures;
+        }
+    }
+
+    if (failures)
+        spdlog::error("imu history test failed: {} failures", failures);
+    else
+        spdlog::info("imu history test passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,119 @@
+#include "bench_util.hpp"
+#include "config.hpp"
+#include "int8_mlp.hpp"
+
+#include <filesystem>
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.hpp>
+
+/**
+ * @brief 录制的数字区域：PWD/rois/ 下的 64x64 图像（例如比赛录像中 extract_gray_region_of_interest 的结果）。
+ * 没有录制数据时使用合成的数字区域
+ */
+static std::vector<cv::Mat> load_rois(cv::RNG &rng) {
+    std::vector<cv::Mat> rois;
+    if (std::filesystem::is_directory(PWD + "rois")) {
+        std::vector<cv::String> files;
+        cv::glob(PWD + "rois/*.png", files);
+        for (const auto &file : files) {
+            cv::Mat roi = cv::imread(file, cv::IMREAD_GRAYSCALE);
+            if (roi.size() == cv::Size(ModelInputWidth, ModelInputHeight))
+                rois.push_back(roi);
+        }
+    }
+    if (rois.empty())
+        for (int i = 0; i < 256; ++i)
+            rois.push_back(make_roi(rng));
+    return rois;
+}
+
+/**
+ * @brief 由网络输出得到类别与置信度，与 Classifier::decide 相同
+ */
+static std::pair<int, float> decide(const cv::Mat &output) {
+    cv::Mat prob;
+    cv::exp(output - *std::max_element(output.begin<float>(), output.end<float>()), prob);
+    prob /= cv::sum(prob)[0];
+    cv::Point class_id;
+    double confidence;
+    cv::minMaxLoc(prob, nullptr, &confidence, nullptr, &class_id);
+    return {class_id.x, float(confidence)};
+}
+
+static cv::Mat to_blob(const cv::Mat &roi) {
+    return cv::dnn::blobFromImage(roi, 1.0 / 255, roi.size(), cv::Scalar(0), false, false);
+}
+
+int main() {
+    // 后端创建时的日志会淹没耗时，只保留本程序的输出
+    spdlog::set_level(spdlog::level::off);
+    auto log = spdlog::stdout_color_mt("int8_mlp_bench");
+    log->set_level(spdlog::level::info);
+    cv::setNumThreads(1);
+
+    const auto config       = toml::parse_file(CONFIG_PATH + "detection_tr.toml");
+    const std::string model = PWD + config["mlp"]["model_path"].value_or("model.onnx");
+
+    cv::RNG rng(20250314);
+    const auto rois  = load_rois(rng);
+    const int rounds = std::max(1, 2000 / int(rois.size()));
+
+    //* OpenCV DNN 的浮点结果作为对照
+    AutoAim::OpenCvDnnBackend opencv(model);
+    std::vector<std::pair<int, float>> reference;
+    for (const auto &roi : rois)
+        reference.push_back(decide(opencv.forward(to_blob(roi))));
+    const double t_opencv = per_roi_us(rois, rounds, [&](const cv::Mat &roi) { opencv.forward(to_blob(roi)); });
+    log->info("{} rois, opencv dnn {:.2f} us/roi", rois.size(), t_opencv);
+
+    AutoAim::Int8Mlp mlp;
+    try {
+        mlp = std::filesystem::exists(AutoAim::int8_model_path(model))
+                  ? AutoAim::Int8Mlp::load(AutoAim::int8_model_path(model))
+                  : AutoAim::Int8Mlp::quantize(AutoAim::read_dense_network(model));
+    } catch (const std::exception &e) {
+        log->error("model cannot be run by the int8 backend: {}", e.what());
+        return 1;
+    }
+
+    const std::pair<AutoAim::Int8Mlp::Isa, const char *> isas[] = {
+        {AutoAim::Int8Mlp::Isa::Scalar, "scalar"},
+        {AutoAim::Int8Mlp::Isa::Avx2, "avx2"},
+        {AutoAim::Int8Mlp::Isa::AvxVnni, "avx-vnni"},
+    };
+    for (const auto &[isa, name] : isas) {
+        mlp.set_isa(isa);
+        if (mlp.isa() != isa) {
+            log->info("int8 {:<8} not supported by this cpu", name);
+            continue;
+        }
+
+        int agree                 = 0;
+        float max_confidence_diff = 0;
+        for (size_t i = 0; i < rois.size(); ++i) {
+            int class_id;
+            float confidence;
+            mlp.predict(rois[i], class_id, confidence);
+            agree += class_id == reference[i].first;
+            max_confidence_diff = std::max(max_confidence_diff, std::abs(confidence - reference[i].second));
+        }
+
+        const double t_int8 = per_roi_us(rois, rounds, [&](const cv::Mat &roi) {
+            int class_id;
+            float confidence;
+            mlp.predict(roi, class_id, confidence);
+        });
+        log->info(
+            "int8 {:<8} {:.2f} us/roi, speedup {:.1f}x, {}/{} classes agree with opencv, max confidence diff {:.4f}",
+            name,
+            t_int8,
+            t_opencv / t_int8,
+            agree,
+            rois.size(),
+            max_confidence_diff
+        );
+    }
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include "config.hpp"
+#include "int8_mlp.hpp"
+
+#include <cstdio>
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+using Isa = AutoAim::Int8Mlp::Isa;
+
+/**
+ * @brief 随机权重的全连接网络，隐藏层带 ReLU
+ */
+static AutoAim::DenseNetwork random_network(const std::vector<int> &widths, cv::RNG &rng) {
+    AutoAim::DenseNetwork network;
+    for (size_t l = 0; l + 1 < widths.size(); ++l) {
+        AutoAim::DenseLayer layer;
+        layer.inputs  = widths[l];
+        layer.outputs = widths[l + 1];
+        layer.relu    = l + 2 < widths.size();
+        layer.weights.resize(size_t(layer.inputs) * layer.outputs);
+        layer.bias.resize(layer.outputs);
+        for (auto &w : layer.weights)
+            w = rng.gaussian(2 / std::sqrt(layer.inputs));
+        for (auto &b : layer.bias)
+            b = rng.gaussian(0.1);
+        network.layers.push_back(std::move(layer));
+    }
+    return network;
+}
+
+/**
+ * @brief 模拟数字区域：暗背景 + 一块亮区域
+ */
+static cv::Mat make_patch(cv::RNG &rng) {
+    cv::Mat patch(ModelInputHeight, ModelInputWidth, CV_8UC1);
+    rng.fill(patch, cv::RNG::UNIFORM, 0, 50);
+    const cv::Rect digit(rng.uniform(0, 40), rng.uniform(0, 40), rng.uniform(5, 25), rng.uniform(5, 25));
+    patch(digit & cv::Rect(0, 0, ModelInputWidth, ModelInputHeight)).setTo(rng.uniform(150, 256));
+    return patch;
+}
+
+static cv::Mat to_blob(const cv::Mat &patch) {
+    return cv::dnn::blobFromImage(patch, 1.0 / 255, patch.size(), cv::Scalar(0), false, false);
+}
+
+int main() {
+    cv::RNG rng(20250314);
+    const std::vector<std::vector<int>> topologies = {
+        {ModelInputWidth * ModelInputHeight, 64, 9},
+        {ModelInputWidth * ModelInputHeight, 120, 84, 9},
+    };
+    constexpr int kPatches = 300;
+
+    size_t failures = 0;
+    for (const auto &widths : topologies) {
+        const auto network = random_network(widths, rng);
+        AutoAim::MlpBackend reference(network);
+        AutoAim::Int8Mlp mlp = AutoAim::Int8Mlp::quantize(network);
+
+        //* 保存后重新读取，结果应完全一致
+        const std::string path = "int8_mlp_test.int8";
+        mlp.save(path);
+        AutoAim::Int8Mlp loaded = AutoAim::Int8Mlp::load(path);
+        AutoAim::Int8MlpBackend backend(AutoAim::Int8Mlp::load(path));
+        std::remove(path.c_str());
+
+        int agree                 = 0;
+        float max_confidence_diff = 0;
+        for (int i = 0; i < kPatches; ++i) {
+            const cv::Mat patch = make_patch(rng);
+
+            //* 浮点网络作为对照
+            cv::Mat prob = reference.forward(to_blob(patch));
+            cv::exp(prob - *std::max_element(prob.begin<float>(), prob.end<float>()), prob);
+            prob /= cv::sum(prob)[0];
+            cv::Point expected_class;
+            double expected_confidence;
+            cv::minMaxLoc(prob, nullptr, &expected_confidence, nullptr, &expected_class);
+
+            //* 标量、AVX2、AVX-VNNI 实现（CPU 不支持的退回标量）的结果应逐位一致
+            int class_id[3];
+            float confidence[3];
+            std::vector<float> outputs[3];
+            const Isa isas[3] = {Isa::Scalar, Isa::Avx2, Isa::AvxVnni};
+            for (int k = 0; k < 3; ++k) {
+                outputs[k].resize(mlp.classes());
+                mlp.set_isa(isas[k]);
+                mlp.predict(patch, class_id[k], confidence[k], outputs[k].data());
+            }
+            for (int k = 1; k < 3; ++k)
+                if (class_id[k] != class_id[0] || confidence[k] != confidence[0] || outputs[k] != outputs[0]) {
+                    spdlog::error("{} layers, patch {}: isa {} differs from scalar", widths.size() - 1, i, k);
+                    ++failures;
+                }
+
+            int loaded_class;
+            float loaded_confidence;
+            loaded.predict(patch, loaded_class, loaded_confidence);
+            cv::Mat backend_output = backend.forward(to_blob(patch));
+            if (loaded_class != class_id[0] || loaded_confidence != confidence[0]
+                || cv::norm(backend_output, cv::Mat(outputs[0]).reshape(1, 1), cv::NORM_INF) != 0) {
+                spdlog::error("{} layers, patch {}: loaded weights give a different result", widths.size() - 1, i);
+                ++failures;
+            }
+
+            agree += class_id[0] == expected_class.x;
+            max_confidence_diff = std::max(max_confidence_diff, std::abs(confidence[0] - float(expected_confidence)));
+        }
+
+        spdlog::info(
+            "{} layers: {}/{} classes agree with float, max confidence difference {:.4f}",
+            widths.size() - 1,
+            agree,
+            kPatches,
+            max_confidence_diff
+        );
+        if (agree < kPatches * 97 / 100 || max_confidence_diff > 0.05) {
+            spdlog::error("int8 network deviates too much from float");
+            ++failures;
+        }
+    }
+
+    //* 隐藏层没有 ReLU 时激活可能为负，不能量化
+    auto network                = random_network({16, 8, 4}, rng);
+    network.layers.front().relu = false;
+    try {
+        AutoAim::Int8Mlp::quantize(network);
+        spdlog::error("network without relu was quantized");
+        ++failures;
+    } catch (const std::runtime_error &) {
+    }
+
+    if (failures)
+        spdlog::error("int8 mlp test failed: {} failures", failures);
+    else
+        spdlog::info("int8 mlp test passed");
+    return failures ? 1 : 0;
+}
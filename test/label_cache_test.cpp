@@ -0,0 +1,120 @@
+#include "config.hpp"
+#include "label_cache.hpp"
+
+#include <cmath>
+#include <functional>
+#include <spdlog/spdlog.h>
+
+static AutoAim::Armor make_armor(cv::Point2f center) {
+    AutoAim::Armor armor;
+    armor.center   = center;
+    armor.vertices = {center + cv::Point2f(-60, -25), center + cv::Point2f(60, -25), center + cv::Point2f(60, 25),
+                      center + cv::Point2f(-60, 25)};
+    return armor;
+}
+
+/**
+ * @brief 模拟 Publisher 的一帧：缓存查询 -> 对未命中的装甲板“推理” -> 投票
+ * @param classify 第 i 个装甲板的推理结果
+ * @return 每个装甲板的最终结果，inferred 为本帧推理的次数
+ */
+static std::vector<AutoAim::ClassifyResult> run_frame(
+    AutoAim::LabelCache &cache, const std::vector<AutoAim::Armor> &armors,
+    const std::function<AutoAim::ClassifyResult(size_t)> &classify, size_t &inferred
+) {
+    std::vector<AutoAim::ClassifyResult> classified;
+    for (size_t i : cache.lookup(armors))
+        classified.push_back(classify(i));
+    inferred += classified.size();
+    return cache.update(armors, classified);
+}
+
+int main() {
+    AutoAim::LabelCacheConfig config(CONFIG_PATH + "detection_tr.toml");
+    config.enable             = true;
+    config.min_iou            = 0.3;
+    config.confirm_frames     = 3;
+    config.confirm_confidence = 0.9;
+    config.confidence_decay   = 0.99;
+    config.reverify_interval  = 10;
+    config.vote_decay         = 0.7;
+    config.max_missed         = 3;
+
+    size_t failures = 0;
+    const AutoAim::ClassifyResult hero{AutoAim::Labels::Hero, 0.98}, infantry{AutoAim::Labels::Infantry3, 0.95};
+
+    //* 关闭缓存时每个装甲板每帧都推理，结果原样返回
+    {
+        AutoAim::LabelCacheConfig disabled = config;
+        disabled.enable                    = false;
+        AutoAim::LabelCache cache(disabled);
+        size_t inferred = 0;
+        for (int f = 0; f < 10; ++f) {
+            auto results = run_frame(cache, {make_armor({400, 300})}, [&](size_t) { return hero; }, inferred);
+            failures += results.size() != 1 || results[0].label != hero.label;
+        }
+        failures += inferred != 10 || cache.stats().hits != 0;
+    }
+
+    //* 两个缓慢移动的目标：确认后跳过推理，定期或置信度衰减后重新推理，标签始终正确
+    {
+        AutoAim::LabelCache cache(config);
+        size_t inferred = 0;
+        auto classify   = [&](size_t i) { return i == 0 ? hero : infantry; };
+        for (int f = 0; f < 100; ++f) {
+            auto results = run_frame(
+                cache, {make_armor({400.0f + f, 300}), make_armor({1000, 700.0f - f})}, classify, inferred
+            );
+            failures += results[0].label != hero.label || results[1].label != infantry.label;
+        }
+        const auto &stats = cache.stats();
+        spdlog::info(
+            "steady tracks: {} inferences for {} armors, hit rate {:.1f}%, {} reverifications",
+            inferred,
+            stats.lookups,
+            stats.hit_rate() * 100,
+            stats.reverifications
+        );
+        failures += stats.new_tracks != 2 || stats.hit_rate() < 0.8 || stats.reverifications == 0;
+        failures += inferred + stats.hits != stats.lookups;
+    }
+
+    //* 单次错误的推理结果被投票否决，并触发重新确认
+    {
+        AutoAim::LabelCache cache(config);
+        size_t inferred = 0;
+        const AutoAim::ClassifyResult wrong{AutoAim::Labels::Engineer, 0.6};
+        int calls     = 0;
+        auto classify = [&](size_t) { return ++calls == 5 ? wrong : hero; }; // 某次重新推理给出错误结果
+        for (int f = 0; f < 30; ++f) {
+            auto results = run_frame(cache, {make_armor({400, 300})}, classify, inferred);
+            failures += results[0].label != hero.label;
+        }
+        failures += cache.stats().label_changes != 0;
+    }
+
+    //* 目标跳变或消失超过 max_missed 帧后重新建立轨迹
+    {
+        AutoAim::LabelCache cache(config);
+        size_t inferred = 0;
+        auto classify   = [&](size_t) { return hero; };
+        for (int f = 0; f < 5; ++f)
+            run_frame(cache, {make_armor({400, 300})}, classify, inferred);
+        run_frame(cache, {make_armor({900, 300})}, classify, inferred);
+        failures += cache.stats().new_tracks != 2;
+
+        for (int f = 0; f < config.max_missed + 1; ++f)
+            run_frame(cache, {}, classify, inferred);
+        run_frame(cache, {make_armor({900, 300})}, classify, inferred);
+        failures += cache.stats().new_tracks != 3;
+    }
+
+    //* IoU
+    const auto a = make_armor({0, 0}).vertices, b = make_armor({60, 0}).vertices, c = make_armor({200, 0}).vertices;
+    failures += std::abs(AutoAim::LabelCache::iou(a, a) - 1) > 1e-6;
+    failures += std::abs(AutoAim::LabelCache::iou(a, b) - 1.0 / 3) > 1e-6;
+    failures += AutoAim::LabelCache::iou(a, c) != 0;
+
+    spdlog::info("{} failures", failures);
+    return failures ? 1 : 0;
+}
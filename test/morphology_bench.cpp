@@ -0,0 +1,87 @@
+#include "bench_util.hpp"
+#include "image_kernels.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 模拟灯条二值图：若干竖直亮条 + 少量噪点
+ */
+static cv::Mat make_mask(cv::Size size, int bars, double noise, cv::RNG &rng) {
+    cv::Mat mask = cv::Mat::zeros(size, CV_8UC1);
+    for (int i = 0; i < bars; ++i) {
+        cv::Point a(rng.uniform(0, size.width), rng.uniform(0, size.height));
+        cv::line(mask, a, a + cv::Point(rng.uniform(-8, 9), rng.uniform(20, 80)), 255, rng.uniform(3, 8));
+    }
+    cv::Mat speckle(size, CV_32F);
+    rng.fill(speckle, cv::RNG::UNIFORM, 0, 1);
+    mask.setTo(255, speckle < noise);
+    return mask;
+}
+
+static int count_mismatch(const cv::Mat &a, const cv::Mat &b) {
+    cv::Mat diff;
+    cv::compare(a, b, diff, cv::CMP_NE);
+    return cv::countNonZero(diff);
+}
+
+int main() {
+    constexpr int kFrames = 200;
+    cv::setNumThreads(1); // 只比较单线程的内核开销
+    cv::RNG rng(20250308);
+    const cv::Size size(1440, 1080);
+
+    struct Scene {
+        const char *name;
+        int bars;
+        double noise;
+    };
+    const Scene scenes[] = {
+        {"sparse (8 bars)", 8, 0},
+        {"busy (40 bars, 0.1% noise)", 40, 1e-3},
+        {"noisy (5% noise)", 8, 5e-2},
+    };
+
+    //* 当前配置：3x3 椭圆膨胀 7 次 <=> 半径 7 的 L1 菱形
+    const cv::Mat ellipse = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
+    for (const auto &scene : scenes) {
+        cv::Mat mask = make_mask(size, scene.bars, scene.noise, rng), expected, result, scratch;
+        for (int iterations : {3, 7, 15}) {
+            double t_cv   = per_frame_ms(kFrames, [&] {
+                cv::dilate(mask, expected, ellipse, cv::Point(-1, -1), iterations);
+            });
+            double t_fast = per_frame_ms(kFrames, [&] {
+                AutoAim::Kernels::dilate_diamond(mask, result, iterations, scratch);
+            });
+            spdlog::info(
+                "{:<28} ellipse 3x3 x{:<2}: cv::dilate {:.3f} ms, diamond {:.3f} ms, speedup {:.2f}x, {} pixels differ",
+                scene.name,
+                iterations,
+                t_cv,
+                t_fast,
+                t_cv / t_fast,
+                count_mismatch(expected, result)
+            );
+        }
+    }
+
+    //* 矩形：van Herk/Gil-Werman 的开销与窗口大小无关
+    cv::Mat mask = make_mask(size, 40, 1e-3, rng), expected, result, scratch;
+    for (int k : {3, 7, 15, 31, 61}) {
+        const cv::Mat rect = cv::getStructuringElement(cv::MORPH_RECT, cv::Size(k, k));
+        double t_cv        = per_frame_ms(kFrames, [&] { cv::dilate(mask, expected, rect); });
+        double t_fast      = per_frame_ms(kFrames, [&] {
+            AutoAim::Kernels::dilate_rect(mask, result, cv::Size(k, k), scratch);
+        });
+        spdlog::info(
+            "rect {:>2}x{:<2}: cv::dilate {:.3f} ms, van Herk/Gil-Werman {:.3f} ms, speedup {:.2f}x, {} pixels differ",
+            k,
+            k,
+            t_cv,
+            t_fast,
+            t_cv / t_fast,
+            count_mismatch(expected, result)
+        );
+    }
+    return 0;
+}
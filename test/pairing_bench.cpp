@@ -0,0 +1,97 @@
+#include "bench_util.hpp"
+#include "detector.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+
+static AutoAim::LightBar make_lightbar(cv::Point center, int length, int angle) {
+    std::vector<cv::Point> contour;
+    cv::ellipse2Poly(center, cv::Size(std::max(length / 8, 2), length / 2), angle, 0, 360, 4, contour);
+    return AutoAim::LightBar(contour);
+}
+
+/**
+ * @brief 合成场景：一半灯条成对组成装甲板，其余为随机杂散灯条（反光、场地灯光）
+ */
+static std::vector<AutoAim::LightBar> make_scene(int n, cv::RNG &rng) {
+    std::vector<AutoAim::LightBar> lights;
+    while (int(lights.size()) < n) {
+        const int length = rng.uniform(20, 120), angle = rng.uniform(-10, 11);
+        cv::Point c(rng.uniform(100, 1340), rng.uniform(80, 1000));
+        if (lights.size() % 4 < 2) {
+            const int half = length * rng.uniform(10, 25) / 10;
+            lights.push_back(make_lightbar(c - cv::Point(half / 2, 0), length, angle));
+            lights.push_back(make_lightbar(c + cv::Point(half / 2, 0), length, angle + rng.uniform(-3, 4)));
+        } else
+            lights.push_back(make_lightbar(c, length, angle));
+    }
+    return lights;
+}
+
+/**
+ * @brief 原来的实现：两两枚举，每一对都对所有灯条做 pointPolygonTest，作为对照
+ */
+static std::vector<AutoAim::Armor>
+reference_pairing(std::vector<AutoAim::LightBar> lights, const AutoAim::ArmorConfig &config) {
+    std::sort(lights.begin(), lights.end(), [](const AutoAim::LightBar &a, const AutoAim::LightBar &b) {
+        const cv::Point &pa = a.contour.front(), &pb = b.contour.front();
+        return std::make_tuple(a.center().x, pa.y, pa.x) < std::make_tuple(b.center().x, pb.y, pb.x);
+    });
+
+    std::vector<AutoAim::Armor> armors;
+    for (auto light1 = lights.begin(); light1 != lights.end(); light1++) {
+        for (auto light2 = light1 + 1; light2 != lights.end(); light2++) {
+            AutoAim::Armor tmp(*light1, *light2);
+            bool mispair = false;
+            for (const auto &light : lights) {
+                if (light.center() == tmp.left.center() || light.center() == tmp.right.center())
+                    continue;
+                mispair |= cv::pointPolygonTest(tmp.vertices, light.center(), false) >= 0;
+            }
+            if (!mispair && tmp.is_valid(config))
+                armors.push_back(tmp);
+        }
+    }
+    return armors;
+}
+
+int main() {
+    // 配对过程中的调试日志会淹没耗时，只保留本程序的输出
+    spdlog::set_level(spdlog::level::off);
+    auto log = spdlog::stdout_color_mt("pairing_bench");
+    log->set_level(spdlog::level::info);
+
+    cv::RNG rng(20250310);
+    AutoAim::Detector detector;
+    const AutoAim::ArmorConfig config;
+
+    bool all_identical = true;
+    for (int n : {10, 25, 50, 100, 200}) {
+        const auto scene = make_scene(n, rng);
+        std::vector<AutoAim::Armor> expected, result;
+        const int frames = n <= 50 ? 200 : 10;
+
+        double t_ref  = per_frame_ms(frames, [&] { expected = reference_pairing(scene, config); });
+        double t_fast = per_frame_ms(frames, [&] {
+            auto lights = scene;
+            result      = detector.pair_lightbars(lights);
+        });
+
+        bool identical = expected.size() == result.size();
+        for (size_t i = 0; identical && i < expected.size(); ++i)
+            identical = expected[i].vertices == result[i].vertices && expected[i].type == result[i].type;
+        all_identical &= identical;
+
+        log->info(
+            "{:>3} lightbars: all pairs {:.3f} ms, sweep {:.3f} ms, speedup {:.1f}x, {} armors, {}",
+            n,
+            t_ref,
+            t_fast,
+            t_ref / t_fast,
+            expected.size(),
+            identical ? "identical" : "MISMATCH"
+        );
+    }
+    return all_identical ? 0 : 1;
+}
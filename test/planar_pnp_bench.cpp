@@ -0,0 +1,154 @@
+#include "config.hpp"
+#include "planar_pnp.hpp"
+
+#include <chrono>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/opencv.hpp>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.h>
+
+template <typename Fn>
+double per_armor_us(int armors, int rounds, Fn &&fn) {
+    fn(); // 预热
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < rounds; ++r)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / (rounds * armors);
+}
+
+static cv::Mat read_mat(const toml::table &config, const std::string &key, int rows) {
+    std::vector<double> data;
+    if (const auto *arr = config[key].as_array())
+        for (const auto &elem : *arr)
+            data.push_back(elem.value_or(0.0));
+    return cv::Mat(data, true).reshape(1, rows);
+}
+
+static std::vector<cv::Point3f> object_points(AutoAim::ArmorType type) {
+    std::vector<cv::Point3f> points;
+    for (const auto &[x, y] : AutoAim::armor_template(type).corners)
+        points.emplace_back(x, y, 0);
+    return points;
+}
+
+/**
+ * @brief 解出的装甲板法向是否更接近真实法向关于视线的镜像，即落在了另一个 IPPE 分支上
+ */
+static bool is_flipped(const cv::Vec3d &rvec, const cv::Vec3d &truth_rvec, const cv::Vec3d &truth_tvec) {
+    cv::Matx33d R, R_truth;
+    cv::Rodrigues(rvec, R);
+    cv::Rodrigues(truth_rvec, R_truth);
+    const cv::Vec3d normal(R(0, 2), R(1, 2), R(2, 2));
+    const cv::Vec3d truth(R_truth(0, 2), R_truth(1, 2), R_truth(2, 2));
+    const cv::Vec3d sight  = cv::normalize(truth_tvec);
+    const cv::Vec3d mirror = 2 * truth.dot(sight) * sight - truth;
+    return cv::norm(normal - mirror) < cv::norm(normal - truth);
+}
+
+int main() {
+    auto log = spdlog::stdout_color_mt("planar_pnp_bench");
+    cv::setNumThreads(1);
+
+    const auto config           = toml::parse_file(CONFIG_PATH + "transform.toml");
+    const cv::Mat camera_matrix = read_mat(config, "cameraMatrix", 3);
+    const cv::Mat dist_coeffs   = read_mat(config, "distCoeffs", 1);
+    const AutoAim::PlanarPnP pnp(camera_matrix, dist_coeffs);
+    const std::vector<cv::Point3f> points[2] = {
+        object_points(AutoAim::ArmorType::Small),
+        object_points(AutoAim::ArmorType::Large),
+    };
+
+    constexpr int kArmors = 2000;
+    cv::RNG rng(20250316);
+
+    for (double noise : {0.0, 0.5, 1.0}) {
+        //* 随机位姿投影得到角点，加上像素噪声
+        std::vector<AutoAim::Armor> armors(kArmors);
+        std::vector<cv::Vec3d> truth(kArmors), truth_rvec(kArmors);
+        for (int i = 0; i < kArmors; ++i) {
+            auto &armor = armors[i];
+            armor.type  = i % 2 ? AutoAim::ArmorType::Large : AutoAim::ArmorType::Small;
+
+            const double z = rng.uniform(1500.0, 8000.0);
+            truth[i]       = {rng.uniform(-0.35, 0.35) * z, rng.uniform(-0.25, 0.25) * z, z};
+            truth_rvec[i]  = {rng.uniform(-0.26, 0.26), rng.uniform(-1.05, 1.05), rng.uniform(-0.26, 0.26)};
+            cv::projectPoints(points[i % 2], truth_rvec[i], truth[i], camera_matrix, dist_coeffs, armor.vertices);
+            for (auto &p : armor.vertices)
+                p += cv::Point2f(rng.gaussian(noise), rng.gaussian(noise));
+        }
+
+        //* 平移误差（相对距离）与两种实现之间的差异
+        std::vector<AutoAim::PlanarPnPResult> results(kArmors);
+        pnp.solve(armors, results);
+        double opencv_error = 0, planar_error = 0, max_diff = 0;
+        for (int i = 0; i < kArmors; ++i) {
+            cv::Vec3d rvec, tvec;
+            const auto &vertices = armors[i].vertices;
+            cv::solvePnP(points[i % 2], vertices, camera_matrix, dist_coeffs, rvec, tvec, false, cv::SOLVEPNP_IPPE);
+            opencv_error += cv::norm(tvec - truth[i]) / truth[i][2];
+            planar_error += cv::norm(results[i].poses[0].tvec - truth[i]) / truth[i][2];
+            max_diff = std::max(max_diff, cv::norm(results[i].poses[0].tvec - tvec) / tvec[2]);
+        }
+
+        const double t_opencv = per_armor_us(kArmors, 5, [&] {
+            cv::Vec3d rvec, tvec;
+            for (const auto &armor : armors)
+                cv::solvePnP(
+                    points[armor.type == AutoAim::ArmorType::Large],
+                    armor.vertices,
+                    camera_matrix,
+                    dist_coeffs,
+                    rvec,
+                    tvec,
+                    false,
+                    cv::SOLVEPNP_IPPE
+                );
+        });
+        const double t_planar = per_armor_us(kArmors, 5, [&] { pnp.solve(armors, results); });
+
+        log->info(
+            "noise {:.1f}px: opencv {:.2f} us/armor, planar {:.2f} us/armor, speedup {:.1f}x, "
+            "mean translation error {:.3f}% / {:.3f}%, max difference {:.2e}",
+            noise,
+            t_opencv,
+            t_planar,
+            t_opencv / t_planar,
+            opencv_error / kArmors * 100,
+            planar_error / kArmors * 100,
+            max_diff
+        );
+
+        //* 以跟踪器的预测为初值：真值加上一帧内的预测误差（约 0.02 rad, 20 mm）
+        std::vector<AutoAim::PlanarPose> priors(kArmors), refined(kArmors);
+        for (int i = 0; i < kArmors; ++i) {
+            cv::Matx33d R, dR;
+            cv::Rodrigues(truth_rvec[i], R);
+            cv::Rodrigues(cv::Vec3d(rng.gaussian(0.02), rng.gaussian(0.02), rng.gaussian(0.02)), dR);
+            cv::Rodrigues(dR * R, priors[i].rvec);
+            priors[i].tvec = truth[i] + cv::Vec3d(rng.gaussian(20), rng.gaussian(20), rng.gaussian(20));
+        }
+        const double t_refine = per_armor_us(kArmors, 5, [&] {
+            for (int i = 0; i < kArmors; ++i) {
+                refined[i] = priors[i];
+                pnp.refine(armors[i], refined[i]);
+            }
+        });
+
+        int planar_flips = 0, refine_flips = 0;
+        for (int i = 0; i < kArmors; ++i) {
+            planar_flips += is_flipped(results[i].poses[0].rvec, truth_rvec[i], truth[i]);
+            refine_flips += is_flipped(refined[i].rvec, truth_rvec[i], truth[i]);
+        }
+        log->info(
+            "noise {:.1f}px: warm start {:.2f} us/armor, flipped armors {} (closed form) / {} (warm start) of {}",
+            noise,
+            t_refine,
+            planar_flips,
+            refine_flips,
+            kArmors
+        );
+    }
+    return 0;
+}
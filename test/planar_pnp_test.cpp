@@ -0,0 +1,137 @@
+#include "planar_pnp.hpp"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 随机的装甲板位姿：1.5 ~ 8 m，yaw ±60°，pitch、roll ±15°
+ */
+static void random_pose(cv::RNG &rng, cv::Vec3d &rvec, cv::Vec3d &tvec) {
+    cv::Matx33d R;
+    cv::Rodrigues(cv::Vec3d(0, rng.uniform(-1.05, 1.05), 0), R);
+    cv::Matx33d R_pitch, R_roll;
+    cv::Rodrigues(cv::Vec3d(rng.uniform(-0.26, 0.26), 0, 0), R_pitch);
+    cv::Rodrigues(cv::Vec3d(0, 0, rng.uniform(-0.26, 0.26)), R_roll);
+    cv::Rodrigues(R * R_pitch * R_roll, rvec);
+
+    const double z = rng.uniform(1500.0, 8000.0);
+    tvec           = {rng.uniform(-0.35, 0.35) * z, rng.uniform(-0.25, 0.25) * z, z};
+}
+
+static double rotation_error(const cv::Vec3d &rvec1, const cv::Vec3d &rvec2) {
+    cv::Matx33d R1, R2;
+    cv::Rodrigues(rvec1, R1);
+    cv::Rodrigues(rvec2, R2);
+    cv::Vec3d diff;
+    cv::Rodrigues(R1.t() * R2, diff);
+    return cv::norm(diff);
+}
+
+int main() {
+    const cv::Mat camera_matrix = (cv::Mat_<double>(3, 3) << 1800, 0, 720, 0, 1790, 540, 0, 0, 1);
+    const cv::Mat dist_coeffs   = (cv::Mat_<double>(1, 5) << -0.12, 0.08, 0.001, -0.0015, 0);
+    const AutoAim::PlanarPnP pnp(camera_matrix, dist_coeffs);
+
+    cv::RNG rng(20250316);
+    constexpr int kArmors = 1000;
+
+    size_t failures = 0;
+    std::vector<AutoAim::Armor> armors(kArmors);
+    std::vector<cv::Vec3d> rvecs(kArmors), tvecs(kArmors);
+    for (int i = 0; i < kArmors; ++i) {
+        auto &armor = armors[i];
+        armor.type  = i % 2 ? AutoAim::ArmorType::Large : AutoAim::ArmorType::Small;
+        random_pose(rng, rvecs[i], tvecs[i]);
+
+        const auto &model = AutoAim::armor_template(armor.type);
+        std::vector<cv::Point3f> object_points;
+        for (const auto &[x, y] : model.corners)
+            object_points.emplace_back(x, y, 0);
+        cv::projectPoints(object_points, rvecs[i], tvecs[i], camera_matrix, dist_coeffs, armor.vertices);
+
+        //* 没有噪声时，重投影误差较小的解就是真实位姿
+        AutoAim::PlanarPnPResult result;
+        if (!pnp.solve(armor, result)) {
+            spdlog::error("armor {}: no solution", i);
+            ++failures;
+            continue;
+        }
+        const auto &best = result.poses[0];
+        if (cv::norm(best.tvec - tvecs[i]) > 1e-4 * tvecs[i][2] || rotation_error(best.rvec, rvecs[i]) > 1e-3) {
+            spdlog::error("armor {}: solution differs from the ground truth", i);
+            ++failures;
+        }
+
+        //* 与 cv::solvePnP(SOLVEPNP_IPPE) 一致
+        cv::Vec3d rvec, tvec;
+        cv::solvePnP(object_points, armor.vertices, camera_matrix, dist_coeffs, rvec, tvec, false, cv::SOLVEPNP_IPPE);
+        if (cv::norm(best.tvec - tvec) > 1e-4 * tvec[2] || rotation_error(best.rvec, rvec) > 1e-3) {
+            spdlog::error("armor {}: solution differs from cv::solvePnP", i);
+            ++failures;
+        }
+    }
+
+    //* 批量解算与逐个解算结果相同
+    std::vector<AutoAim::PlanarPnPResult> results(kArmors);
+    pnp.solve(armors, results);
+    for (int i = 0; i < kArmors; ++i) {
+        AutoAim::PlanarPnPResult single;
+        pnp.solve(armors[i], single);
+        if (results[i].valid != single.valid || results[i].poses[0].rvec != single.poses[0].rvec
+            || results[i].poses[0].tvec != single.poses[0].tvec) {
+            spdlog::error("armor {}: batch result differs from single", i);
+            ++failures;
+        }
+    }
+
+    //* 以扰动后的真值为初值迭代求精，收敛回真值
+    for (int i = 0; i < kArmors; ++i) {
+        cv::Matx33d R, dR;
+        cv::Rodrigues(rvecs[i], R);
+        cv::Rodrigues(cv::Vec3d(rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0), rng.uniform(-1.0, 1.0)) * 0.01, dR);
+        AutoAim::PlanarPose prior;
+        cv::Rodrigues(dR * R, prior.rvec);
+        prior.tvec = tvecs[i] + cv::Vec3d(rng.uniform(-20.0, 20.0), rng.uniform(-20.0, 20.0), rng.uniform(-20.0, 20.0));
+
+        AutoAim::PlanarPose pose = prior;
+        if (!pnp.refine(armors[i], pose) || pose.error > 0.1) {
+            spdlog::error("armor {}: refine did not converge, error {}", i, pose.error);
+            ++failures;
+        }
+        pose = prior;
+        pnp.refine(armors[i], pose, 10);
+        if (cv::norm(pose.tvec - tvecs[i]) > 1e-4 * tvecs[i][2] || rotation_error(pose.rvec, rvecs[i]) > 1e-3) {
+            spdlog::error("armor {}: refined pose differs from the ground truth", i);
+            ++failures;
+        }
+    }
+
+    //* 初值在相机后方
+    AutoAim::PlanarPose behind{rvecs[0], -tvecs[0], 0};
+    if (pnp.refine(armors[0], behind)) {
+        spdlog::error("refine accepted an initial pose behind the camera");
+        ++failures;
+    }
+
+    //* 退化的角点
+    AutoAim::Armor degenerate;
+    degenerate.type     = AutoAim::ArmorType::Small;
+    degenerate.vertices = {{600, 500}, {600, 500}, {600, 500}, {600, 500}};
+    AutoAim::PlanarPnPResult result;
+    if (pnp.solve(degenerate, result)) {
+        spdlog::error("coincident corners were solved");
+        ++failures;
+    }
+    degenerate.vertices.pop_back();
+    if (pnp.solve(degenerate, result)) {
+        spdlog::error("three corners were solved");
+        ++failures;
+    }
+
+    if (failures)
+        spdlog::error("planar pnp test failed: {} failures", failures);
+    else
+        spdlog::info("planar pnp test passed");
+    return failures ? 1 : 0;
+}
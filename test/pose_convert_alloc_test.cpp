@@ -0,0 +1,232 @@
+#include "config.hpp"
+#include "pose_convert.hpp"
+#include "transform.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <opencv2/calib3d.hpp>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.h>
+
+// ========================================================
+// 统计堆内存分配次数
+// ========================================================
+
+// 替换 glibc 的分配函数：operator new 与 cv::fastMalloc 最终都会调用它们
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t n, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+void *__libc_memalign(size_t alignment, size_t size);
+}
+
+static std::atomic<size_t> allocations{0};
+static std::atomic<bool> counting{false};
+
+static void count_allocation() {
+    if (counting.load(std::memory_order_relaxed))
+        allocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+extern "C" {
+void *malloc(size_t size) {
+    count_allocation();
+    return __libc_malloc(size);
+}
+void *calloc(size_t n, size_t size) {
+    count_allocation();
+    return __libc_calloc(n, size);
+}
+void *realloc(void *ptr, size_t size) {
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+void *memalign(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+void *aligned_alloc(size_t alignment, size_t size) {
+    count_allocation();
+    return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **ptr, size_t alignment, size_t size) {
+    count_allocation();
+    *ptr = __libc_memalign(alignment, size);
+    return *ptr ? 0 : ENOMEM;
+}
+}
+
+/**
+ * @brief 统计 fn 执行期间的堆内存分配次数
+ */
+template <typename Fn>
+size_t count_allocations(Fn &&fn) {
+    allocations = 0;
+    counting    = true;
+    fn();
+    counting = false;
+    return allocations;
+}
+
+// ========================================================
+// 原 cv::Mat 实现，作为对照
+// ========================================================
+
+static cv::Mat read_mat(const toml::table &config, const std::string &key, int rows) {
+    std::vector<double> data;
+    if (const auto *arr = config[key].as_array())
+        for (const auto &elem : *arr)
+            data.push_back(elem.value_or(0.0));
+    return cv::Mat(data, true).reshape(1, rows);
+}
+
+static cv::Mat reference_armor_to_barrel(
+    const toml::table &config, const cv::Vec3d &rvec, const cv::Vec3d &tvec, const IMUInfo &imu
+) {
+    using namespace Transform::Functions;
+    cv::Mat T_camera_to_imu = read_mat(config, "cameraToIMU", 3);
+    cv::Mat R               = read_mat(config, "cameraToIMURotation", 3);
+    cv::Mat R_camera_to_imu = get_rotation_matrix(
+        R.at<double>(0) * kDegreeToRadian,
+        R.at<double>(1) * kDegreeToRadian,
+        R.at<double>(2) * kDegreeToRadian
+    );
+
+    return get_homography_matrix_from_rotation_translation(imu.rotation(), cv::Mat::zeros(3, 1, CV_64F))
+         * get_homography_matrix_from_rotation_translation(R_camera_to_imu.t(), T_camera_to_imu)
+         * get_homography_matrix_from_rotation_translation(cv::Mat(rvec), cv::Mat(tvec));
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::off);
+    const auto config = toml::parse_file(CONFIG_PATH + "transform.toml");
+    AutoAim::PoseConvert pose(CONFIG_PATH + "transform.toml");
+
+    const cv::Vec3d rvec{0.12, -0.35, 0.05};
+    const cv::Vec3d tvec{120, -80, 2500}; // mm
+    IMUInfo imu;
+    imu.roll  = 1.5;
+    imu.pitch = -4;
+    imu.yaw   = 30;
+
+    size_t failures = 0;
+
+    //* 与原 cv::Mat 实现的结果一致
+    Armor3d armor;
+    armor.p_a2c.rvec = rvec;
+    armor.p_a2c.tvec = tvec;
+    pose.solve_from_pnp(imu, armor);
+
+    cv::Mat expected = reference_armor_to_barrel(config, rvec, tvec / 1000, imu);
+    double max_diff  = 0;
+    for (int i = 0; i < 3; ++i) {
+        max_diff = std::max(max_diff, std::abs(armor.T_armor_to_barrel[i] - expected.at<double>(i, 3)));
+        for (int j = 0; j < 3; ++j)
+            max_diff = std::max(max_diff, std::abs(armor.R_armor_to_barrel(i, j) - expected.at<double>(i, j)));
+    }
+    if (max_diff > 1e-9) {
+        spdlog::error("armor -> barrel differs from the cv::Mat implementation by {}", max_diff);
+        ++failures;
+    }
+
+    //* PnP 之后的部分每个装甲板不分配堆内存
+    constexpr int kArmors = 1000;
+
+    size_t n = count_allocations([&] {
+        for (int i = 0; i < kArmors; ++i) {
+            armor.p_a2c.rvec = rvec;
+            armor.p_a2c.tvec = tvec;
+            pose.solve_from_pnp(imu, armor);
+        }
+    });
+    if (n != 0) {
+        spdlog::error("solve_from_pnp: {} heap allocations for {} armors", n, kArmors);
+        ++failures;
+    }
+
+    //* 完整的 solve_absolute：不分配堆内存，由投影得到的角点应解算回原位姿
+    AnnotatedArmorInfo info;
+    info.armor.type = AutoAim::ArmorType::Small;
+    info.imu_info   = imu;
+
+    std::vector<cv::Point3f> corners = {
+        {-SmallArmorWidth / 2, -SmallArmorHeight / 2, 0},
+        {SmallArmorWidth / 2, -SmallArmorHeight / 2, 0},
+        {SmallArmorWidth / 2, SmallArmorHeight / 2, 0},
+        {-SmallArmorWidth / 2, SmallArmorHeight / 2, 0},
+    };
+    cv::projectPoints(
+        corners,
+        rvec,
+        tvec,
+        read_mat(config, "cameraMatrix", 3),
+        read_mat(config, "distCoeffs", 1),
+        info.armor.vertices
+    );
+
+    Armor3d solved;
+    n = count_allocations([&] {
+        for (int i = 0; i < kArmors; ++i)
+            pose.solve_absolute(info, solved);
+    });
+    if (n != 0) {
+        spdlog::error("solve_absolute: {} heap allocations for {} armors", n, kArmors);
+        ++failures;
+    }
+    if (cv::norm(solved.p_a2c.tvec - tvec / 1000) > 1e-3
+        || cv::norm(solved.T_armor_to_barrel - armor.T_armor_to_barrel) > 1e-3) {
+        spdlog::error("solve_absolute does not recover the projected pose");
+        ++failures;
+    }
+
+    //* 以上一次的结果为初值：同样不分配堆内存，结果与闭式解一致
+    const Armor3d prior = solved;
+    Armor3d warm;
+    n = count_allocations([&] {
+        for (int i = 0; i < kArmors; ++i)
+            pose.solve_absolute(info, prior, warm);
+    });
+    if (n != 0) {
+        spdlog::error("solve_absolute with prior: {} heap allocations for {} armors", n, kArmors);
+        ++failures;
+    }
+    if (cv::norm(warm.p_a2c.tvec - solved.p_a2c.tvec) > 1e-4
+        || cv::norm(warm.T_armor_to_barrel - solved.T_armor_to_barrel) > 1e-4) {
+        spdlog::error("solve_absolute with prior differs from the closed form");
+        ++failures;
+    }
+
+    //* 一帧批量解算：有初值的装甲板经过迭代求精，结果都带有标签、时间戳与 IMU 姿态
+    info.result    = AutoAim::Labels::Infantry3;
+    info.timestamp = std::chrono::system_clock::now();
+    const std::vector<AnnotatedArmorInfo> frame = {info, info};
+    const std::vector<const Armor3d *> priors   = {&prior, nullptr};
+    std::vector<Armor3d> batch;
+
+    const WarmStartStats before = pose.warm_start_stats();
+    pose.solve_absolute(frame, priors, batch);
+    const WarmStartStats after = pose.warm_start_stats();
+    if (after.attempts - before.attempts != 1 || after.accepted - before.accepted != 1) {
+        spdlog::error(
+            "batch solve: {} warm starts attempted, {} accepted, expected 1 and 1",
+            after.attempts - before.attempts,
+            after.accepted - before.accepted
+        );
+        ++failures;
+    }
+    for (const Armor3d &armor : batch) {
+        if (armor.result != info.result || armor.timestamp != info.timestamp || armor.imu_info.yaw != imu.yaw) {
+            spdlog::error("batch solve does not carry the label, timestamp and IMU attitude of the armor");
+            ++failures;
+        }
+    }
+
+    spdlog::set_level(spdlog::level::info);
+    if (failures)
+        spdlog::error("pose convert alloc test failed: {} failures", failures);
+    else
+        spdlog::info("pose convert alloc test passed");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,52 @@
+#include "bench_util.hpp"
+#include "image_kernels.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 原来的 OpenCV 流程：cvtColor + threshold + split + subtract + threshold + bitwise_and
+ */
+static void opencv_chain(const cv::Mat &src, cv::Mat &binary, const AutoAim::Kernels::LightBarMaskParams &p) {
+    cv::Mat gray, grayColor, binary_color, binary_brightness;
+    cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+    cv::threshold(gray, binary_brightness, p.brightness_threshold, 255, cv::THRESH_BINARY);
+
+    std::vector<cv::Mat> channels;
+    cv::split(src, channels);
+    cv::subtract(channels[p.enemy_channel], channels[p.ally_channel], grayColor);
+
+    cv::threshold(grayColor, binary_color, p.color_threshold, 255, cv::THRESH_BINARY);
+    cv::bitwise_and(binary_brightness, binary_color, binary);
+}
+
+int main() {
+    constexpr int kFrames = 200;
+    cv::setNumThreads(1); // 只比较单线程的内核开销
+
+    AutoAim::Kernels::LightBarMaskParams params{0, 2, 20, 35};
+    for (cv::Size size : {cv::Size(1280, 720), cv::Size(1440, 1080), cv::Size(1920, 1080)}) {
+        cv::Mat img(size, CV_8UC3), mask;
+        cv::randu(img, 0, 256);
+
+        double t_chain  = per_frame_ms(kFrames, [&] { opencv_chain(img, mask, params); });
+        double t_scalar = per_frame_ms(kFrames, [&] {
+            AutoAim::Kernels::lightbar_mask_scalar(
+                img.ptr<uint8_t>(), img.step, mask.ptr<uint8_t>(), mask.step, img.rows, img.cols, params
+            );
+        });
+        double t_fused  = per_frame_ms(kFrames, [&] { AutoAim::Kernels::lightbar_mask(img, mask, params); });
+
+        spdlog::info(
+            "{}x{}: opencv chain {:.3f} ms, fused scalar {:.3f} ms, fused {} {:.3f} ms, speedup {:.2f}x",
+            size.width,
+            size.height,
+            t_chain,
+            t_scalar,
+            AutoAim::Kernels::has_avx2() ? "avx2" : "scalar",
+            t_fused,
+            t_chain / t_fused
+        );
+    }
+    return 0;
+}
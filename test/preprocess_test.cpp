@@ -0,0 +1,123 @@
+#include "image_kernels.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 原来 Detector::preprocess_image 中（膨胀之前）的 OpenCV 流程，作为对照
+ */
+static cv::Mat reference_mask(const cv::Mat &src, const AutoAim::Kernels::LightBarMaskParams &p) {
+    cv::Mat gray, grayColor, binary_color, binary, binary_brightness;
+    cv::cvtColor(src, gray, cv::COLOR_BGR2GRAY);
+    cv::threshold(gray, binary_brightness, p.brightness_threshold, 255, cv::THRESH_BINARY);
+
+    std::vector<cv::Mat> channels;
+    cv::split(src, channels);
+    cv::subtract(channels[p.enemy_channel], channels[p.ally_channel], grayColor);
+
+    cv::threshold(grayColor, binary_color, p.color_threshold, 255, cv::THRESH_BINARY);
+    cv::bitwise_and(binary_brightness, binary_color, binary);
+    return binary;
+}
+
+/**
+ * @brief 随机噪声 + 若干纯色/高亮“灯条”，保证两个条件的各种组合都出现
+ */
+static cv::Mat make_image(int rows, int cols, cv::RNG &rng) {
+    cv::Mat img(rows, cols, CV_8UC3);
+    rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+    for (int i = 0; i < 20; ++i) {
+        cv::Point a(rng.uniform(0, cols), rng.uniform(0, rows));
+        cv::Point b = a + cv::Point(rng.uniform(-5, 6), rng.uniform(-40, 41));
+        cv::Scalar color(rng.uniform(0, 256), rng.uniform(0, 256), rng.uniform(0, 256));
+        cv::line(img, a, b, color, rng.uniform(1, 6));
+    }
+    return img;
+}
+
+static size_t count_mismatch(const cv::Mat &a, const cv::Mat &b) {
+    cv::Mat diff;
+    cv::compare(a, b, diff, cv::CMP_NE);
+    return cv::countNonZero(diff);
+}
+
+int main() {
+    cv::RNG rng(20250307);
+    const cv::Size sizes[] = {{1440, 1080}, {1280, 720}, {33, 7}, {1, 1}, {97, 61}};
+    const int thresholds[] = {-10, -1, 0, 1, 20, 35, 60, 128, 254, 255, 300};
+
+    size_t cases = 0, failures = 0;
+    for (const auto &size : sizes) {
+        cv::Mat img = make_image(size.height, size.width, rng);
+        cv::Mat mask;
+        for (int enemy : {0, 2}) {
+            for (int bt : thresholds) {
+                for (int ct : thresholds) {
+                    AutoAim::Kernels::LightBarMaskParams p{enemy, 2 - enemy, bt, ct};
+                    cv::Mat expected = reference_mask(img, p);
+
+                    //* 默认实现（有 AVX2 时为向量化实现），mask 在各组参数间复用
+                    AutoAim::Kernels::lightbar_mask(img, mask, p);
+                    //* 标量实现
+                    cv::Mat scalar(img.size(), CV_8UC1);
+                    AutoAim::Kernels::lightbar_mask_scalar(
+                        img.ptr<uint8_t>(), img.step, scalar.ptr<uint8_t>(), scalar.step, img.rows, img.cols, p
+                    );
+
+                    size_t bad = count_mismatch(expected, mask) + count_mismatch(expected, scalar);
+                    if (bad) {
+                        spdlog::error(
+                            "{}x{} enemy={} bt={} ct={}: {} pixels differ",
+                            size.width,
+                            size.height,
+                            enemy,
+                            bt,
+                            ct,
+                            bad
+                        );
+                        ++failures;
+                    }
+                    ++cases;
+                }
+            }
+        }
+    }
+
+    //* 非连续内存（ROI）也能正确处理
+    cv::Mat big = make_image(300, 400, rng), roi_mask;
+    cv::Mat roi = big(cv::Rect(13, 7, 301, 211));
+    AutoAim::Kernels::LightBarMaskParams p{0, 2, 20, 35};
+    AutoAim::Kernels::lightbar_mask(roi, roi_mask, p);
+    failures += count_mismatch(reference_mask(roi, p), roi_mask) != 0;
+
+    ++cases;
+
+    //* 快速膨胀与 cv::dilate 逐位一致（包括原地调用）
+    cv::Mat scratch;
+    for (const auto &size : sizes) {
+        cv::Mat mask = make_image(size.height, size.width, rng), binary;
+        AutoAim::Kernels::lightbar_mask(mask, binary, {0, 2, 100, 20});
+        cv::Mat gray;
+        cv::cvtColor(mask, gray, cv::COLOR_BGR2GRAY);
+
+        for (int iterations : {0, 1, 2, 7, 20}) {
+            cv::Mat expected, result = binary.clone();
+            cv::dilate(binary, expected, cv::getStructuringElement(cv::MORPH_ELLIPSE, {3, 3}), {-1, -1}, iterations);
+            AutoAim::Kernels::dilate_diamond(result, result, iterations, scratch);
+            failures += count_mismatch(expected, result) != 0;
+            ++cases;
+        }
+        for (cv::Size ksize : {cv::Size(1, 1), cv::Size(3, 3), cv::Size(4, 4), cv::Size(15, 5), cv::Size(1, 31)}) {
+            for (const cv::Mat &src : {binary, gray}) {
+                cv::Mat expected, result;
+                cv::dilate(src, expected, cv::getStructuringElement(cv::MORPH_RECT, ksize));
+                AutoAim::Kernels::dilate_rect(src, result, ksize, scratch);
+                failures += count_mismatch(expected, result) != 0;
+                ++cases;
+            }
+        }
+    }
+
+    spdlog::info("avx2: {}, {} cases, {} failures", AutoAim::Kernels::has_avx2(), cases, failures);
+    return failures ? 1 : 0;
+}
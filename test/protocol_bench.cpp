@@ -0,0 +1,171 @@
+#include "frame_parser.hpp"
+#include "protocol.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <spdlog/sinks/stdout_color_sinks.h>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+/**
+ * @brief 损坏的字节流，以及每个完整帧的内容，用于判断解析出的帧是否被误接受
+ */
+struct FuzzCorpus {
+    std::vector<uint8_t> bytes;
+    std::vector<VisionPLCRecvMsg> intact;
+};
+
+/**
+ * @brief 每帧以 damage_percent% 的概率损坏，损坏方式随机：1~3 个比特错误、丢字节、插入字节、一段随机噪声
+ * @details 噪声与插入的字节中故意混入帧头、帧尾，模拟高波特率下的误锁定
+ */
+static FuzzCorpus make_corpus(std::mt19937 &rng, ProtocolVersion version, int frames, double damage_percent) {
+    FuzzCorpus corpus;
+    std::uniform_real_distribution<float> angle(-180, 180);
+    std::uniform_real_distribution<double> percent(0, 100);
+    std::uniform_int_distribution<int> byte(0, 255), kind(0, 3);
+
+    auto noise_byte = [&] {
+        const int b = byte(rng);
+        return uint8_t(b < 32 ? kProtocolRecvHead : b < 64 ? kProtocolTail : b);
+    };
+
+    for (int i = 0; i < frames; ++i) {
+        VisionPLCRecvMsg msg;
+        msg.imu_roll  = angle(rng);
+        msg.imu_pitch = angle(rng);
+        msg.imu_yaw   = angle(rng);
+        msg.aim_mode  = 0;
+
+        uint8_t frame[64];
+        const size_t size = encode_frame(msg, uint16_t(i), version, frame);
+        std::vector<uint8_t> bytes(frame, frame + size);
+
+        if (percent(rng) < damage_percent) {
+            switch (kind(rng)) {
+            case 0: // 比特错误，不改帧头帧尾
+                for (int k = byte(rng) % 3; k >= 0; --k)
+                    bytes[1 + byte(rng) % (size - 2)] ^= 1 << (byte(rng) % 8);
+                break;
+            case 1:
+                bytes.erase(bytes.begin() + byte(rng) % size);
+                break;
+            case 2: // 插在帧内
+                bytes.insert(bytes.begin() + 1 + byte(rng) % (size - 1), noise_byte());
+                break;
+            default:
+                for (int k = 8 + byte(rng) % 56; k > 0; --k) // 噪声在帧前
+                    corpus.bytes.push_back(noise_byte());
+                break;
+            }
+        }
+        // 比特错误相互抵消、插入的字节与相邻的字节相同（例如帧头后再插入一个帧头）时，帧仍然完整
+        if (std::search(bytes.begin(), bytes.end(), frame, frame + size) != bytes.end())
+            corpus.intact.push_back(msg);
+        corpus.bytes.insert(corpus.bytes.end(), bytes.begin(), bytes.end());
+    }
+    return corpus;
+}
+
+struct ParseResult {
+    int frames{0};          // 解析出的帧
+    int false_accepts{0};   // 解析出但不是完整帧的（数据已损坏）
+    int missed{0};          // 没有解析出的完整帧
+    uint64_t crc_errors{0};
+    double seconds{0};
+};
+
+static ParseResult parse(const FuzzCorpus &corpus, ProtocolVersion version) {
+    ParseResult result;
+    std::vector<StampedRecvMsg> parsed;
+    parsed.reserve(corpus.intact.size() * 2);
+
+    RecvFrameParser parser(RecvFrameParser::byte_time_of(460800), version);
+    const auto now   = RecvFrameParser::clock::now();
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t pos = 0; pos < corpus.bytes.size(); pos += 256) {
+        parser.push(corpus.bytes.data() + pos, std::min<size_t>(256, corpus.bytes.size() - pos), now);
+        StampedRecvMsg msg;
+        while (parser.pop(msg))
+            parsed.push_back(msg);
+    }
+    result.seconds    = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.frames     = parsed.size();
+    result.crc_errors = parser.crc_errors();
+
+    //* 按顺序与完整帧匹配：匹配不上的是误接受，跳过的是漏掉的
+    size_t next = 0;
+    for (const auto &msg : parsed) {
+        size_t k = next;
+        while (k < corpus.intact.size() && k < next + 64
+               && std::memcmp(&msg.msg, &corpus.intact[k], sizeof(VisionPLCRecvMsg)) != 0)
+            ++k;
+        if (k < corpus.intact.size() && k < next + 64) {
+            result.missed += k - next;
+            next = k + 1;
+        } else {
+            ++result.false_accepts;
+        }
+    }
+    result.missed += corpus.intact.size() - next;
+    return result;
+}
+
+/**
+ * @brief 每帧的 CRC 计算耗时，slice-by-8 与逐字节查表对比
+ */
+static void bench_crc(std::shared_ptr<spdlog::logger> log) {
+    std::vector<uint8_t> buffer(1 << 20);
+    std::mt19937 rng(1);
+    for (auto &b : buffer)
+        b = rng();
+
+    for (size_t size : {size_t(18), size_t(4096)}) {
+        for (int slice = 1; slice >= 0; --slice) {
+            uint16_t sink    = 0;
+            const auto start = std::chrono::steady_clock::now();
+            for (int round = 0; round < 20; ++round)
+                for (size_t pos = 0; pos + size <= buffer.size(); pos += size)
+                    sink += slice ? crc16(buffer.data() + pos, size) : crc16_bytewise(buffer.data() + pos, size);
+            const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            log->info(
+                "crc16 {:>9} over {:>4}-byte blocks: {:.0f} MB/s (checksum {:04x})",
+                slice ? "slice-by-8" : "bytewise",
+                size,
+                20.0 * buffer.size() / seconds / 1e6,
+                sink
+            );
+        }
+    }
+}
+
+int main() {
+    auto log = spdlog::stdout_color_mt("protocol_bench");
+    std::mt19937 rng(20250321);
+
+    bench_crc(log);
+
+    for (double damage : {0.1, 1.0, 5.0, 20.0}) {
+        for (auto version : {ProtocolVersion::V1, ProtocolVersion::V2}) {
+            const auto corpus = make_corpus(rng, version, 200000, damage);
+            parse(corpus, version); // 预热
+
+            const auto result = parse(corpus, version);
+            log->info(
+                "{:>4.1f}% frames damaged, v{}: {:.1f} MB/s, {} frames parsed, {} corrupted frames accepted, "
+                "{} of {} intact frames missed, {} crc errors",
+                damage,
+                int(version),
+                corpus.bytes.size() / result.seconds / 1e6,
+                result.frames,
+                result.false_accepts,
+                result.missed,
+                corpus.intact.size(),
+                result.crc_errors
+            );
+        }
+    }
+    return 0;
+}
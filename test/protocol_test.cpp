@@ -0,0 +1,263 @@
+#include "frame_parser.hpp"
+#include "protocol.hpp"
+
+#include <cstring>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <vector>
+
+/**
+ * @brief 逐位计算的 CRC-16/MCRF4XX，作为查表实现的参照
+ */
+static uint16_t crc16_bitwise(const uint8_t *data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit)
+            crc = crc & 1 ? (crc >> 1) ^ 0x8408 : crc >> 1;
+    }
+    return crc;
+}
+
+static size_t test_crc(std::mt19937 &rng) {
+    size_t failures = 0;
+
+    // CRC-16/MCRF4XX 的标准校验值
+    const char *check = "123456789";
+    const auto *bytes = reinterpret_cast<const uint8_t *>(check);
+    if (crc16(bytes, 9) != 0x6F91 || crc16_bytewise(bytes, 9) != 0x6F91) {
+        spdlog::error("crc16(\"123456789\") = {:#06x}, expected 0x6f91", crc16(bytes, 9));
+        ++failures;
+    }
+
+    //* 任意长度、任意对齐，slice-by-8 与逐字节、逐位计算一致；分段计算与整体一致
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::vector<uint8_t> buffer(200);
+    for (int round = 0; round < 2000; ++round) {
+        for (auto &b : buffer)
+            b = byte(rng);
+        const size_t offset = round % 8, size = round % 150;
+        const uint8_t *data = buffer.data() + offset;
+
+        const uint16_t expected = crc16_bitwise(data, size);
+        const size_t split      = size / 3;
+        if (crc16(data, size) != expected || crc16_bytewise(data, size) != expected
+            || crc16(data + split, size - split, crc16(data, split)) != expected) {
+            spdlog::error("crc16 mismatch: size {}, offset {}", size, offset);
+            ++failures;
+            break;
+        }
+    }
+    return failures;
+}
+
+/**
+ * @brief 编码解码往返一致；v2、v3 帧中任意一位出错都能被 CRC 检出；改写时间戳后 CRC 仍然正确
+ */
+template <typename Msg>
+static size_t test_codec(const Msg &msg, const char *name) {
+    size_t failures = 0;
+    uint8_t frame[64];
+
+    timestamps_of<Msg> stamps;
+    for (size_t i = 0; i < sizeof(stamps); ++i)
+        reinterpret_cast<uint8_t *>(&stamps)[i] = 0x10 + i;
+
+    for (auto version : {ProtocolVersion::V1, ProtocolVersion::V2, ProtocolVersion::V3}) {
+        const size_t size = encode_frame(msg, 0xBEEF, version, frame, stamps);
+        if (size != frame_size_of<Msg>(version) || frame[0] != reinterpret_cast<const uint8_t *>(&msg)[0]
+            || frame[size - 1] != kProtocolTail) {
+            spdlog::error("{} v{}: bad frame layout", name, int(version));
+            ++failures;
+        }
+
+        Msg decoded;
+        uint16_t seq;
+        timestamps_of<Msg> decoded_stamps;
+        const timestamps_of<Msg> expected_stamps = version == ProtocolVersion::V3 ? stamps : timestamps_of<Msg>{};
+        if (!decode_frame(frame, version, decoded, seq, decoded_stamps) || std::memcmp(&decoded, &msg, sizeof(Msg)) != 0
+            || seq != (version == ProtocolVersion::V1 ? 0 : 0xBEEF)
+            || std::memcmp(&decoded_stamps, &expected_stamps, sizeof(stamps)) != 0) {
+            spdlog::error("{} v{}: decoded message differs", name, int(version));
+            ++failures;
+        }
+    }
+
+    // 帧尾由解析器检查，其余字节（包括时间戳、序号与 CRC 本身）的单比特错误都应被检出
+    for (auto version : {ProtocolVersion::V2, ProtocolVersion::V3}) {
+        const size_t size = encode_frame(msg, 0x1234, version, frame, stamps);
+        for (size_t bit = 0; bit < (size - 1) * 8; ++bit) {
+            frame[bit / 8] ^= 1 << (bit % 8);
+            Msg decoded;
+            uint16_t seq;
+            if (decode_frame(frame, version, decoded, seq)) {
+                spdlog::error("{} v{}: flipping bit {} was not detected", name, int(version), bit);
+                ++failures;
+                break;
+            }
+            frame[bit / 8] ^= 1 << (bit % 8);
+        }
+    }
+
+    //* 改写时间戳：与直接用新时间戳编码的帧逐字节相同
+    timestamps_of<Msg> restamped{};
+    uint8_t expected[64];
+    const size_t size = encode_frame(msg, 0x1234, ProtocolVersion::V3, expected, restamped);
+    encode_frame(msg, 0x1234, ProtocolVersion::V3, frame, stamps);
+    restamp_frame<Msg>(frame, restamped);
+    if (std::memcmp(frame, expected, size) != 0) {
+        spdlog::error("{} v3: restamped frame differs", name);
+        ++failures;
+    }
+    return failures;
+}
+
+/**
+ * @brief v2 解析器：损坏的帧（比特错误、丢字节、垃圾字节）全部被拒绝，完整的帧全部解析出来，丢帧数由序号推算
+ */
+static size_t test_parser(std::mt19937 &rng) {
+    std::uniform_real_distribution<float> angle(-180, 180);
+    std::uniform_int_distribution<int> byte(0, 255), percent(0, 99);
+
+    std::vector<uint8_t> stream;
+    std::vector<VisionPLCRecvMsg> intact;
+    std::vector<uint16_t> intact_seq;
+    size_t damaged = 0;
+
+    constexpr int kFrames = 20000;
+    for (int i = 0; i < kFrames; ++i) {
+        VisionPLCRecvMsg msg;
+        msg.imu_roll  = angle(rng);
+        msg.imu_pitch = angle(rng);
+        msg.imu_yaw   = angle(rng);
+        msg.my_color  = kProtocolRecvHead;
+        msg.aim_mode  = 0;
+
+        if (percent(rng) < 5)
+            for (int k = byte(rng) % 8; k >= 0; --k)
+                stream.push_back(k % 2 ? kProtocolRecvHead : byte(rng));
+
+        uint8_t frame[64];
+        const size_t size = encode_frame(msg, uint16_t(i), ProtocolVersion::V2, frame);
+        std::vector<uint8_t> bytes(frame, frame + size);
+
+        const int damage = percent(rng);
+        if (damage < 3) {
+            bytes[byte(rng) % (size - 1)] ^= 1 << (byte(rng) % 8); // 比特错误，帧头帧尾可能仍然正确
+            ++damaged;
+        } else if (damage < 5) {
+            bytes.erase(bytes.begin() + byte(rng) % size); // 丢一个字节
+            ++damaged;
+        } else {
+            intact.push_back(msg);
+            intact_seq.push_back(uint16_t(i));
+        }
+        stream.insert(stream.end(), bytes.begin(), bytes.end());
+    }
+
+    RecvFrameParser parser(RecvFrameParser::byte_time_of(460800), ProtocolVersion::V2);
+    std::vector<StampedRecvMsg> parsed;
+    std::uniform_int_distribution<size_t> chunk(1, 256);
+    for (size_t pos = 0; pos < stream.size();) {
+        const size_t n = std::min(chunk(rng), stream.size() - pos);
+        parser.push(stream.data() + pos, n, RecvFrameParser::clock::now());
+        pos += n;
+
+        StampedRecvMsg msg;
+        while (parser.pop(msg))
+            parsed.push_back(msg);
+    }
+
+    size_t failures = 0;
+    if (parsed.size() != intact.size()) {
+        spdlog::error("v2 parser: {} frames parsed, {} intact frames", parsed.size(), intact.size());
+        return 1;
+    }
+    for (size_t i = 0; i < parsed.size(); ++i)
+        if (std::memcmp(&parsed[i].msg, &intact[i], sizeof(VisionPLCRecvMsg)) != 0
+            || parsed[i].seq != intact_seq[i]) {
+            spdlog::error("v2 parser: frame {} differs", i);
+            ++failures;
+            break;
+        }
+    // 首尾的损坏帧前后没有完整的帧，序号推算不出来
+    size_t lost = 0;
+    for (size_t i = 1; i < intact_seq.size(); ++i)
+        lost += intact_seq[i] - intact_seq[i - 1] - 1;
+    if (parser.lost_frames() != lost) {
+        spdlog::error("v2 parser: {} frames lost by sequence number, expected {}", parser.lost_frames(), lost);
+        ++failures;
+    }
+    if (parser.crc_errors() == 0) {
+        spdlog::error("v2 parser: bit errors with a valid head and tail were not counted as crc errors");
+        ++failures;
+    }
+    spdlog::info(
+        "v2 parser: {} frames, {} damaged, {} crc errors, {} bytes skipped",
+        parser.frames(),
+        damaged,
+        parser.crc_errors(),
+        parser.skipped_bytes()
+    );
+    return failures;
+}
+
+/**
+ * @brief reset() 之后（串口重连）序号重新开始，不计为丢帧
+ */
+static size_t test_reset() {
+    RecvFrameParser parser(RecvFrameParser::byte_time_of(460800), ProtocolVersion::V2);
+    VisionPLCRecvMsg msg;
+    StampedRecvMsg parsed;
+    uint8_t frame[64];
+
+    auto feed = [&](uint16_t seq) {
+        const size_t size = encode_frame(msg, seq, ProtocolVersion::V2, frame);
+        parser.push(frame, size, RecvFrameParser::clock::now());
+        return parser.pop(parsed);
+    };
+
+    size_t failures = 0;
+    if (!feed(100) || !feed(101)) {
+        spdlog::error("reset: consecutive frames were not parsed");
+        ++failures;
+    }
+    parser.reset();
+    if (!feed(500) || parser.lost_frames() != 0) {
+        spdlog::error("reset: first frame after reset counted {} lost frames", parser.lost_frames());
+        ++failures;
+    }
+    if (!feed(502) || parser.lost_frames() != 1) {
+        spdlog::error("reset: a gap after reset counted {} lost frames, expected 1", parser.lost_frames());
+        ++failures;
+    }
+    return failures;
+}
+
+int main() {
+    std::mt19937 rng(20250320);
+    size_t failures = 0;
+
+    failures += test_crc(rng);
+
+    VisionPLCSendMsg send;
+    send.pitch      = 1.5f;
+    send.yaw        = -20.25f;
+    send.flag_found = 1;
+    failures += test_codec(send, "VisionPLCSendMsg");
+
+    VisionPLCRecvMsg recv;
+    recv.imu_yaw  = 123.5f;
+    recv.my_color = 2;
+    recv.aim_mode = 0;
+    failures += test_codec(recv, "VisionPLCRecvMsg");
+
+    failures += test_parser(rng);
+    failures += test_reset();
+
+    if (failures)
+        spdlog::error("protocol test failed: {} failures", failures);
+    else
+        spdlog::info("protocol test passed");
+    return failures ? 1 : 0;
+}
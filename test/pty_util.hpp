@@ -0,0 +1,60 @@
+#ifndef __PTY_UTIL_HPP__
+#define __PTY_UTIL_HPP__
+
+#include <chrono>
+#include <cstdlib>
+#include <fcntl.h>
+#include <filesystem>
+#include <string>
+#include <termios.h>
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief 打开一对伪终端，返回主端，从端的路径写入 slave_name。从端当作串口，主端模拟下位机
+ * @param nonblocking 主端是否非阻塞。需要在主端阻塞写入时传 false
+ * @return 失败时为 -1
+ */
+inline int open_pty(std::string &slave_name, bool nonblocking = true) {
+    int master = posix_openpt(O_RDWR | O_NOCTTY | (nonblocking ? O_NONBLOCK : 0));
+    if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        return -1;
+    slave_name = ptsname(master);
+
+    termios tio;
+    tcgetattr(master, &tio);
+    cfmakeraw(&tio);
+    tcsetattr(master, TCSANOW, &tio);
+    return master;
+}
+
+/**
+ * @brief 模拟 udev 的固定设备名：每次打开新的伪终端，都把 link 指向它的从端
+ * @return 主端（非阻塞），失败时为 -1
+ */
+inline int open_pty(const std::filesystem::path &link) {
+    std::string slave;
+    const int master = open_pty(slave);
+    if (master < 0)
+        return -1;
+
+    std::filesystem::remove(link);
+    std::filesystem::create_symlink(slave, link);
+    return master;
+}
+
+/**
+ * @brief 等待 pred 成立，最多 timeout
+ */
+template <typename Pred>
+bool wait_until(Pred &&pred, std::chrono::milliseconds timeout) {
+    const auto deadline = std::chrono::steady_clock::now() + timeout;
+    while (!pred()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+#endif // __PTY_UTIL_HPP__
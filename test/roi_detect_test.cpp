@@ -0,0 +1,77 @@
+#include "config.hpp"
+#include "detector.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 暗背景上画若干对（敌方颜色的）竖直灯条，每对模拟一块装甲板
+ */
+static cv::Mat make_frame(const std::vector<cv::Point> &armor_centers, cv::RNG &rng) {
+    cv::Mat img(1080, 1440, CV_8UC3);
+    rng.fill(img, cv::RNG::UNIFORM, 0, 40);
+    const cv::Scalar enemy = EnemyColor == RMColor::Blue ? cv::Scalar(255, 160, 60) : cv::Scalar(60, 160, 255);
+    for (const auto &c : armor_centers) {
+        cv::rectangle(img, cv::Rect(c.x - 70, c.y - 25, 10, 50), enemy, cv::FILLED);
+        cv::rectangle(img, cv::Rect(c.x + 60, c.y - 25, 10, 50), enemy, cv::FILLED);
+    }
+    return img;
+}
+
+static bool same_armors(const std::vector<AutoAim::Armor> &a, const std::vector<AutoAim::Armor> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (cv::norm(a[i].center - b[i].center) > 1e-3 || a[i].type != b[i].type)
+            return false;
+    return true;
+}
+
+int main() {
+    cv::RNG rng(20250308);
+    AutoAim::Detector detector;
+    size_t failures = 0;
+
+    cv::Mat img = make_frame({{400, 300}, {1000, 700}}, rng);
+    auto full   = detector.detect(img);
+    spdlog::info("full frame: {} armors", full.size());
+
+    //* ROI 内的检测结果与全图一致
+    std::vector<cv::Rect> rois;
+    for (const auto &armor : full)
+        rois.push_back(cv::boundingRect(armor.vertices));
+    auto before = detector.stats();
+    auto in_roi = detector.detect(img, rois);
+    auto after  = detector.stats();
+    failures += !same_armors(full, in_roi);
+    if (!full.empty()) {
+        failures += after.roi_hits != before.roi_hits + 1;
+        failures += !after.last_frame_roi || after.last_scanned_ratio >= 1.0;
+    }
+
+    //* ROI 内没有装甲板时回退全图扫描，结果仍与全图一致
+    before      = detector.stats();
+    auto missed = detector.detect(img, {cv::Rect(10, 1000, 20, 20)});
+    after       = detector.stats();
+    failures += !same_armors(full, missed);
+    failures += after.miss_fallbacks != before.miss_fallbacks + 1;
+    failures += after.full_scans != before.full_scans + 1;
+
+    //* 没有预测框时直接全图扫描
+    before = detector.stats();
+    detector.detect(img, {});
+    after = detector.stats();
+    failures += after.full_scans != before.full_scans + 1 || after.roi_frames != before.roi_frames;
+
+    const auto &stats = detector.stats();
+    spdlog::info(
+        "frames {}, roi frames {}, roi hits {}, full scans {}, miss fallbacks {}, {} failures",
+        stats.frames,
+        stats.roi_frames,
+        stats.roi_hits,
+        stats.full_scans,
+        stats.miss_fallbacks,
+        failures
+    );
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,62 @@
+#include "bench_util.hpp"
+#include "image_kernels.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 图像中随机位置、随机大小的数字区域 -> 64x64 的透视变换
+ */
+static cv::Matx33d random_transform(cv::Size img, float height, cv::RNG &rng) {
+    const float cx = rng.uniform(height, img.width - height), cy = rng.uniform(height, img.height - height);
+    const float h = height / 2, w = h * 0.6f;
+    cv::Point2f src[4] = {{cx - w, cy - h}, {cx + w, cy - h}, {cx + w, cy + h}, {cx - w, cy + h}};
+    for (auto &p : src)
+        p += cv::Point2f(rng.gaussian(h * 0.05), rng.gaussian(h * 0.05));
+    const cv::Point2f dst[4] = {{0, 0}, {64, 0}, {64, 64}, {0, 64}};
+    return cv::getPerspectiveTransform(src, dst);
+}
+
+int main() {
+    constexpr int kRois = 2000;
+    cv::setNumThreads(1); // 只比较单线程的开销
+    cv::RNG rng(20250312);
+
+    cv::Mat img(1080, 1440, CV_8UC3);
+    rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+    cv::GaussianBlur(img, img, {5, 5}, 0);
+
+    const cv::Size patch_size(64, 64);
+    for (float height : {30.0f, 100.0f, 300.0f}) {
+        std::vector<cv::Matx33d> transforms;
+        for (int i = 0; i < kRois; ++i)
+            transforms.push_back(random_transform(img.size(), height, rng));
+
+        cv::Mat warped, gray, patch(patch_size, CV_8UC1);
+        double t_opencv = per_roi_us(kRois, [&](int i) {
+            cv::warpPerspective(img, warped, transforms[i], patch_size);
+            cv::cvtColor(warped, gray, cv::COLOR_BGR2GRAY);
+        });
+        double t_scalar = per_roi_us(kRois, [&](int i) {
+            const cv::Matx33d inv = transforms[i].inv();
+            AutoAim::Kernels::warp_gray_patch_scalar(
+                img.ptr<uint8_t>(), img.step, img.rows, img.cols, inv.val, patch.ptr<uint8_t>(), patch.step, 64, 64
+            );
+        });
+        double t_fused = per_roi_us(kRois, [&](int i) {
+            AutoAim::Kernels::warp_gray_patch(img, transforms[i], patch, patch_size);
+        });
+
+        spdlog::info(
+            "number region {:>3.0f} px: warpPerspective + cvtColor {:.2f} us, scalar {:.2f} us, sampler {:.2f} us "
+            "(avx2: {}), speedup {:.2f}x",
+            height,
+            t_opencv,
+            t_scalar,
+            t_fused,
+            AutoAim::Kernels::has_avx2(),
+            t_opencv / t_fused
+        );
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include "image_kernels.hpp"
+
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+
+/**
+ * @brief 原来 Classifier 的流程：warpPerspective 得到彩色数字区域，再转为灰度图，作为对照
+ */
+static cv::Mat reference_patch(const cv::Mat &img, const cv::Matx33d &M, cv::Size size) {
+    cv::Mat warped, gray;
+    cv::warpPerspective(img, warped, M, size);
+    cv::cvtColor(warped, gray, cv::COLOR_BGR2GRAY);
+    return gray;
+}
+
+/**
+ * @brief 随机四边形 -> 64x64 的透视变换，中心可能落在图像外，用于覆盖边界处理
+ */
+static cv::Matx33d random_transform(cv::Size img, cv::RNG &rng) {
+    const float cx = rng.uniform(-0.2f, 1.2f) * img.width, cy = rng.uniform(-0.2f, 1.2f) * img.height;
+    const float h = rng.uniform(5.0f, 200.0f), w = h * rng.uniform(0.3f, 1.0f);
+    cv::Point2f src[4] = {{cx - w, cy - h}, {cx + w, cy - h}, {cx + w, cy + h}, {cx - w, cy + h}};
+    for (auto &p : src)
+        p += cv::Point2f(rng.gaussian(h * 0.1), rng.gaussian(h * 0.1));
+    const cv::Point2f dst[4] = {{0, 0}, {64, 0}, {64, 64}, {0, 64}};
+    return cv::getPerspectiveTransform(src, dst);
+}
+
+static double max_diff(const cv::Mat &a, const cv::Mat &b) {
+    cv::Mat diff;
+    cv::absdiff(a, b, diff);
+    double max;
+    cv::minMaxLoc(diff, nullptr, &max);
+    return max;
+}
+
+int main() {
+    cv::RNG rng(20250312);
+    const cv::Size sizes[] = {{1440, 1080}, {1280, 720}, {40, 50}, {4, 3}, {1, 1}};
+    const cv::Size patch_size(64, 64);
+
+    size_t cases = 0, failures = 0;
+    cv::Mat patch; // 在各次调用间复用
+    for (const auto &size : sizes) {
+        cv::Mat img(size, CV_8UC3);
+        rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+        for (int i = 0; i < 100; ++i) {
+            if (i == 50) // 平滑的图像更接近实际的数字区域
+                cv::GaussianBlur(img, img, {5, 5}, 0);
+
+            const cv::Matx33d M    = random_transform(size, rng);
+            const cv::Mat expected = reference_patch(img, M, patch_size);
+
+            //* 默认实现（有 AVX2 时为向量化实现）
+            AutoAim::Kernels::warp_gray_patch(img, M, patch, patch_size);
+            //* 标量实现
+            cv::Mat scalar(patch_size, CV_8UC1);
+            const cv::Matx33d inv = M.inv();
+            AutoAim::Kernels::warp_gray_patch_scalar(
+                img.ptr<uint8_t>(),
+                img.step,
+                img.rows,
+                img.cols,
+                inv.val,
+                scalar.ptr<uint8_t>(),
+                scalar.step,
+                patch_size.width,
+                patch_size.height
+            );
+
+            const double diff = std::max(max_diff(expected, patch), max_diff(expected, scalar));
+            if (diff > 1) {
+                spdlog::error("{}x{} case {}: max difference {}", size.width, size.height, i, diff);
+                ++failures;
+            }
+            ++cases;
+        }
+    }
+
+    //* 非连续内存（ROI）也能正确处理
+    cv::Mat big(300, 400, CV_8UC3);
+    rng.fill(big, cv::RNG::UNIFORM, 0, 256);
+    cv::Mat roi = big(cv::Rect(13, 7, 301, 211));
+    for (int i = 0; i < 20; ++i) {
+        const cv::Matx33d M = random_transform(roi.size(), rng);
+        AutoAim::Kernels::warp_gray_patch(roi, M, patch, patch_size);
+        failures += max_diff(reference_patch(roi, M, patch_size), patch) > 1;
+        ++cases;
+    }
+
+    spdlog::info("avx2: {}, {} cases, {} failures", AutoAim::Kernels::has_avx2(), cases, failures);
+    return failures ? 1 : 0;
+}
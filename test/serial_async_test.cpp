@@ -0,0 +1,142 @@
+#include "pty_util.hpp"
+#include "serial_port.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+/**
+ * @brief 从主端读出所有已发送的帧（非阻塞），返回最后一帧
+ */
+static std::optional<VisionPLCSendMsg> drain(int master, size_t &frames) {
+    std::optional<VisionPLCSendMsg> last;
+    std::vector<uint8_t> bytes;
+    uint8_t chunk[4096];
+    for (ssize_t n; (n = read(master, chunk, sizeof(chunk))) > 0;)
+        bytes.insert(bytes.end(), chunk, chunk + n);
+
+    for (size_t i = 0; i + sizeof(VisionPLCSendMsg) <= bytes.size(); i += sizeof(VisionPLCSendMsg)) {
+        VisionPLCSendMsg msg;
+        std::memcpy(&msg, bytes.data() + i, sizeof(msg));
+        if (msg.frame_head == kProtocolSendHead && msg.frame_tail == kProtocolTail) {
+            last = msg;
+            ++frames;
+        }
+    }
+    return last;
+}
+
+int main() {
+    std::string slave;
+    const int master = open_pty(slave, false); // 下位机线程阻塞写入
+    if (master < 0) {
+        spdlog::error("failed to open a pty pair");
+        return 1;
+    }
+
+    const auto config = std::filesystem::temp_directory_path() / "serial_async_test.toml";
+    std::ofstream(config) << "alternative_ports = [\"" << slave << "\"]\n";
+
+    auto port = std::make_shared<SerialPort>(config.string());
+    port->initialize_port();
+    port->start_async_io();
+
+    size_t failures = 0;
+
+    //* 接收：下位机按任意大小分块发送，帧之间夹杂垃圾字节
+    constexpr int kFrames = 2000;
+    std::mt19937 rng(20250319);
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < kFrames; ++i) {
+        VisionPLCRecvMsg msg;
+        msg.imu_yaw = float(i) / 10;
+        if (i % 50 == 0)
+            stream.insert(stream.end(), {0x00, kProtocolRecvHead, 0x12});
+        const auto *bytes = reinterpret_cast<const uint8_t *>(&msg);
+        stream.insert(stream.end(), bytes, bytes + sizeof(msg));
+    }
+    std::thread mcu([&] {
+        std::uniform_int_distribution<size_t> chunk(1, 64);
+        for (size_t pos = 0; pos < stream.size();) {
+            const size_t n = std::min(chunk(rng), stream.size() - pos);
+            pos += write(master, stream.data() + pos, n);
+            if (pos % 7 == 0)
+                std::this_thread::sleep_for(100us);
+        }
+    });
+    mcu.join();
+
+    if (!wait_until([&] { return port->imu_history().written() == kFrames; }, 5000ms)) {
+        spdlog::error("received {} of {} frames", port->imu_history().written(), kFrames);
+        ++failures;
+    }
+    auto latest = port->imu_history().latest();
+    if (!latest || std::abs(latest->yaw - float(kFrames - 1) / 10) > 1e-4) {
+        spdlog::error("the latest imu sample does not match the last frame");
+        ++failures;
+    }
+
+    //* 发送：下位机不读取，伪终端缓冲区写满后 send_data() 仍立即返回
+    fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+    constexpr int kSends = 20000; // 约 300 KB，远超伪终端的缓冲区
+    auto max_call        = std::chrono::nanoseconds(0);
+    VisionPLCSendMsg cmd;
+    for (int i = 0; i < kSends; ++i) {
+        cmd.pitch     = float(i);
+        const auto t0 = std::chrono::steady_clock::now();
+        port->send_data(cmd);
+        max_call = std::max(max_call, std::chrono::steady_clock::now() - t0);
+    }
+    if (max_call > 50ms) {
+        spdlog::error(
+            "send_data() blocked for {} us", std::chrono::duration_cast<std::chrono::microseconds>(max_call).count()
+        );
+        ++failures;
+    }
+    if (port->send_dropped() == 0) {
+        spdlog::error("the send queue never filled although the pty was not read");
+        ++failures;
+    }
+
+    //* 下位机开始读取后，队列中的消息依次发出，最后一条一定是最新的指令
+    size_t frames = 0;
+    std::optional<VisionPLCSendMsg> last;
+    wait_until(
+        [&] {
+            if (auto msg = drain(master, frames))
+                last = msg;
+            return last && last->pitch == float(kSends - 1);
+        },
+        5000ms
+    );
+    if (!last || last->pitch != float(kSends - 1)) {
+        spdlog::error("the newest command was not delivered");
+        ++failures;
+    }
+    spdlog::info(
+        "send_data() took at most {} us, {} frames delivered, {} queued commands replaced",
+        std::chrono::duration_cast<std::chrono::microseconds>(max_call).count(),
+        frames,
+        port->send_dropped()
+    );
+
+    port->stop_async_io();
+    close(master);
+    std::filesystem::remove(config);
+
+    if (failures)
+        spdlog::error("serial async test failed: {} failures", failures);
+    else
+        spdlog::info("serial async test passed");
+    return failures ? 1 : 0;
+}
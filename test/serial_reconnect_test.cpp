@@ -0,0 +1,142 @@
+#include "pty_util.hpp"
+#include "serial_port.hpp"
+
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <filesystem>
+#include <fstream>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <unistd.h>
+
+using namespace std::chrono_literals;
+namespace fs = std::filesystem;
+
+static void write_frames(int master, int from, int count) {
+    for (int i = from; i < from + count; ++i) {
+        VisionPLCRecvMsg msg;
+        msg.imu_yaw = float(i);
+        write(master, &msg, sizeof(msg));
+        std::this_thread::sleep_for(1ms);
+    }
+}
+
+/**
+ * @brief 读取主端收到的一个完整的发送帧
+ */
+static bool receive_command(int master, float pitch) {
+    std::vector<uint8_t> bytes;
+    return wait_until(
+        [&] {
+            uint8_t chunk[256];
+            for (ssize_t n; (n = read(master, chunk, sizeof(chunk))) > 0;)
+                bytes.insert(bytes.end(), chunk, chunk + n);
+            for (size_t pos = 0; pos + sizeof(VisionPLCSendMsg) <= bytes.size(); pos += sizeof(VisionPLCSendMsg)) {
+                VisionPLCSendMsg msg;
+                std::memcpy(&msg, bytes.data() + pos, sizeof(msg));
+                if (msg.frame_head == kProtocolSendHead && msg.pitch == pitch)
+                    return true;
+            }
+            return false;
+        },
+        1000ms
+    );
+}
+
+int main() {
+    const auto dir  = fs::temp_directory_path();
+    const auto link = dir / "serial_reconnect_test.tty";
+    int master      = open_pty(link);
+    if (master < 0) {
+        spdlog::error("failed to open a pty pair");
+        return 1;
+    }
+
+    // 第二个备选端口不存在，重连时轮流尝试
+    const auto config = dir / "serial_reconnect_test.toml";
+    std::ofstream(config) << "alternative_ports = [\"" << link.string() << "\", \"" << (dir / "no_such_tty").string()
+                          << "\"]\n";
+
+    auto port = std::make_shared<SerialPort>(config.string());
+    port->initialize_port();
+    port->start_async_io();
+
+    size_t failures = 0;
+    write_frames(master, 0, 20);
+    if (!wait_until([&] { return port->imu_history().written() == 20; }, 1000ms)) {
+        spdlog::error("frames before disconnect were not received");
+        ++failures;
+    }
+
+    //* 下位机断开：读取出错，记录一次断开，重连失败期间 send_data() 不阻塞
+    close(master);
+    if (!wait_until([&] { return port->port_down_count() == 1; }, 1000ms)) {
+        spdlog::error("closing the pty was not detected");
+        ++failures;
+    }
+    auto max_call = std::chrono::nanoseconds(0);
+    for (int i = 0; i < 1000; ++i) {
+        VisionPLCSendMsg cmd;
+        cmd.pitch     = float(i);
+        const auto t0 = std::chrono::steady_clock::now();
+        port->send_data(cmd);
+        max_call = std::max(max_call, std::chrono::steady_clock::now() - t0);
+    }
+    std::this_thread::sleep_for(400ms); // 期间重连会失败几轮
+    if (port->reconnect_count() != 0 || max_call > 50ms) {
+        spdlog::error(
+            "while down: {} reconnects, send_data() took up to {} us",
+            port->reconnect_count(),
+            std::chrono::duration_cast<std::chrono::microseconds>(max_call).count()
+        );
+        ++failures;
+    }
+
+    //* 下位机重新连接：自动重连，收发恢复
+    const auto reopened = std::chrono::steady_clock::now();
+    master              = open_pty(link);
+    if (!wait_until([&] { return port->reconnect_count() == 1; }, 3000ms)) {
+        spdlog::error("the port did not reconnect after the pty was reopened");
+        ++failures;
+    }
+    const auto reconnect_time = std::chrono::steady_clock::now() - reopened;
+
+    write_frames(master, 20, 20);
+    if (!wait_until([&] { return port->imu_history().written() == 40; }, 1000ms)) {
+        spdlog::error("frames after reconnect were not received: {} of 40", port->imu_history().written());
+        ++failures;
+    }
+    VisionPLCSendMsg cmd;
+    cmd.pitch = 12345;
+    port->send_data(cmd);
+    if (!receive_command(master, 12345)) {
+        spdlog::error("commands after reconnect were not sent");
+        ++failures;
+    }
+
+    //* 下位机不再发送数据：超过 kTimeout 后同样认为断开，并重连到同一个端口
+    if (!wait_until([&] { return port->port_down_count() == 2 && port->reconnect_count() == 2; }, 3000ms)) {
+        spdlog::error(
+            "silence was not detected: {} downs, {} reconnects", port->port_down_count(), port->reconnect_count()
+        );
+        ++failures;
+    }
+    spdlog::info(
+        "{} port downs, {} reconnects, reconnected {} ms after the pty was reopened",
+        port->port_down_count(),
+        port->reconnect_count(),
+        std::chrono::duration_cast<std::chrono::milliseconds>(reconnect_time).count()
+    );
+
+    port->stop_async_io();
+    close(master);
+    fs::remove(link);
+    fs::remove(config);
+
+    if (failures)
+        spdlog::error("serial reconnect test failed: {} failures", failures);
+    else
+        spdlog::info("serial reconnect test passed");
+    return failures ? 1 : 0;
+}
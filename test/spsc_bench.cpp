@@ -0,0 +1,66 @@
+#include "circular_buffer.hpp"
+#include "spsc_ring_buffer.hpp"
+
+#include <chrono>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 一个生产者线程、一个消费者线程通过缓冲区传递 count 个元素，返回平均每个元素耗时 (ns)
+ * @remark CircularBuffer 满时会覆盖旧数据，为了公平，两种缓冲区的生产者都在满时等待
+ */
+template <typename Buffer, typename Item>
+double transfer(Buffer &buffer, size_t count, const Item &item) {
+    auto start = std::chrono::steady_clock::now();
+
+    std::thread producer([&] {
+        for (size_t i = 0; i < count;) {
+            if (buffer.size() >= buffer.capacity()) {
+                std::this_thread::yield();
+                continue;
+            }
+            buffer.push(Item(item));
+            ++i;
+        }
+    });
+    for (size_t received = 0; received < count;) {
+        auto data = buffer.pop();
+        if (data.has_value())
+            ++received;
+        else
+            std::this_thread::yield();
+    }
+    producer.join();
+
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / count;
+}
+
+template <typename Item>
+void compare(const char *name, size_t count, size_t capacity, const Item &item) {
+    CircularBuffer<Item> locked(capacity);
+    SPSCRingBuffer<Item> lock_free(capacity);
+
+    double t_locked    = transfer(locked, count, item);
+    double t_lock_free = transfer(lock_free, count, item);
+    spdlog::info(
+        "{:<24} capacity={:<5} CircularBuffer {:8.1f} ns/item, SPSCRingBuffer {:8.1f} ns/item, speedup {:.2f}x",
+        name,
+        capacity,
+        t_locked,
+        t_lock_free,
+        t_locked / t_lock_free
+    );
+}
+
+int main() {
+    constexpr size_t kCount = 2000000;
+
+    for (size_t capacity : {16, 1024}) {
+        compare("int", kCount, capacity, 42);
+        // 模拟流水线上每帧传递的装甲板数组
+        compare("std::vector<double>(64)", kCount / 4, capacity, std::vector<double>(64, 1.0));
+    }
+    return 0;
+}
@@ -0,0 +1,73 @@
+#include "bench_util.hpp"
+#include "config.hpp"
+#include "detector.hpp"
+#include "thpool.hpp"
+
+#include <memory>
+#include <opencv2/opencv.hpp>
+#include <spdlog/spdlog.h>
+#include <thread>
+
+/**
+ * @brief 噪声背景 + 若干对敌方颜色的灯条，部分灯条刻意跨过条带边界
+ */
+static cv::Mat make_frame(cv::Size size, int armors, cv::RNG &rng) {
+    cv::Mat img(size, CV_8UC3);
+    rng.fill(img, cv::RNG::UNIFORM, 0, 60);
+    const cv::Scalar enemy = EnemyColor == RMColor::Blue ? cv::Scalar(255, 160, 60) : cv::Scalar(60, 160, 255);
+    for (int i = 0; i < armors; ++i) {
+        const int h = rng.uniform(20, 120), gap = h * rng.uniform(2, 5) / 2;
+        cv::Point c(rng.uniform(gap, size.width - gap), rng.uniform(h, size.height - h));
+        cv::rectangle(img, cv::Rect(c.x - gap / 2, c.y - h / 2, h / 5 + 1, h), enemy, cv::FILLED);
+        cv::rectangle(img, cv::Rect(c.x + gap / 2, c.y - h / 2, h / 5 + 1, h), enemy, cv::FILLED);
+    }
+    return img;
+}
+
+static bool same_armors(const std::vector<AutoAim::Armor> &a, const std::vector<AutoAim::Armor> &b) {
+    if (a.size() != b.size())
+        return false;
+    for (size_t i = 0; i < a.size(); ++i)
+        if (a[i].center != b[i].center || a[i].type != b[i].type || a[i].vertices != b[i].vertices)
+            return false;
+    return true;
+}
+
+int main() {
+    constexpr int kFrames = 50;
+    cv::setNumThreads(1); // 只比较条带并行本身
+    cv::RNG rng(20250309);
+
+    auto pool = std::make_shared<ThreadPool<>>(std::thread::hardware_concurrency());
+    AutoAim::Detector serial, striped;
+    striped.set_thread_pool(pool);
+    spdlog::info("thread pool with {} workers", pool->size());
+
+    const std::pair<const char *, cv::Size> sizes[] = {
+        {"720p", {1280, 720}},
+        {"1080p", {1920, 1080}},
+        {"full sensor", {2448, 2048}},
+    };
+    bool all_identical = true;
+    for (const auto &[name, size] : sizes) {
+        cv::Mat img = make_frame(size, 12, rng);
+        std::vector<AutoAim::Armor> expected, result;
+
+        double t_serial  = per_frame_ms(kFrames, [&] { expected = serial.detect(img); });
+        double t_striped = per_frame_ms(kFrames, [&] { result = striped.detect(img); });
+        const bool identical = same_armors(expected, result);
+        all_identical &= identical;
+        spdlog::info(
+            "{:<12} {}x{}: serial {:.3f} ms, striped {:.3f} ms, speedup {:.2f}x, {} armors, {}",
+            name,
+            size.width,
+            size.height,
+            t_serial,
+            t_striped,
+            t_serial / t_striped,
+            expected.size(),
+            identical ? "identical" : "MISMATCH"
+        );
+    }
+    return all_identical ? 0 : 1;
+}
@@ -0,0 +1,76 @@
+#include "thpool.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <future>
+#include <spdlog/spdlog.h>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief 模拟每帧的扇出任务（分类 N 个装甲板 / 解算 N 个 PnP / 更新 8 个 tracker）
+ */
+static double busy_work(size_t i, int iterations) {
+    double x = 1.0 + i;
+    for (int k = 0; k < iterations; ++k)
+        x = std::sqrt(x + k);
+    return x;
+}
+
+template <typename Fn>
+double per_frame_us(int frames, Fn &&fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int f = 0; f < frames; ++f)
+        fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::micro>(end - start).count() / frames;
+}
+
+int main() {
+    ThreadPool<> pool(std::thread::hardware_concurrency());
+    spdlog::info("thread pool with {} workers", pool.size());
+
+    constexpr int kFrames = 2000;
+    std::vector<double> sink(64);
+
+    for (int iterations : {0, 200, 2000}) {
+        for (size_t n : {1, 4, 8, 16}) {
+            double serial = per_frame_us(kFrames, [&] {
+                for (size_t i = 0; i < n; ++i)
+                    sink[i] = busy_work(i, iterations);
+            });
+
+            double spawn = per_frame_us(kFrames, [&] {
+                std::vector<std::thread> threads;
+                for (size_t i = 0; i < n; ++i)
+                    threads.emplace_back([&, i] { sink[i] = busy_work(i, iterations); });
+                for (auto &t : threads)
+                    t.join();
+            });
+
+            double futures = per_frame_us(kFrames, [&] {
+                std::vector<std::future<double>> results;
+                for (size_t i = 0; i < n; ++i)
+                    results.push_back(pool.submit(busy_work, i, iterations));
+                for (size_t i = 0; i < n; ++i)
+                    sink[i] = results[i].get();
+            });
+
+            double parallel_for = per_frame_us(kFrames, [&] {
+                pool.parallel_for(0, n, [&](size_t i) { sink[i] = busy_work(i, iterations); });
+            });
+
+            spdlog::info(
+                "work={:>4} tasks={:>2} | serial {:8.2f} us | std::thread {:8.2f} us | submit {:8.2f} us | "
+                "parallel_for {:8.2f} us",
+                iterations,
+                n,
+                serial,
+                spawn,
+                futures,
+                parallel_for
+            );
+        }
+    }
+    return 0;
+}
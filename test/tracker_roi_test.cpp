@@ -0,0 +1,155 @@
+#include "config.hpp"
+#include "pose_convert.hpp"
+#include "tracker.hpp"
+
+#include <chrono>
+#include <opencv2/calib3d.hpp>
+#include <spdlog/spdlog.h>
+#include <toml++/toml.h>
+
+static cv::Mat read_mat(const toml::table &config, const std::string &key, int rows) {
+    std::vector<double> data;
+    if (const auto *arr = config[key].as_array())
+        for (const auto &elem : *arr)
+            data.push_back(elem.value_or(0.0));
+    return cv::Mat(data, true).reshape(1, rows);
+}
+
+/**
+ * @brief 相机系下位于 tvec（mm）的小装甲板，拍摄于 t 时刻
+ */
+static AnnotatedArmorInfo annotate(
+    const toml::table &config, const cv::Vec3d &tvec, std::chrono::system_clock::time_point t
+) {
+    AnnotatedArmorInfo info;
+    info.armor.type     = AutoAim::ArmorType::Small;
+    info.result         = AutoAim::Labels::Infantry3;
+    info.timestamp      = t;
+    info.imu_info.pitch = -4;
+    info.imu_info.yaw   = 30;
+
+    std::vector<cv::Point3f> corners = {
+        {-SmallArmorWidth / 2, -SmallArmorHeight / 2, 0},
+        {SmallArmorWidth / 2, -SmallArmorHeight / 2, 0},
+        {SmallArmorWidth / 2, SmallArmorHeight / 2, 0},
+        {-SmallArmorWidth / 2, SmallArmorHeight / 2, 0},
+    };
+    cv::projectPoints(
+        corners,
+        cv::Vec3d(0, 0.2, 0),
+        tvec,
+        read_mat(config, "cameraMatrix", 3),
+        read_mat(config, "distCoeffs", 1),
+        info.armor.vertices
+    );
+    return info;
+}
+
+static Armor3d observe(
+    const AutoAim::PoseConvert &pose, const toml::table &config, const cv::Vec3d &tvec,
+    std::chrono::system_clock::time_point t
+) {
+    Armor3d armor;
+    pose.solve_absolute(annotate(config, tvec, t), armor);
+    return armor;
+}
+
+static cv::Point2d center_of(const cv::Rect &rect) { return {rect.x + rect.width / 2.0, rect.y + rect.height / 2.0}; }
+
+int main() {
+    using namespace std::chrono;
+    spdlog::set_level(spdlog::level::off);
+    const auto config = toml::parse_file(CONFIG_PATH + "transform.toml");
+    AutoAim::PoseConvert pose(CONFIG_PATH + "transform.toml");
+    AutoAim::Tracker tracker(AutoAim::Labels::Infantry3, CONFIG_PATH + "tracking.toml");
+
+    size_t failures = 0;
+
+    //* 装甲板在相机系下以 1 m/s 横向移动，每 10 ms 拍摄一帧
+    const auto t0        = system_clock::now();
+    const auto frame     = milliseconds(10);
+    const cv::Vec3d step = {10, 0, 0}; // mm / frame
+    const cv::Vec3d tvec = {100, -50, 3000};
+
+    std::vector<Armor3d> arms;
+    std::vector<Armor3d> predictions;
+    std::vector<const Armor3d *> priors;
+    for (int k = 0; k < 2; ++k) {
+        //* 与 app 中相同：正在跟踪时以跟踪器对拍摄时刻的预测为初值，一帧批量解算
+        const std::vector<AnnotatedArmorInfo> armors = {annotate(config, tvec + k * step, t0 + k * frame)};
+        priors.assign(armors.size(), nullptr);
+        predictions.resize(armors.size());
+        if (tracker.is_tracking()) {
+            predictions[0] = tracker.predict(armors[0].timestamp);
+            priors[0]      = &predictions[0];
+        }
+
+        const WarmStartStats before = pose.warm_start_stats();
+        pose.solve_absolute(armors, priors, arms);
+        const WarmStartStats after = pose.warm_start_stats();
+
+        // 第一帧还没有跟踪，之后每帧的预测都应经过迭代求精并被采用
+        const uint64_t expected = k > 0 ? 1 : 0;
+        if (after.attempts - before.attempts != expected || after.accepted - before.accepted != expected) {
+            spdlog::error(
+                "frame {}: {} warm starts attempted, {} accepted, expected {}",
+                k,
+                after.attempts - before.attempts,
+                after.accepted - before.accepted,
+                expected
+            );
+            ++failures;
+        }
+        if (arms[0].timestamp != armors[0].timestamp) {
+            spdlog::error("frame {}: solve_absolute does not carry the capture time", k);
+            ++failures;
+        }
+        tracker.update(arms[0]);
+
+        //* 跟踪器刚更新过，不应被判为丢失；对下一帧的预测投影为非空的 ROI
+        tracker.check_status();
+        if (!tracker.is_tracking()) {
+            spdlog::error("frame {}: tracker reports the target as lost right after an update", k);
+            ++failures;
+            continue;
+        }
+
+        const auto next          = t0 + (k + 1) * frame;
+        const cv::Rect hint      = pose.project_to_image(tracker.predict(next));
+        const cv::Rect last      = pose.project_to_image(tracker.last_observation());
+        const cv::Rect truth     = pose.project_to_image(observe(pose, config, tvec + (k + 1) * step, next));
+        const double hint_error  = cv::norm(center_of(hint) - center_of(truth));
+        const double stale_error = cv::norm(center_of(last) - center_of(truth));
+        if (hint.empty() || !hint.contains(center_of(truth))) {
+            spdlog::error(
+                "frame {}: hint ({}, {}, {}x{}) misses the next armor at ({}, {})",
+                k,
+                hint.x,
+                hint.y,
+                hint.width,
+                hint.height,
+                center_of(truth).x,
+                center_of(truth).y
+            );
+            ++failures;
+        }
+
+        //* 有了两次观测之后，预测应比上一次的观测更接近下一帧
+        if (k > 0 && !(hint_error < stale_error)) {
+            spdlog::error(
+                "frame {}: predicted hint is {:.2f} px off, no closer than the last observation ({:.2f} px)",
+                k,
+                hint_error,
+                stale_error
+            );
+            ++failures;
+        }
+    }
+
+    spdlog::set_level(spdlog::level::info);
+    if (failures)
+        spdlog::error("tracker roi test failed: {} failures", failures);
+    else
+        spdlog::info("tracker roi test passed");
+    return failures ? 1 : 0;
+}
@@ -1,9 +1,111 @@
+#include "mailbox.hpp"
 #include "work_queue.hpp"
+#include <algorithm>
+#include <chrono>
 #include <spdlog/spdlog.h>
+#include <string>
+#include <thread>
 #include <unistd.h>
+#include <vector>
 
 int main() {
-    
+    using namespace std::chrono;
+    size_t failures = 0;
 
-    return 0;
-}
\ No newline at end of file
+    //* pop_wait_for() 超时返回空
+    SyncQueue<int, 16, SPSCRingBuffer> queue;
+    auto start   = steady_clock::now();
+    auto nothing = queue.pop_wait_for(milliseconds(20));
+    auto waited  = steady_clock::now() - start;
+    if (nothing.has_value()) {
+        spdlog::error("pop_wait_for: returned {} from an empty queue", *nothing);
+        ++failures;
+    }
+    if (waited < milliseconds(20)) {
+        spdlog::error(
+            "pop_wait_for: returned after {} us, before the 20 ms timeout",
+            duration_cast<microseconds>(waited).count()
+        );
+        ++failures;
+    }
+
+    //* 消费者挂起后，生产者写入能及时唤醒
+    queue.set_parking_policy({.spin_count = 0, .yield_count = 0});
+    constexpr int kRounds = 200;
+    // 每个线程只写自己的时间戳数组，join() 之后再统计
+    std::vector<steady_clock::time_point> sent(kRounds), received(kRounds);
+    size_t out_of_order = 0; // 只由消费者写入
+    std::thread consumer([&] {
+        for (int i = 0; i < kRounds; ++i) {
+            int value   = queue.pop_wait();
+            received[i] = steady_clock::now();
+            if (value != i)
+                ++out_of_order;
+        }
+    });
+    for (int i = 0; i < kRounds; ++i) {
+        std::this_thread::sleep_for(microseconds(500)); // 让消费者进入挂起状态
+        sent[i] = steady_clock::now();
+        queue.write_data(i);
+    }
+    consumer.join();
+    if (out_of_order) {
+        spdlog::error("pop_wait: {} of {} values arrived out of order", out_of_order, kRounds);
+        failures += out_of_order;
+    }
+    double total_us = 0;
+    for (int i = 0; i < kRounds; ++i)
+        total_us += duration<double, std::micro>(received[i] - sent[i]).count();
+    spdlog::info("average wake-up latency after park: {:.1f} us", total_us / kRounds);
+
+    //* Mailbox 只保留最新值，并统计被覆盖的数量
+    Mailbox<int> mailbox;
+    if (auto empty = mailbox.take(); empty.has_value()) {
+        spdlog::error("mailbox: take() returned {} before any write", *empty);
+        ++failures;
+    }
+    for (int i = 1; i <= 3; ++i)
+        mailbox.write(i);
+    auto newest = mailbox.take();
+    if (newest != 3) {
+        spdlog::error("mailbox: take() returned {}, expected 3", newest ? std::to_string(*newest) : "nothing");
+        ++failures;
+    }
+    if (auto again = mailbox.take(); again.has_value()) {
+        spdlog::error("mailbox: take() returned {} again after the value was taken", *again);
+        ++failures;
+    }
+    if (mailbox.dropped() != 2 || mailbox.written() != 3) {
+        spdlog::error("mailbox: {} written, {} dropped, expected 3 and 2", mailbox.written(), mailbox.dropped());
+        ++failures;
+    }
+
+    //* 读端永远不会读到旧值或撕裂的值
+    Mailbox<std::pair<int, int>> latest;
+    constexpr int kWrites = 100000;
+    std::thread writer([&] {
+        for (int i = 1; i <= kWrites; ++i)
+            latest.write({i, -i});
+    });
+    size_t stale = 0, torn = 0;
+    for (int last = 0; last < kWrites;) {
+        auto [a, b] = latest.take_wait();
+        if (a <= last)
+            ++stale;
+        if (a != -b)
+            ++torn;
+        last = std::max(last, a);
+    }
+    writer.join();
+    if (stale || torn) {
+        spdlog::error("mailbox: read {} stale and {} torn values", stale, torn);
+        failures += stale + torn;
+    }
+    spdlog::info("mailbox: {} written, {} dropped", latest.written(), latest.dropped());
+
+    if (failures)
+        spdlog::error("work queue test failed: {} failures", failures);
+    else
+        spdlog::info("work queue test passed");
+    return failures ? 1 : 0;
+}
@@ -3,36 +3,48 @@
 #include "structs.hpp"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <opencv2/core.hpp>
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
 #include "tracker.hpp"
 
 #include <spdlog/spdlog.h>
-#include <stdexcept>
+#include <toml++/toml.h>
 
 AutoAim::Tracker::Tracker(const Labels &label, const std::string &config_path) {
-    this->log_ = spdlog::stdout_color_mt("Tracker");
-    this->log_->set_level(spdlog::level::trace);
-    this->log_->set_pattern("[%H:%M:%S, +%4oms] [%15s:%3# in %!] [%^%l%$] %v");
-
-    this->status_          = TrackingStatus::LOST;
-    this->tracked_id_      = label;
-    this->last_track_time_ = std::chrono::high_resolution_clock::now();
+    // 每个目标一个 Tracker，共用同一个 logger
+    this->log_ = spdlog::get("Tracker");
+    if (!this->log_) {
+        this->log_ = spdlog::stdout_color_mt("Tracker");
+        this->log_->set_level(spdlog::level::trace);
+        this->log_->set_pattern("[%H:%M:%S, +%4oms] [%15s:%3# in %!] [%^%l%$] %v");
+    }
 
-    this->_forward_and_init();
-    this->low_pass_.set_alpha(0.75);
+    this->status_     = TrackingStatus::LOST;
+    this->tracked_id_ = label;
 
     try {
-        throw std::runtime_error("reading config not implemented yet");
+        auto T                  = toml::parse_file(config_path);
+        this->cfg_.lost_timeout = T["lost_time_out"].value_or(this->cfg_.lost_timeout);
+        this->cfg_.dt           = T["KF_dt"].value_or(this->cfg_.dt);
+        this->cfg_.kf_q         = T["KF_Q"].value_or(this->cfg_.kf_q);
+        this->cfg_.kf_r         = T["KF_R"].value_or(this->cfg_.kf_r);
+        this->cfg_.max_speed    = T["max_speed"].value_or(this->cfg_.max_speed);
     } catch (const std::exception &e) {
         SPDLOG_LOGGER_CRITICAL(this->log_, "Error: {}", e.what());
     }
+
+    this->state_dim   = 10;
+    this->observe_dim = 8;
+    this->_forward_and_init();
+    this->low_pass_.set_alpha(0.75);
 }
 
 PredictedPosition AutoAim::Tracker::update(const Armor3d &armor3d) {
     if (this->status_ == TrackingStatus::LOST) {
-        this->status_ = TrackingStatus::FITTING;
+        this->status_          = TrackingStatus::FITTING;
+        this->last_track_time_ = {}; // 丢失前的观测不再用于计算速度
     }
 
     cv::Mat estimate   = this->_forward_and_update(armor3d);
@@ -43,6 +55,7 @@ void AutoAim::Tracker::_forward_and_init() {
     if constexpr (std::is_same_v<decltype(this->kf_), KalmanFilter::KF>) {
         // * 如果使用线性卡尔曼滤波
         const double &dt = this->cfg_.dt;
+        this->kf_.init(this->state_dim, this->observe_dim, 0, CV_32F);
         // clang-format off
         this->kf_.transitionMatrix = (cv::Mat_<float>(this->state_dim, this->state_dim) <<
             1, 0, 0, dt, 0, 0, 0, 0, 0, 0,
@@ -56,7 +69,10 @@ void AutoAim::Tracker::_forward_and_init() {
             0, 0, 0, 0, 0, 0, 0, 0, 1, dt,
             0, 0, 0, 0, 0, 0, 0, 0, 0, 1);
         // clang-format on
-        cv::setIdentity(this->kf_.measurementMatrix);
+        // 观测 [x, y, z, vx, vy, vz, rz, Pitch] 依次对应状态的第 0 ~ 6 维与第 8 维
+        for (int i = 0; i < 7; ++i)
+            this->kf_.measurementMatrix.at<float>(i, i) = 1;
+        this->kf_.measurementMatrix.at<float>(7, 8) = 1;
         cv::setIdentity(this->kf_.processNoiseCov, cv::Scalar::all(this->cfg_.kf_q));
         cv::setIdentity(this->kf_.measurementNoiseCov, cv::Scalar::all(this->cfg_.kf_r));
         cv::setIdentity(this->kf_.errorCovPost, cv::Scalar::all(1));
@@ -69,22 +85,23 @@ PredictedPosition AutoAim::Tracker::_forward_and_predict(const cv::Mat &estimate
     result.tracking_id = armor.result;
 
     if constexpr (std::is_same_v<decltype(this->kf_), KalmanFilter::KF>) {
-        double est_x      = estimate.at<double>(0);
-        double est_y      = estimate.at<double>(1);
-        double est_z      = estimate.at<double>(2);
-        double est_vx     = estimate.at<double>(3);
-        double est_vy     = estimate.at<double>(4);
-        double est_vz     = estimate.at<double>(5);
-        double est_dir    = estimate.at<double>(6);
-        double est_vdir   = estimate.at<double>(7);
-        double est_pitch  = estimate.at<double>(8);
-        double est_vpitch = estimate.at<double>(9);
-
-        double t_fly = armor.bullet_flying_time + this->fire_cfg_.time_dalay;
-
-        result.x         = armor.p_barrel.center_3d.at<double>(0) + est_vx * t_fly;
-        result.y         = armor.p_barrel.center_3d.at<double>(1) + est_vy * t_fly;
-        result.z         = armor.p_barrel.center_3d.at<double>(2) + est_vz * t_fly;
+        double est_x      = estimate.at<float>(0);
+        double est_y      = estimate.at<float>(1);
+        double est_z      = estimate.at<float>(2);
+        double est_vx     = estimate.at<float>(3);
+        double est_vy     = estimate.at<float>(4);
+        double est_vz     = estimate.at<float>(5);
+        double est_dir    = estimate.at<float>(6);
+        double est_vdir   = estimate.at<float>(7);
+        double est_pitch  = estimate.at<float>(8);
+        double est_vpitch = estimate.at<float>(9);
+
+        double t_fly = armor.bullet_flying_time + this->fire_cfg_.time_dalay
+                     + std::chrono::duration<double>(this->command_delay_).count();
+
+        result.x         = armor.p_barrel.center_3d[0] + est_vx * t_fly;
+        result.y         = armor.p_barrel.center_3d[1] + est_vy * t_fly;
+        result.z         = armor.p_barrel.center_3d[2] + est_vz * t_fly;
         result.direction = armor.p_barrel.direction + est_vdir * t_fly;
         result.center_3d = (cv::Mat_<double>(3, 1) << result.x, result.y, result.z);
         result.pitch     = armor.p_barrel.pitch + est_vpitch * t_fly;
@@ -101,22 +118,29 @@ cv::Mat AutoAim::Tracker::_forward_and_update(const Armor3d &armor3d) {
         double vx, vy, vz;
         using namespace std::chrono;
 
-        if (this->last_track_time_ == high_resolution_clock::time_point{}) {
+        // 由两次观测的拍摄时间计算速度
+        const bool first     = this->last_track_time_ == system_clock::time_point{};
+        const double elapsed = duration<double>(armor3d.timestamp - this->last_track_time_).count();
+        if (first) {
             vx = vy = vz = 0;
+        } else if (elapsed <= 0) {
+            // 同一帧中的另一块装甲板，沿用当前的速度估计
+            vx = this->kf_.statePost.at<float>(3);
+            vy = this->kf_.statePost.at<float>(4);
+            vz = this->kf_.statePost.at<float>(5);
         } else {
-            double duration = duration_cast<seconds>(high_resolution_clock::now() - this->last_track_time_).count();
-            vx              = std::clamp(
-                (prev_state_.p_barrel.center_3d.at<double>(0) - armor3d.p_barrel.center_3d.at<double>(0)) / duration,
+            vx = std::clamp(
+                (armor3d.p_barrel.center_3d[0] - prev_state_.p_barrel.center_3d[0]) / elapsed,
                 this->cfg_.max_speed * -1.0,
                 this->cfg_.max_speed
             );
             vy = std::clamp(
-                (prev_state_.p_barrel.center_3d.at<double>(1) - armor3d.p_barrel.center_3d.at<double>(1)) / duration,
+                (armor3d.p_barrel.center_3d[1] - prev_state_.p_barrel.center_3d[1]) / elapsed,
                 this->cfg_.max_speed * -1.0,
                 this->cfg_.max_speed
             );
             vz = std::clamp(
-                (prev_state_.p_barrel.center_3d.at<double>(2) - armor3d.p_barrel.center_3d.at<double>(2)) / duration,
+                (armor3d.p_barrel.center_3d[2] - prev_state_.p_barrel.center_3d[2]) / elapsed,
                 this->cfg_.max_speed * -1.0,
                 this->cfg_.max_speed
             );
@@ -124,9 +148,9 @@ cv::Mat AutoAim::Tracker::_forward_and_update(const Armor3d &armor3d) {
 
         // clang-format off
         cv::Mat observation = (cv::Mat_<float>(this->observe_dim, 1) <<
-            armor3d.p_barrel.center_3d.at<double>(0),
-            armor3d.p_barrel.center_3d.at<double>(1),
-            armor3d.p_barrel.center_3d.at<double>(2),
+            armor3d.p_barrel.center_3d[0],
+            armor3d.p_barrel.center_3d[1],
+            armor3d.p_barrel.center_3d[2],
             vx, vy, vz,
             armor3d.p_barrel.direction, armor3d.p_barrel.pitch
         );
@@ -136,6 +160,12 @@ cv::Mat AutoAim::Tracker::_forward_and_update(const Armor3d &armor3d) {
         prev_state_      = armor3d;
         last_track_time_ = armor3d.timestamp;
 
+        // * 第一次观测直接作为初始状态
+        if (first) {
+            this->kf_.statePost = this->kf_.measurementMatrix.t() * observation;
+            return this->kf_.statePost;
+        }
+
         // * update kalman filter
         this->kf_.predict();
         auto estimate = this->kf_.correct(observation);
@@ -144,12 +174,36 @@ cv::Mat AutoAim::Tracker::_forward_and_update(const Armor3d &armor3d) {
     }
 }
 
+Armor3d AutoAim::Tracker::predict(std::chrono::system_clock::time_point t) const {
+    using namespace std::chrono;
+    Armor3d result = this->prev_state_;
+    if (this->kf_.statePost.empty())
+        return result;
+
+    const double dt   = std::max(0.0, duration<double>(t - this->prev_state_.timestamp).count());
+    const cv::Mat &x  = this->kf_.statePost;
+    const double ddir = x.at<float>(7) * dt; // deg
+
+    //* 位置按速度外推，朝向绕 barrel 系 z 轴转动
+    const cv::Vec3d velocity{x.at<float>(3), x.at<float>(4), x.at<float>(5)};
+    const double c = std::cos(ddir * kDegreeToRadian), s = std::sin(ddir * kDegreeToRadian);
+    const cv::Matx33d R_dir(c, -s, 0, s, c, 0, 0, 0, 1);
+
+    result.T_armor_to_barrel  = result.T_armor_to_barrel + velocity * dt;
+    result.R_armor_to_barrel  = R_dir * result.R_armor_to_barrel;
+    result.p_barrel.center_3d = result.T_armor_to_barrel;
+    result.p_barrel.distance  = cv::norm(result.p_barrel.center_3d);
+    result.timestamp          = t;
+    result.p_barrel.direction += ddir;
+    return result;
+}
+
 void AutoAim::Tracker::check_status() {
     using namespace std::chrono;
     if (this->status_ == TrackingStatus::LOST)
         return;
 
-    auto now = high_resolution_clock::now();
+    auto now = system_clock::now();
     if (duration_cast<seconds>(now - this->last_track_time_).count() > this->cfg_.lost_timeout) {
         this->status_ = TrackingStatus::LOST;
         this->_forward_and_init();
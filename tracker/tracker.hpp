@@ -28,13 +28,33 @@ class Tracker {
 
     PredictedPosition get_pred() { return pred_; }
 
+    // 是否正在跟踪（未丢失）
+    bool is_tracking() const { return status_ != TrackingStatus::LOST; }
+
+    // 最近一次用于更新的观测
+    const Armor3d &last_observation() const { return prev_state_; }
+
+    /**
+     * @brief 由最近一次观测与卡尔曼滤波估计的速度，预测装甲板在 t 时刻的位姿
+     * @details 只外推 armor -> barrel 位姿（T_armor_to_barrel、R_armor_to_barrel、p_barrel）；
+     * p_a2c 与 imu_info 仍是最近一次观测的值。用于为下一帧的检测提供 ROI，以及作为 PnP 的初值
+     */
+    Armor3d predict(std::chrono::system_clock::time_point t) const;
+
+    /**
+     * @brief 指令从发出到下位机收到的延迟，预测时计入提前量
+     * @details 由串口的 ClockSync 测量（协议 v3），没有测量值时为 0，只使用配置的 time_dalay
+     */
+    void set_command_delay(std::chrono::nanoseconds delay) { command_delay_ = delay; }
+
   protected:
     TrackingConfig cfg_;
     FiringConfig fire_cfg_;
 
     TrackingStatus status_;
     Armor3d prev_state_;
-    std::chrono::high_resolution_clock::time_point last_track_time_;
+    std::chrono::system_clock::time_point last_track_time_; // 最近一次观测的拍摄时间
+    std::chrono::nanoseconds command_delay_{0};
 
     ArmorCount armor_count_;
     Labels tracked_id_;
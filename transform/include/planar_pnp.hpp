@@ -0,0 +1,131 @@
+#ifndef __PLANAR_PNP_HPP__
+#define __PLANAR_PNP_HPP__
+
+#include "config.hpp"
+#include "structs.hpp"
+
+#include <Eigen/Core>
+#include <Eigen/Dense>
+#include <array>
+#include <opencv2/core.hpp>
+#include <span>
+
+namespace AutoAim {
+
+/**
+ * @brief 装甲板模板：armor 系下四个角点的 (x, y) 坐标，z = 0，单位 mm
+ * @details 角点顺序与 Armor::vertices 相同：左上、右上、右下、左下
+ */
+struct ArmorTemplate {
+    double half_width, half_height;
+    std::array<std::array<double, 2>, 4> corners;
+};
+
+constexpr ArmorTemplate make_armor_template(double width, double height) {
+    return {
+        width / 2,
+        height / 2,
+        {{
+            {-width / 2, -height / 2},
+            {width / 2, -height / 2},
+            {width / 2, height / 2},
+            {-width / 2, height / 2},
+        }},
+    };
+}
+
+inline constexpr ArmorTemplate kSmallArmorTemplate = make_armor_template(SmallArmorWidth, SmallArmorHeight);
+inline constexpr ArmorTemplate kLargeArmorTemplate = make_armor_template(LargeArmorWidth, LargeArmorHeight);
+
+constexpr const ArmorTemplate &armor_template(ArmorType type) {
+    return type == ArmorType::Large ? kLargeArmorTemplate : kSmallArmorTemplate;
+}
+
+/**
+ * @brief armor 系到 camera 系的位姿，与 cv::solvePnP 的输出相同
+ */
+struct PlanarPose {
+    cv::Vec3d rvec, tvec; // tvec 单位与模板相同（mm）
+    double error;         // 去畸变后像素坐标下四个角点的 RMS 重投影误差，解在相机后方时为无穷大
+};
+
+/**
+ * @brief 平面 PnP 的两个解。平面目标的位姿存在翻转二义性，两个解都保留，poses[0] 的重投影误差较小
+ */
+struct PlanarPnPResult {
+    std::array<PlanarPose, 2> poses;
+    bool valid{false};
+};
+
+/**
+ * @brief 已知尺寸的矩形装甲板的闭式 PnP（IPPE, Collins & Bartoli 2014）
+ * @details 角点去畸变到归一化相机坐标后，由四点求模板平面到图像的单应矩阵，
+ * 再由单应矩阵在模板中心的雅可比闭式求出两个旋转，最后按最小二乘求平移。
+ * 结果与 cv::solvePnP(..., SOLVEPNP_IPPE) 相同，但全部使用固定大小的矩阵，不分配堆内存。
+ *
+ * @remark 忽略相机内参的 skew；畸变系数只使用前 5 个（k1, k2, p1, p2, k3）
+ */
+class PlanarPnP {
+  public:
+    PlanarPnP() = default;
+    PlanarPnP(const cv::Mat &camera_matrix, const cv::Mat &dist_coeffs);
+
+    /**
+     * @brief 解算一个装甲板
+     * @return 是否得到有效解（角点退化、在相机后方等情况下为 false）
+     */
+    bool solve(const ArmorTemplate &model, const std::array<cv::Point2f, 4> &corners, PlanarPnPResult &result) const;
+
+    /**
+     * @brief 按装甲板类型选择模板解算，vertices 不是四个点时返回 false
+     */
+    bool solve(const Armor &armor, PlanarPnPResult &result) const;
+
+    /**
+     * @brief 一次解算一帧中所有的装甲板
+     * @param results 大小至少为 armors.size()，第 i 个结果对应第 i 个装甲板
+     */
+    void solve(std::span<const Armor> armors, std::span<PlanarPnPResult> results) const;
+
+    /**
+     * @brief 以 pose 为初值，用 Levenberg-Marquardt 迭代最小化四个角点的重投影误差
+     * @details 相当于 solvePnP 的 useExtrinsicGuess，但不分配堆内存。初值在正确的 IPPE 分支上时，
+     * 迭代结果也留在该分支上，不会在两个解之间翻转
+     *
+     * @param pose 输入初值，输出迭代结果，error 为迭代后的重投影误差
+     * @param iterations 最大迭代次数，误差不再下降时提前结束
+     * @return 初值是否有效（所有角点在相机前方）
+     */
+    bool refine(
+        const ArmorTemplate &model, const std::array<cv::Point2f, 4> &corners, PlanarPose &pose, int iterations = 3
+    ) const;
+    bool refine(const Armor &armor, PlanarPose &pose, int iterations = 3) const;
+
+    /**
+     * @brief 像素坐标去畸变，得到归一化相机坐标
+     */
+    Eigen::Vector2d undistort(const cv::Point2f &pixel) const;
+
+  private:
+    /**
+     * @brief 计算重投影误差对位姿增量的正规方程 J^T J, J^T r，返回 RMS 重投影误差（有角点在相机后方时为无穷大）
+     */
+    double linearize(
+        const ArmorTemplate &model,
+        const std::array<Eigen::Vector2d, 4> &image,
+        const Eigen::Matrix3d &R,
+        const Eigen::Vector3d &t,
+        Eigen::Matrix<double, 6, 6> &JtJ,
+        Eigen::Matrix<double, 6, 1> &Jtr
+    ) const;
+
+    double fx_{1}, fy_{1}, cx_{0}, cy_{0};
+    std::array<double, 5> dist_{}; // k1, k2, p1, p2, k3
+    bool distorted_{false};        // 是否有非 0 的畸变系数
+
+    static constexpr int undistort_iterations = 10;
+};
+
+} // namespace AutoAim
+
+#endif // __PLANAR_PNP_HPP__
@@ -1,6 +1,7 @@
 #ifndef __PNPSOLVER_HPP__
 #define __PNPSOLVER_HPP__
 
+#include "planar_pnp.hpp"
 #include "structs.hpp"
 
 #include <opencv2/core/types.hpp>
@@ -22,7 +23,7 @@ class PnPSolver {
 
   private:
     cv::Mat cam_mat_, distort_mat_;
-    std::vector<cv::Point3f> armor_points_;
+    PlanarPnP pnp_;
 
     //! 甲板参数
     static constexpr double armor_width  = 180;
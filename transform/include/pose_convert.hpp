@@ -1,8 +1,10 @@
 #ifndef __POSE_CONVERT_HPP__
 #define __POSE_CONVERT_HPP__
 
+#include "planar_pnp.hpp"
 #include "structs.hpp"
 
+#include <Eigen/Geometry>
 #include <memory>
 #include <opencv2/core/mat.hpp>
 #include <spdlog/logger.h>
@@ -31,33 +33,91 @@ class PoseConvert {
      * @param armor_info
      * @return Armor3d
      */
-    Armor3d solve_absolute(const AnnotatedArmorInfo &armor_info);
+    Armor3d solve_absolute(const AnnotatedArmorInfo &armor_info) const;
+
+    /**
+     * @brief 同上，结果写入 result，不分配堆内存
+     * @details 角点无法解算（不是四个点、退化）时 result 为默认值，p_a2c.tvec 为 0
+     */
+    void solve_absolute(const AnnotatedArmorInfo &armor_info, Armor3d &result) const;
+
+    /**
+     * @brief 一次解算一帧中所有的装甲板
+     * @param results 大小调整为 armors.size()，第 i 个结果对应第 i 个装甲板
+     */
+    void solve_absolute(const std::vector<AnnotatedArmorInfo> &armors, std::vector<Armor3d> &results) const;
+
+    /**
+     * @brief 以跟踪器预测的位姿为初值解算，避免闭式解在两个 IPPE 分支之间翻转
+     * @details prior 的 armor -> barrel 位姿按当前 IMU 姿态转换到 camera 系作为初值，用 LM 迭代求精。
+     * prior 无效（未解算、装甲板类型不同）或迭代后的重投影误差超过 warmStartMaxError 时退回闭式解
+     *
+     * @param prior 跟踪器对同一目标在本帧拍摄时刻的预测（Tracker::predict()），或上一次的解算结果
+     */
+    void solve_absolute(const AnnotatedArmorInfo &armor_info, const Armor3d &prior, Armor3d &result) const;
+
+    /**
+     * @brief 一次解算一帧中所有的装甲板
+     * @param priors 与 armors 一一对应，nullptr 表示没有初值，使用闭式解
+     */
+    void solve_absolute(
+        const std::vector<AnnotatedArmorInfo> &armors,
+        const std::vector<const Armor3d *> &priors,
+        std::vector<Armor3d> &results
+    ) const;
+
+    /**
+     * @brief 由 PnP 得到的 armor -> camera 位姿计算装甲板的其余位姿信息
+     * @details solve_absolute() 中 PnP 之后的部分。坐标变换全部使用固定大小的 Eigen 矩阵，
+     * 静态外参在构造时已经算好，不分配堆内存
+     *
+     * @param imu 拍摄图像时的 IMU 姿态
+     * @param armor 输入 armor.p_a2c.rvec / armor.p_a2c.tvec（单位 mm），输出其余位姿字段
+     */
+    void solve_from_pnp(const IMUInfo &imu, Armor3d &armor) const;
+
+    /**
+     * @brief 把装甲板投影回图像，返回四个角点的外接矩形
+     * @details 用于跟踪引导的 ROI 检测。armor -> barrel 位姿按 armor.imu_info 转换到 camera 系后投影，
+     * 因此可以直接投影 Tracker::predict() 外推的位姿。
+     * 未解算（p_a2c.tvec 为默认值）或不在相机前方时返回空矩形
+     *
+     * @param armor 由 solve_absolute() 得到的装甲板，或跟踪器对它的预测
+     */
+    cv::Rect project_to_image(const Armor3d &armor) const;
+
+    // 以初值迭代求精的次数与结果被采用的次数
+    const WarmStartStats &warm_start_stats() const { return warm_start_stats_; }
 
   protected:
     std::shared_ptr<spdlog::logger> log_;
 
     cv::Mat camera_matrix;
     cv::Mat dist_coeffs;
+    PlanarPnP pnp_; // 由 camera_matrix, dist_coeffs 构造
 
-    cv::Mat T_camera_to_barrel; // meters
+    cv::Vec3d T_camera_to_barrel; // meters
 
-    cv::Mat T_camera_to_imu; // meters
-    cv::Mat R_camera_to_imu; // radians
-
-    cv::Mat T_base_to_barrel; // meters
-    cv::Mat R_base_to_barrel; // meters
+    //* 静态外参，构造时计算一次
+    Eigen::Isometry3d camera_to_imu{Eigen::Isometry3d::Identity()};  // meters
+    Eigen::Isometry3d base_to_barrel{Eigen::Isometry3d::Identity()}; // 尚未标定，为单位变换
 
     double bullet_velosity; // m/s
 
+    double warm_start_max_error{1.0}; // 以预测位姿为初值时可接受的重投影误差，pixel
+    mutable WarmStartStats warm_start_stats_; // 只由解算线程更新
+
   private:
     /**
      * @brief Utilize the result provided by solvePnP().
      * @details Armor(2D) -> Camera coord
      */
-    cv::Mat from_armor_to_camera(const pose_under_camera_coord &relative);
-    cv::Mat from_camera_to_imu();
-    cv::Mat from_imu_to_base(const IMUInfo &imu);
-    cv::Mat from_base_to_barrel();
+    Eigen::Isometry3d from_armor_to_camera(const pose_under_camera_coord &relative) const;
+    Eigen::Isometry3d from_imu_to_base(const IMUInfo &imu) const;
+    Eigen::Isometry3d from_camera_to_barrel(const IMUInfo &imu) const;
+
+    // 按 imu 姿态把 armor -> barrel 位姿转换为 armor -> camera 位姿，tvec 单位 mm
+    PlanarPose camera_pose_of(const Armor3d &armor, const IMUInfo &imu) const;
 };
 
 } // namespace AutoAim
@@ -5,6 +5,7 @@
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
+#include <Eigen/Geometry>
 #include <map>
 #include <opencv2/core/core.hpp>
 #include <string>
@@ -56,6 +57,24 @@ cv::Mat get_rotation_matrix(const double &rx, const double &ry, const double &rz
 double rad_to_deg(const double &rad);
 double deg_to_rad(const double &deg);
 
+// 以下为固定大小的版本，与对应的 cv::Mat 版本结果相同，全部在栈上计算，不分配堆内存
+
+/**
+ * @brief 从旋转矩阵和平移向量得到刚体变换，对应 get_homography_matrix_from_rotation_translation
+ */
+Eigen::Isometry3d
+get_isometry_from_rotation_translation(const Eigen::Matrix3d &rotation, const Eigen::Vector3d &translation);
+
+/**
+ * @brief 从旋转向量（solvePnP 得到的 rvec）计算旋转矩阵，对应 cv::Rodrigues
+ */
+Eigen::Matrix3d get_rotation_from_rvec(const cv::Vec3d &rvec);
+
+/**
+ * @brief 从绕三个轴旋转的 rx, ry, rz 得到旋转矩阵，参数约定与 get_rotation_matrix 相同
+ */
+Eigen::Matrix3d get_rotation_matrix_3d(const double &rx, const double &ry, const double &rz);
+
 } // namespace Functions
 
 class [[deprecated("only for testing, use PoseConvert instead")]] // Add warnings
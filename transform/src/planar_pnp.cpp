@@ -0,0 +1,351 @@
+#include "planar_pnp.hpp"
+
+#include <Eigen/Dense>
+#include <Eigen/Geometry>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief 由单应矩阵在模板中心的雅可比 J 与中心的像 v 求两个旋转（IPPE）
+ * @param J 2x2，模板平面 (x, y) -> 归一化图像坐标在原点处的偏导
+ * @param v 模板原点在归一化图像中的坐标
+ */
+bool ippe_rotations(const Eigen::Matrix2d &J, const Eigen::Vector2d &v, Eigen::Matrix3d &R1, Eigen::Matrix3d &R2) {
+    // Rv 把 z 轴转到视线 (v, 1) 方向
+    const Eigen::Matrix3d Rv
+        = Eigen::Quaterniond::FromTwoVectors(Eigen::Vector3d::UnitZ(), Eigen::Vector3d(v.x(), v.y(), 1))
+              .toRotationMatrix();
+    const Eigen::Matrix2d B = Rv.topLeftCorner<2, 2>() - v * Rv.block<1, 2>(2, 0);
+    if (std::abs(B.determinant()) < 1e-12)
+        return false;
+    const Eigen::Matrix2d A = B.inverse() * J;
+
+    // A 的最大奇异值
+    const Eigen::Matrix2d AAt = A * A.transpose();
+    const double d            = AAt(0, 0) - AAt(1, 1);
+    const double gamma2       = 0.5 * (AAt(0, 0) + AAt(1, 1) + std::sqrt(d * d + 4 * AAt(0, 1) * AAt(0, 1)));
+    const double gamma        = std::sqrt(gamma2);
+    if (!(gamma > std::numeric_limits<float>::epsilon()))
+        return false;
+
+    //* 旋转矩阵的左上 2x2 为 A / gamma，第三行的两个元素由列向量为单位向量、相互正交确定，符号有两种取法
+    const Eigen::Matrix2d r = A / gamma;
+    const double b0         = std::sqrt(std::max(0.0, 1 - r(0, 0) * r(0, 0) - r(1, 0) * r(1, 0)));
+    double b1               = std::sqrt(std::max(0.0, 1 - r(0, 1) * r(0, 1) - r(1, 1) * r(1, 1)));
+    if (r(0, 0) * r(0, 1) + r(1, 0) * r(1, 1) > 0)
+        b1 = -b1;
+
+    auto compose = [&](double s, Eigen::Matrix3d &R) {
+        const Eigen::Vector3d c0(r(0, 0), r(1, 0), s * b0);
+        const Eigen::Vector3d c1(r(0, 1), r(1, 1), s * b1);
+        Eigen::Matrix3d Rt;
+        Rt << c0, c1, c0.cross(c1);
+        R = Rv * Rt;
+    };
+    compose(1, R1);
+    compose(-1, R2);
+    return true;
+}
+
+/**
+ * @brief 已知旋转时，按代数误差最小二乘求平移
+ */
+Eigen::Vector3d solve_translation(
+    const AutoAim::ArmorTemplate &model, const std::array<Eigen::Vector2d, 4> &image, const Eigen::Matrix3d &R
+) {
+    Eigen::Matrix3d AtA = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d Atb = Eigen::Vector3d::Zero();
+    for (int i = 0; i < 4; ++i) {
+        const Eigen::Vector3d P = R.col(0) * model.corners[i][0] + R.col(1) * model.corners[i][1];
+        const double u = image[i].x(), v = image[i].y();
+        // (P.x + tx) - u (P.z + tz) = 0, (P.y + ty) - v (P.z + tz) = 0
+        const Eigen::Vector3d a0(1, 0, -u), a1(0, 1, -v);
+        AtA += a0 * a0.transpose() + a1 * a1.transpose();
+        Atb += a0 * (u * P.z() - P.x()) + a1 * (v * P.z() - P.y());
+    }
+    return AtA.ldlt().solve(Atb);
+}
+
+/**
+ * @brief 去畸变后像素坐标下四个角点的 RMS 重投影误差，有角点在相机后方时为无穷大
+ */
+double reprojection_error(
+    const AutoAim::ArmorTemplate &model,
+    const std::array<Eigen::Vector2d, 4> &image,
+    const Eigen::Matrix3d &R,
+    const Eigen::Vector3d &t,
+    double fx,
+    double fy
+) {
+    double error = 0;
+    for (int i = 0; i < 4; ++i) {
+        const Eigen::Vector3d P = R * Eigen::Vector3d(model.corners[i][0], model.corners[i][1], 0) + t;
+        if (P.z() <= 0)
+            return std::numeric_limits<double>::infinity();
+        const double du = fx * (P.x() / P.z() - image[i].x());
+        const double dv = fy * (P.y() / P.z() - image[i].y());
+        error += du * du + dv * dv;
+    }
+    return std::sqrt(error / 4);
+}
+
+cv::Vec3d to_rvec(const Eigen::Matrix3d &R) {
+    const Eigen::AngleAxisd rotation(R);
+    const Eigen::Vector3d rvec = rotation.angle() * rotation.axis();
+    return {rvec.x(), rvec.y(), rvec.z()};
+}
+
+Eigen::Matrix3d from_rvec(const cv::Vec3d &rvec) {
+    const Eigen::Vector3d axis(rvec[0], rvec[1], rvec[2]);
+    const double theta = axis.norm();
+    if (theta < 1e-12)
+        return Eigen::Matrix3d::Identity();
+    return Eigen::AngleAxisd(theta, axis / theta).toRotationMatrix();
+}
+
+/**
+ * @brief 用 Cholesky 分解解对称正定的 6x6 方程组，比 Eigen::LDLT 的通用实现快数倍
+ * @return 矩阵是否正定
+ */
+bool cholesky_solve(Eigen::Matrix<double, 6, 6> A, Eigen::Matrix<double, 6, 1> &x) {
+    for (int j = 0; j < 6; ++j) {
+        double d = A(j, j);
+        for (int k = 0; k < j; ++k)
+            d -= A(j, k) * A(j, k);
+        if (!(d > 0))
+            return false;
+        A(j, j) = std::sqrt(d);
+        for (int i = j + 1; i < 6; ++i) {
+            double s = A(i, j);
+            for (int k = 0; k < j; ++k)
+                s -= A(i, k) * A(j, k);
+            A(i, j) = s / A(j, j);
+        }
+    }
+    // L y = b, L^T x = y
+    for (int i = 0; i < 6; ++i) {
+        for (int k = 0; k < i; ++k)
+            x(i) -= A(i, k) * x(k);
+        x(i) /= A(i, i);
+    }
+    for (int i = 5; i >= 0; --i) {
+        for (int k = i + 1; k < 6; ++k)
+            x(i) -= A(k, i) * x(k);
+        x(i) /= A(i, i);
+    }
+    return true;
+}
+
+bool armor_corners(const AutoAim::Armor &armor, std::array<cv::Point2f, 4> &corners) {
+    if (armor.vertices.size() != 4)
+        return false;
+    std::copy(armor.vertices.begin(), armor.vertices.end(), corners.begin());
+    return true;
+}
+
+} // namespace
+
+AutoAim::PlanarPnP::PlanarPnP(const cv::Mat &camera_matrix, const cv::Mat &dist_coeffs) {
+    CV_Assert(camera_matrix.total() == 9);
+    cv::Mat K;
+    camera_matrix.convertTo(K, CV_64F);
+    K   = K.reshape(1, 3);
+    fx_ = K.at<double>(0, 0);
+    fy_ = K.at<double>(1, 1);
+    cx_ = K.at<double>(0, 2);
+    cy_ = K.at<double>(1, 2);
+
+    if (!dist_coeffs.empty()) {
+        cv::Mat D;
+        dist_coeffs.convertTo(D, CV_64F);
+        D = D.reshape(1, 1);
+        for (int i = 0; i < int(dist_.size()) && i < D.cols; ++i) {
+            dist_[i] = D.at<double>(i);
+            distorted_ |= dist_[i] != 0;
+        }
+    }
+}
+
+Eigen::Vector2d AutoAim::PlanarPnP::undistort(const cv::Point2f &pixel) const {
+    const double x0 = (pixel.x - cx_) / fx_;
+    const double y0 = (pixel.y - cy_) / fy_;
+    if (!distorted_)
+        return {x0, y0};
+
+    // 与 cv::undistortPoints 相同的不动点迭代
+    const auto [k1, k2, p1, p2, k3] = dist_;
+    double x = x0, y = y0;
+    for (int i = 0; i < undistort_iterations; ++i) {
+        const double r2     = x * x + y * y;
+        const double icdist = 1 / (1 + ((k3 * r2 + k2) * r2 + k1) * r2);
+        const double dx     = 2 * p1 * x * y + p2 * (r2 + 2 * x * x);
+        const double dy     = p1 * (r2 + 2 * y * y) + 2 * p2 * x * y;
+        x                   = (x0 - dx) * icdist;
+        y                   = (y0 - dy) * icdist;
+    }
+    return {x, y};
+}
+
+bool AutoAim::PlanarPnP::solve(
+    const ArmorTemplate &model, const std::array<cv::Point2f, 4> &corners, PlanarPnPResult &result
+) const {
+    result.valid = false;
+
+    std::array<Eigen::Vector2d, 4> image;
+    for (int i = 0; i < 4; ++i)
+        image[i] = undistort(corners[i]);
+
+    //* 模板平面 -> 归一化图像的单应矩阵（h22 = 1）。模板坐标除以半宽、半高，使方程组的条件数较好
+    Eigen::Matrix<double, 8, 8> A;
+    Eigen::Matrix<double, 8, 1> b;
+    for (int i = 0; i < 4; ++i) {
+        const double x = model.corners[i][0] / model.half_width;
+        const double y = model.corners[i][1] / model.half_height;
+        const double u = image[i].x(), v = image[i].y();
+        A.row(2 * i) << x, y, 1, 0, 0, 0, -u * x, -u * y;
+        A.row(2 * i + 1) << 0, 0, 0, x, y, 1, -v * x, -v * y;
+        b(2 * i)     = u;
+        b(2 * i + 1) = v;
+    }
+    const Eigen::FullPivLU<Eigen::Matrix<double, 8, 8>> lu(A);
+    if (!lu.isInvertible())
+        return false;
+    const Eigen::Matrix<double, 8, 1> h = lu.solve(b);
+
+    //* 单应矩阵在模板原点处的雅可比，换回 mm 为单位的模板坐标
+    const Eigen::Vector2d v(h(2), h(5));
+    Eigen::Matrix2d J;
+    J << (h(0) - h(6) * v.x()) / model.half_width, (h(1) - h(7) * v.x()) / model.half_height,
+        (h(3) - h(6) * v.y()) / model.half_width, (h(4) - h(7) * v.y()) / model.half_height;
+
+    Eigen::Matrix3d R[2];
+    if (!ippe_rotations(J, v, R[0], R[1]))
+        return false;
+
+    for (int k = 0; k < 2; ++k) {
+        const Eigen::Vector3d t = solve_translation(model, image, R[k]);
+        result.poses[k].rvec    = to_rvec(R[k]);
+        result.poses[k].tvec    = {t.x(), t.y(), t.z()};
+        result.poses[k].error   = reprojection_error(model, image, R[k], t, fx_, fy_);
+    }
+    if (result.poses[1].error < result.poses[0].error)
+        std::swap(result.poses[0], result.poses[1]);
+
+    result.valid = std::isfinite(result.poses[0].error);
+    return result.valid;
+}
+
+bool AutoAim::PlanarPnP::solve(const Armor &armor, PlanarPnPResult &result) const {
+    std::array<cv::Point2f, 4> corners;
+    if (!armor_corners(armor, corners)) {
+        result.valid = false;
+        return false;
+    }
+    return solve(armor_template(armor.type), corners, result);
+}
+
+void AutoAim::PlanarPnP::solve(std::span<const Armor> armors, std::span<PlanarPnPResult> results) const {
+    CV_Assert(results.size() >= armors.size());
+    for (size_t i = 0; i < armors.size(); ++i)
+        solve(armors[i], results[i]);
+}
+
+bool AutoAim::PlanarPnP::refine(
+    const ArmorTemplate &model, const std::array<cv::Point2f, 4> &corners, PlanarPose &pose, int iterations
+) const {
+    std::array<Eigen::Vector2d, 4> image;
+    for (int i = 0; i < 4; ++i)
+        image[i] = undistort(corners[i]);
+
+    Eigen::Matrix3d R = from_rvec(pose.rvec);
+    Eigen::Vector3d t(pose.tvec[0], pose.tvec[1], pose.tvec[2]);
+    Eigen::Matrix<double, 6, 6> JtJ;
+    Eigen::Matrix<double, 6, 1> Jtr;
+    double error = linearize(model, image, R, t, JtJ, Jtr);
+    if (!std::isfinite(error)) {
+        pose.error = error;
+        return false;
+    }
+
+    //* Levenberg-Marquardt，增量为 R <- exp(w) R, t <- t + dt。误差不下降时增大阻尼重试
+    double lambda = 1e-4;
+    for (int iter = 0; iter < iterations && lambda < 1e4; ++iter) {
+        Eigen::Matrix<double, 6, 6> H = JtJ;
+        H.diagonal() *= 1 + lambda;
+        Eigen::Matrix<double, 6, 1> delta = -Jtr;
+        if (!cholesky_solve(H, delta)) {
+            lambda *= 10;
+            continue;
+        }
+
+        const Eigen::Vector3d w = delta.head<3>();
+        const double angle      = w.norm();
+        const Eigen::Matrix3d R_new = angle > 1e-12 ? Eigen::Matrix3d(Eigen::AngleAxisd(angle, w / angle) * R) : R;
+        const Eigen::Vector3d t_new = t + delta.tail<3>();
+
+        Eigen::Matrix<double, 6, 6> JtJ_new;
+        Eigen::Matrix<double, 6, 1> Jtr_new;
+        const double error_new = linearize(model, image, R_new, t_new, JtJ_new, Jtr_new);
+        if (!(error_new < error)) {
+            lambda *= 10;
+            continue;
+        }
+
+        const bool converged = error - error_new < 1e-3 * error;
+        R                    = R_new;
+        t                    = t_new;
+        JtJ                  = JtJ_new;
+        Jtr                  = Jtr_new;
+        error                = error_new;
+        lambda               = std::max(lambda / 10, 1e-7);
+        if (converged)
+            break;
+    }
+
+    pose.rvec  = to_rvec(R);
+    pose.tvec  = {t.x(), t.y(), t.z()};
+    pose.error = error;
+    return true;
+}
+
+double AutoAim::PlanarPnP::linearize(
+    const ArmorTemplate &model,
+    const std::array<Eigen::Vector2d, 4> &image,
+    const Eigen::Matrix3d &R,
+    const Eigen::Vector3d &t,
+    Eigen::Matrix<double, 6, 6> &JtJ,
+    Eigen::Matrix<double, 6, 1> &Jtr
+) const {
+    JtJ.setZero();
+    Jtr.setZero();
+    double error = 0;
+    for (int i = 0; i < 4; ++i) {
+        const Eigen::Vector3d X = R * Eigen::Vector3d(model.corners[i][0], model.corners[i][1], 0);
+        const Eigen::Vector3d P = X + t;
+        if (P.z() <= 0)
+            return std::numeric_limits<double>::infinity();
+        const double iz = 1 / P.z();
+        const Eigen::Vector2d r(fx_ * (P.x() * iz - image[i].x()), fy_ * (P.y() * iz - image[i].y()));
+        error += r.squaredNorm();
+
+        // 投影对相机系坐标的偏导为 [a 0 b; 0 c d]，相机系坐标对 (w, dt) 的偏导为 [-[X]x I]，两者相乘
+        const double a = fx_ * iz, b = -fx_ * P.x() * iz * iz;
+        const double c = fy_ * iz, d = -fy_ * P.y() * iz * iz;
+        Eigen::Matrix<double, 6, 1> ju, jv;
+        ju << b * X.y(), a * X.z() - b * X.x(), -a * X.y(), a, 0, b;
+        jv << d * X.y() - c * X.z(), -d * X.x(), c * X.x(), 0, c, d;
+        JtJ.noalias() += ju * ju.transpose() + jv * jv.transpose();
+        Jtr.noalias() += ju * r.x() + jv * r.y();
+    }
+    return std::sqrt(error / 4);
+}
+
+bool AutoAim::PlanarPnP::refine(const Armor &armor, PlanarPose &pose, int iterations) const {
+    std::array<cv::Point2f, 4> corners;
+    if (!armor_corners(armor, corners))
+        return false;
+    return refine(armor_template(armor.type), corners, pose, iterations);
+}
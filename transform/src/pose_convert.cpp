@@ -14,26 +14,40 @@
 // implementation of poses
 // ========================================================
 
-void pose_under_camera_coord::load_from_imu(const IMUInfo &imu, const cv::Mat &T_camera_to_barrel) {
+void pose_under_camera_coord::load_from_imu(const IMUInfo &imu, const cv::Vec3d &T_camera_to_barrel) {
     this->tvec /= 1000; // convert to meters
 
     this->center_3d = this->tvec + T_camera_to_barrel;
     this->distance  = cv::norm(this->center_3d);
 
-    this->roll  = std::atan2(this->center_3d.at<double>(1), this->center_3d.at<double>(0)) * kRadianToDegree;
-    this->pitch = std::atan2(this->center_3d.at<double>(1), this->center_3d.at<double>(2)) * kRadianToDegree;
-    this->yaw   = -std::atan2(this->center_3d.at<double>(0), this->center_3d.at<double>(2)) * kRadianToDegree;
+    this->roll  = std::atan2(this->center_3d[1], this->center_3d[0]) * kRadianToDegree;
+    this->pitch = std::atan2(this->center_3d[1], this->center_3d[2]) * kRadianToDegree;
+    this->yaw   = -std::atan2(this->center_3d[0], this->center_3d[2]) * kRadianToDegree;
 
-    cv::Mat R;
-    cv::Rodrigues(this->rvec, R);
-    R               = R.t();
-    this->direction = std::atan2(R.at<double>(1, 0), R.at<double>(0, 0)) * kRadianToDegree;
+    // R^T 的 (1, 0) 元素即 R 的 (0, 1) 元素
+    const Eigen::Matrix3d R = Transform::Functions::get_rotation_from_rvec(this->rvec);
+    this->direction         = std::atan2(R(0, 1), R(0, 0)) * kRadianToDegree;
 }
 
 // ========================================================
 // implementation of PoseConvert
 // ========================================================
 
+namespace {
+
+/**
+ * @brief 复制装甲板类型、标签、时间戳与 IMU 姿态（Armor3d 继承自 AnnotatedArmorInfo 的字段）
+ * @remark 这些字段都可以平凡复制；角点数组会分配堆内存，不复制
+ */
+void copy_annotation(const AnnotatedArmorInfo &info, Armor3d &result) {
+    result.armor.type = info.armor.type;
+    result.result     = info.result;
+    result.imu_info   = info.imu_info;
+    result.timestamp  = info.timestamp;
+}
+
+} // namespace
+
 AutoAim::PoseConvert::PoseConvert(const std::string &cfg_path) {
     this->log_ = spdlog::stdout_color_mt("PoseConvert");
     this->log_->set_level(spdlog::level::trace);
@@ -44,97 +58,150 @@ AutoAim::PoseConvert::PoseConvert(const std::string &cfg_path) {
         auto config = toml::parse_file(cfg_path);
         SPDLOG_LOGGER_INFO(this->log_, "config file loaded");
 
-        auto F = [&](const std::string &_s, cv::Mat &_res) {
-            auto cam2barrel = config[_s];
+        auto F = [&](const std::string &_s, cv::Vec3d &_res) {
+            SPDLOG_LOGGER_INFO(this->log_, "initializing {}", _s);
+            if (const auto *arr = config[_s].as_array()) {
+                for (int i = 0; i < 3 && i < int(arr->size()); ++i)
+                    _res[i] = (*arr)[i].value_or(0.0);
+            }
+            SPDLOG_LOGGER_INFO(this->log_, "{} has been initialized", _s);
+        };
+        auto M = [&](const std::string &_s, cv::Mat &_res, int rows) {
             std::vector<double> data;
             SPDLOG_LOGGER_INFO(this->log_, "initializing {}", _s);
-            if (const auto *arr = cam2barrel.as_array()) {
+            if (const auto *arr = config[_s].as_array()) {
                 for (const auto &elem : *arr)
-                    data.push_back(elem.as_floating_point()->get());
+                    data.push_back(elem.value_or(0.0));
             }
-            _res = cv::Mat(data, true).reshape(3, 1);
+            _res = cv::Mat(data, true).reshape(1, rows);
             SPDLOG_LOGGER_INFO(this->log_, "{} has been initialized", _s);
         };
+        M("cameraMatrix", this->camera_matrix, 3);
+        M("distCoeffs", this->dist_coeffs, 1);
+        this->pnp_ = PlanarPnP(this->camera_matrix, this->dist_coeffs);
         F("cameraToBarrel", this->T_camera_to_barrel);
-        F("cameraToIMU", this->T_camera_to_imu);
-        cv::Mat R;
+        cv::Vec3d T, R;
+        F("cameraToIMU", T);
         F("cameraToIMURotation", R);
-        this->R_camera_to_imu = Transform::Functions::get_rotation_matrix(
-            R.at<double>(0, 0) * kDegreeToRadian,
-            R.at<double>(1, 0) * kDegreeToRadian,
-            R.at<double>(2, 0) * kDegreeToRadian
+
+        //* 静态外参只计算一次，之后每个装甲板直接使用
+        const Eigen::Matrix3d R_camera_to_imu = Transform::Functions::get_rotation_matrix_3d(
+            R[0] * kDegreeToRadian, R[1] * kDegreeToRadian, R[2] * kDegreeToRadian
+        );
+        this->camera_to_imu = Transform::Functions::get_isometry_from_rotation_translation(
+            R_camera_to_imu.transpose(), Eigen::Vector3d{T[0], T[1], T[2]}
         );
 
+        this->warm_start_max_error = config["warmStartMaxError"].value_or(1.0);
+
     } catch (const std::exception &e) {
         SPDLOG_LOGGER_CRITICAL(this->log_, "failed to init pose transformer: {}", e.what());
     }
 }
 
-Armor3d AutoAim::PoseConvert::solve_absolute(const AnnotatedArmorInfo &info) {
+Armor3d AutoAim::PoseConvert::solve_absolute(const AnnotatedArmorInfo &info) const {
     Armor3d result;
+    this->solve_absolute(info, result);
+    return result;
+}
 
-    //^ solvepnp
-    std::vector<cv::Point3f> projected_points;
-    if (info.armor.type == ArmorType::Large) {
-        projected_points = {
-            cv::Point3f(-LargeArmorWidth / 2, -LargeArmorHeight / 2, 0),
-            cv::Point3f(LargeArmorWidth / 2, -LargeArmorHeight / 2, 0),
-            cv::Point3f(LargeArmorWidth / 2, LargeArmorHeight / 2, 0),
-            cv::Point3f(-LargeArmorWidth / 2, LargeArmorHeight / 2, 0),
-        };
-    } else if (info.armor.type == ArmorType::Small) {
-        projected_points = {
-            cv::Point3f(-SmallArmorWidth / 2, -SmallArmorHeight / 2, 0),
-            cv::Point3f(SmallArmorWidth / 2, -SmallArmorHeight / 2, 0),
-            cv::Point3f(SmallArmorWidth / 2, SmallArmorHeight / 2, 0),
-            cv::Point3f(-SmallArmorWidth / 2, SmallArmorHeight / 2, 0),
-        };
+void AutoAim::PoseConvert::solve_absolute(const AnnotatedArmorInfo &info, Armor3d &result) const {
+    //^ pnp, 闭式解，取重投影误差较小的解
+    PlanarPnPResult pnp;
+    if (!this->pnp_.solve(info.armor, pnp)) {
+        SPDLOG_LOGGER_WARN(this->log_, "pnp failed on armor with {} vertices", info.armor.vertices.size());
+        result = Armor3d{};
+        return;
     }
-    cv::solvePnP(
-        projected_points,
-        info.armor.vertices,
-        camera_matrix,
-        dist_coeffs,
-        result.p_a2c.rvec,
-        result.p_a2c.tvec,
-        cv::SOLVEPNP_IPPE
-    );
+    copy_annotation(info, result);
+    result.p_a2c.rvec = pnp.poses[0].rvec;
+    result.p_a2c.tvec = pnp.poses[0].tvec;
+
+    this->solve_from_pnp(info.imu_info, result);
+}
+
+void AutoAim::PoseConvert::solve_absolute(
+    const std::vector<AnnotatedArmorInfo> &armors, std::vector<Armor3d> &results
+) const {
+    results.resize(armors.size());
+    for (size_t i = 0; i < armors.size(); ++i)
+        this->solve_absolute(armors[i], results[i]);
+}
+
+void AutoAim::PoseConvert::solve_absolute(const AnnotatedArmorInfo &info, const Armor3d &prior, Armor3d &result) const {
+    if (prior.p_a2c.tvec[2] <= 0 || prior.armor.type != info.armor.type) {
+        this->solve_absolute(info, result);
+        return;
+    }
+
+    //^ 把初值的 armor -> barrel 位姿按当前 IMU 姿态转换为 armor -> camera 位姿，作为迭代初值
+    PlanarPose pose = this->camera_pose_of(prior, info.imu_info);
+
+    //^ 初值在相机后方或迭代后误差过大（目标切换、预测偏差大）时退回闭式解
+    this->warm_start_stats_.attempts++;
+    if (!this->pnp_.refine(info.armor, pose) || !(pose.error <= this->warm_start_max_error)) {
+        if constexpr (PoseConvertDebug) {
+            SPDLOG_LOGGER_DEBUG(this->log_, "warm start rejected, reprojection error {}", pose.error);
+        }
+        this->solve_absolute(info, result);
+        return;
+    }
+    this->warm_start_stats_.accepted++;
+    copy_annotation(info, result);
+    result.p_a2c.rvec = pose.rvec;
+    result.p_a2c.tvec = pose.tvec;
 
+    this->solve_from_pnp(info.imu_info, result);
+}
+
+void AutoAim::PoseConvert::solve_absolute(
+    const std::vector<AnnotatedArmorInfo> &armors,
+    const std::vector<const Armor3d *> &priors,
+    std::vector<Armor3d> &results
+) const {
+    results.resize(armors.size());
+    for (size_t i = 0; i < armors.size(); ++i) {
+        if (i < priors.size() && priors[i])
+            this->solve_absolute(armors[i], *priors[i], results[i]);
+        else
+            this->solve_absolute(armors[i], results[i]);
+    }
+}
+
+void AutoAim::PoseConvert::solve_from_pnp(const IMUInfo &imu, Armor3d &result) const {
     //* solve relative pose
-    result.p_a2c.load_from_imu(info.imu_info, this->T_camera_to_barrel);
+    result.p_a2c.load_from_imu(imu, this->T_camera_to_barrel);
 
-    cv::Mat armor_to_barrel =                     // solving coord tf
-        this->from_base_to_barrel() *             // base --> barrel
-        this->from_imu_to_base(info.imu_info) *   // imu --> base
-        this->from_camera_to_imu() *              // camera --> imu
+    const Eigen::Isometry3d armor_to_barrel =     // solving coord tf
+        this->from_camera_to_barrel(imu) *        // camera --> imu --> base --> barrel
         this->from_armor_to_camera(result.p_a2c); // armor --> camera
 
     //* solve absolute pose
-    std::tie(result.R_armor_to_barrel, result.T_armor_to_barrel)
-        = Transform::Functions::get_rotation_translation_from_homography_matrix(armor_to_barrel, false);
+    for (int i = 0; i < 3; ++i) {
+        result.T_armor_to_barrel[i] = armor_to_barrel.translation()(i);
+        for (int j = 0; j < 3; ++j)
+            result.R_armor_to_barrel(i, j) = armor_to_barrel.linear()(i, j);
+    }
+
+    // fill in data fields
+    result.p_barrel.center_3d = result.T_armor_to_barrel;
+    result.p_barrel.distance  = cv::norm(result.p_barrel.center_3d);
+    result.p_barrel.direction
+        = std::atan2(result.R_armor_to_barrel(1, 0), result.R_armor_to_barrel(0, 0)) * kRadianToDegree;
 
     if constexpr (PoseConvertDebug) {
         SPDLOG_LOGGER_INFO(
             this->log_,
             "armor center under barrel: ({},{},{})",
-            result.p_barrel.center_3d.at<double>(0),
-            result.p_barrel.center_3d.at<double>(1),
-            result.p_barrel.center_3d.at<double>(2)
+            result.p_barrel.center_3d[0],
+            result.p_barrel.center_3d[1],
+            result.p_barrel.center_3d[2]
         );
     }
 
-    // fill in data fields
-    result.p_barrel.center_3d = result.T_armor_to_barrel;
-    result.p_barrel.distance  = cv::norm(result.p_barrel.center_3d);
-    result.p_barrel.direction
-        = std::atan2(result.R_armor_to_barrel.at<double>(1, 0), result.R_armor_to_barrel.at<double>(0, 0))
-        * kRadianToDegree;
-
-    result.p_barrel.roll = std::atan2(result.p_barrel.center_3d.at<double>(2), result.p_barrel.center_3d.at<double>(1))
-                         * kRadianToDegree;
-    result.p_barrel.pitch = info.imu_info.pitch + result.p_a2c.pitch;
-    result.p_barrel.yaw   = std::atan2(result.p_barrel.center_3d.at<double>(1), result.p_barrel.center_3d.at<double>(0))
-                        * kRadianToDegree;
+    result.p_barrel.roll  = std::atan2(result.p_barrel.center_3d[2], result.p_barrel.center_3d[1]) * kRadianToDegree;
+    result.p_barrel.pitch = imu.pitch + result.p_a2c.pitch;
+    result.p_barrel.yaw   = std::atan2(result.p_barrel.center_3d[1], result.p_barrel.center_3d[0]) * kRadianToDegree;
 
     //* relative pitch and yaw to barrel
     // pitch, yaw 用 armor->camera 近似 armor->barrel
@@ -142,41 +209,76 @@ Armor3d AutoAim::PoseConvert::solve_absolute(const AnnotatedArmorInfo &info) {
     result.yaw_relative_to_barrel   = result.p_a2c.yaw;
 
     //* bullet flying time
-    double imu_pitch = info.imu_info.pitch * kDegreeToRadian;
-    double pnp_pitch = std::atan2(result.p_barrel.center_3d.at<double>(1), result.p_barrel.center_3d.at<double>(2));
+    double imu_pitch = imu.pitch * kDegreeToRadian;
+    double pnp_pitch = std::atan2(result.p_barrel.center_3d[1], result.p_barrel.center_3d[2]);
     result.bullet_flying_time = result.p_barrel.distance * std::cos(std::abs(imu_pitch) - std::abs(pnp_pitch))
                               / (bullet_velosity * std::cos(imu_pitch));
 
     if constexpr (PoseConvertDebug) {
         SPDLOG_LOGGER_INFO(this->log_, "estimated bullet flying time: {}", result.bullet_flying_time);
     }
+}
 
-    return result;
+cv::Rect AutoAim::PoseConvert::project_to_image(const Armor3d &armor) const {
+    if (armor.p_a2c.tvec[2] <= 0 || this->camera_matrix.empty())
+        return {};
+    const PlanarPose pose = this->camera_pose_of(armor, armor.imu_info);
+    if (pose.tvec[2] <= 0)
+        return {};
+
+    const double w = armor.armor.type == ArmorType::Large ? LargeArmorWidth : SmallArmorWidth;
+    const double h = armor.armor.type == ArmorType::Large ? LargeArmorHeight : SmallArmorHeight;
+    std::vector<cv::Point3f> corners = {
+        cv::Point3f(-w / 2, -h / 2, 0),
+        cv::Point3f(w / 2, -h / 2, 0),
+        cv::Point3f(w / 2, h / 2, 0),
+        cv::Point3f(-w / 2, h / 2, 0),
+    };
+
+    std::vector<cv::Point2f> projected;
+    cv::projectPoints(corners, pose.rvec, pose.tvec, camera_matrix, dist_coeffs, projected);
+    return cv::boundingRect(projected);
 }
 
-cv::Mat AutoAim::PoseConvert::from_armor_to_camera(const pose_under_camera_coord &relative) {
-    cv::Mat armor_to_camera
-        = Transform::Functions::get_homography_matrix_from_rotation_translation(relative.rvec, relative.tvec);
-    return armor_to_camera;
+AutoAim::PlanarPose AutoAim::PoseConvert::camera_pose_of(const Armor3d &armor, const IMUInfo &imu) const {
+    Eigen::Matrix3d R;
+    Eigen::Vector3d T;
+    for (int i = 0; i < 3; ++i) {
+        T(i) = armor.T_armor_to_barrel[i];
+        for (int j = 0; j < 3; ++j)
+            R(i, j) = armor.R_armor_to_barrel(i, j);
+    }
+    const Eigen::Isometry3d armor_to_camera
+        = this->from_camera_to_barrel(imu).inverse()
+        * Transform::Functions::get_isometry_from_rotation_translation(R, T);
+
+    const Eigen::AngleAxisd rotation(armor_to_camera.linear());
+    const Eigen::Vector3d rvec = rotation.angle() * rotation.axis();
+    const Eigen::Vector3d tvec = armor_to_camera.translation() * 1000; // mm
+    return {{rvec.x(), rvec.y(), rvec.z()}, {tvec.x(), tvec.y(), tvec.z()}, 0};
 }
 
-cv::Mat AutoAim::PoseConvert::from_camera_to_imu() {
-    cv::Mat camera_to_imu = Transform::Functions::get_homography_matrix_from_rotation_translation(
-        this->R_camera_to_imu.t(), this->T_camera_to_imu
+Eigen::Isometry3d AutoAim::PoseConvert::from_armor_to_camera(const pose_under_camera_coord &relative) const {
+    return Transform::Functions::get_isometry_from_rotation_translation(
+        Transform::Functions::get_rotation_from_rvec(relative.rvec),
+        Eigen::Vector3d{relative.tvec[0], relative.tvec[1], relative.tvec[2]}
     );
-    return camera_to_imu;
 }
 
-cv::Mat AutoAim::PoseConvert::from_imu_to_base(const IMUInfo &imu) {
-    cv::Mat imu_to_base = Transform::Functions::get_homography_matrix_from_rotation_translation(
-        imu.rotation(), cv::Mat::zeros(3, 1, CV_64F)
+Eigen::Isometry3d AutoAim::PoseConvert::from_imu_to_base(const IMUInfo &imu) const {
+    // 与 IMUInfo::rotation() 相同，imu 系相对 base 系只有旋转
+    return Transform::Functions::get_isometry_from_rotation_translation(
+        Transform::Functions::get_rotation_matrix_3d(
+            Transform::Functions::deg_to_rad(imu.roll),
+            Transform::Functions::deg_to_rad(imu.pitch),
+            Transform::Functions::deg_to_rad(imu.yaw)
+        ),
+        Eigen::Vector3d::Zero()
     );
-    return imu_to_base;
 }
 
-cv::Mat AutoAim::PoseConvert::from_base_to_barrel() {
-    cv::Mat base_to_barrel = Transform::Functions::get_homography_matrix_from_rotation_translation(
-        this->R_base_to_barrel, this->T_base_to_barrel
-    );
-    return base_to_barrel;
-}
\ No newline at end of file
+Eigen::Isometry3d AutoAim::PoseConvert::from_camera_to_barrel(const IMUInfo &imu) const {
+    return this->base_to_barrel *        // base --> barrel
+           this->from_imu_to_base(imu) * // imu --> base
+           this->camera_to_imu;          // camera --> imu
+}
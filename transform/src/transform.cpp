@@ -121,6 +121,31 @@ cv::Mat Transform::Functions::get_rotation_matrix(const double &rx, const double
     return rotate_around_x(rz) * rotate_around_y(ry) * rotate_around_z(rx);
 }
 
+Eigen::Isometry3d Transform::Functions::get_isometry_from_rotation_translation(
+    const Eigen::Matrix3d &rotation, const Eigen::Vector3d &translation
+) {
+    Eigen::Isometry3d H{Eigen::Isometry3d::Identity()};
+    H.linear()      = rotation;
+    H.translation() = translation;
+    return H;
+}
+
+Eigen::Matrix3d Transform::Functions::get_rotation_from_rvec(const cv::Vec3d &rvec) {
+    const Eigen::Vector3d axis{rvec[0], rvec[1], rvec[2]};
+    const double theta = axis.norm();
+    if (theta < 1e-12)
+        return Eigen::Matrix3d::Identity();
+    return Eigen::AngleAxisd(theta, axis / theta).toRotationMatrix();
+}
+
+Eigen::Matrix3d Transform::Functions::get_rotation_matrix_3d(const double &rx, const double &ry, const double &rz) {
+    // 与 rotate_around_* 相同，各角度乘以 kDegreeToRadian 后绕对应轴旋转
+    return (Eigen::AngleAxisd(rz * kDegreeToRadian, Eigen::Vector3d::UnitX())
+            * Eigen::AngleAxisd(ry * kDegreeToRadian, Eigen::Vector3d::UnitY())
+            * Eigen::AngleAxisd(rx * kDegreeToRadian, Eigen::Vector3d::UnitZ()))
+        .toRotationMatrix();
+}
+
 // ========================================================
 // Implement for Coordinate Manager
 // ========================================================
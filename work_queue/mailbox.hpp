@@ -0,0 +1,107 @@
+/**
+ * @file mailbox.hpp
+ * @author arca
+ * @brief Latest-value channel (triple buffer) between two pipeline stages.
+ * @version 0.1
+ * @date 2025-03-05
+ */
+
+#ifndef __MAILBOX_HPP__
+#define __MAILBOX_HPP__
+
+#include "parker.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <utility>
+
+/**
+ * @brief 单写单读的“信箱”：写端总是覆盖，读端总是拿到最新值，两端都不阻塞
+ * @details 三缓冲实现。写端写 back 槽，读端读 front 槽，中间槽通过一次原子交换在两端之间传递。
+ * 读端来不及取走的值会被新值覆盖，并计入 dropped()。
+ * 适合下游只关心最新数据的环节（相机 -> 识别，跟踪 -> 开火），保证过载时延迟有上界。
+ *
+ * @tparam T 数据类型，需要可移动
+ */
+template <typename T>
+class Mailbox {
+  public:
+    Mailbox() = default;
+
+    Mailbox(const Mailbox &)            = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+
+    /**
+     * @brief 写入新值。写端专用
+     */
+    void write(T &&value) {
+        slots_[back_].value = std::move(value);
+        uint8_t prev        = state_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+        back_               = prev & kIndexMask;
+
+        if (prev & kFresh)
+            dropped_.fetch_add(1, std::memory_order_relaxed); // 上一个值没被读走
+        written_.fetch_add(1, std::memory_order_relaxed);
+        parker_.notify();
+    }
+
+    void write(const T &value) { write(T(value)); }
+
+    /**
+     * @brief 取走最新值；没有新值时返回 std::nullopt。读端专用
+     */
+    std::optional<T> take() {
+        if (!(state_.load(std::memory_order_relaxed) & kFresh))
+            return std::nullopt;
+        uint8_t prev = state_.exchange(front_, std::memory_order_acq_rel);
+        front_       = prev & kIndexMask;
+        return std::make_optional(std::move(slots_[front_].value));
+    }
+
+    /**
+     * @brief 阻塞直到有新值。读端专用
+     */
+    T take_wait() { return parker_.wait_for(policy_, [this] { return take(); }, std::chrono::nanoseconds(-1)).value(); }
+
+    /**
+     * @brief 最多等待 timeout，超时返回 std::nullopt。读端专用
+     */
+    template <typename Rep, typename Period>
+    std::optional<T> take_wait_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return parker_.wait_for(
+            policy_, [this] { return take(); }, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)
+        );
+    }
+
+    void set_parking_policy(const ParkingPolicy &policy) { policy_ = policy; }
+
+    // 是否有未读的新值
+    bool has_fresh() const { return state_.load(std::memory_order_acquire) & kFresh; }
+
+    // 被覆盖（未被读端取走）的值的数量
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // 写入的值的总数
+    uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+  private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh     = 0x4;
+
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    Slot slots_[3];
+    uint8_t back_{0};                           // 写端独占
+    uint8_t front_{2};                          // 读端独占
+    alignas(64) std::atomic<uint8_t> state_{1}; // 中间槽下标 | kFresh
+
+    std::atomic<uint64_t> dropped_{0}, written_{0};
+    Parker parker_;
+    ParkingPolicy policy_;
+};
+
+#endif // __MAILBOX_HPP__
@@ -0,0 +1,129 @@
+/**
+ * @file parker.hpp
+ * @author arca
+ * @brief Spin-then-park primitive used by blocking pops.
+ * @version 0.1
+ * @date 2025-03-04
+ */
+
+#ifndef __PARKER_HPP__
+#define __PARKER_HPP__
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief 等待策略：先忙等 spin_count 次，再让出 yield_count 次时间片，最后用 futex 挂起线程
+ * @remark spin_count = 0 时直接挂起，适合空闲时间远大于处理时间的流水线
+ */
+struct ParkingPolicy {
+    int spin_count{2000};
+    int yield_count{4};
+};
+
+/**
+ * @brief 基于 futex 的线程挂起/唤醒
+ * @details 等待方先读取 epoch()，再检查条件；条件不满足时 park(epoch)。
+ * 通知方修改条件后 notify()，epoch 加一，只有在有线程挂起时才进入内核。
+ */
+class Parker {
+  public:
+    static inline void cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+        _mm_pause();
+#endif
+    }
+
+    uint32_t epoch() const { return epoch_.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 唤醒所有挂起的线程
+     */
+    void notify() {
+        epoch_.fetch_add(1, std::memory_order_seq_cst);
+        if (waiters_.load(std::memory_order_seq_cst) > 0)
+            futex(FUTEX_WAKE_PRIVATE, INT_MAX, nullptr);
+    }
+
+    /**
+     * @brief 若 epoch 仍为 seen，则挂起当前线程，直到被 notify() 唤醒或超时
+     *
+     * @param timeout 为负时不超时
+     * @return false 表示超时
+     */
+    bool park(uint32_t seen, std::chrono::nanoseconds timeout = std::chrono::nanoseconds(-1)) {
+        timespec ts{};
+        if (timeout.count() >= 0) {
+            ts.tv_sec  = timeout.count() / 1'000'000'000;
+            ts.tv_nsec = timeout.count() % 1'000'000'000;
+        }
+
+        waiters_.fetch_add(1, std::memory_order_seq_cst);
+        long ret = futex(FUTEX_WAIT_PRIVATE, seen, timeout.count() >= 0 ? &ts : nullptr);
+        waiters_.fetch_sub(1, std::memory_order_seq_cst);
+
+        return ret == 0 || errno != ETIMEDOUT;
+    }
+
+    /**
+     * @brief 按 policy 等待 try_get() 返回有值的结果
+     *
+     * @param try_get 返回 std::optional<> 的非阻塞读取函数
+     * @param timeout 为负时一直等待
+     */
+    template <typename TryGet>
+    auto wait_for(const ParkingPolicy &policy, TryGet &&try_get, std::chrono::nanoseconds timeout)
+        -> decltype(try_get()) {
+        using namespace std::chrono;
+        const bool forever  = timeout.count() < 0;
+        const auto deadline = steady_clock::now() + (forever ? nanoseconds(0) : timeout);
+
+        for (int i = 0; i < policy.spin_count; ++i) {
+            if (auto result = try_get(); result.has_value())
+                return result;
+            cpu_relax();
+        }
+        for (int i = 0; i < policy.yield_count; ++i) {
+            if (auto result = try_get(); result.has_value())
+                return result;
+            std::this_thread::yield();
+        }
+
+        while (true) {
+            uint32_t seen = this->epoch();
+            if (auto result = try_get(); result.has_value())
+                return result;
+
+            if (forever)
+                this->park(seen);
+            else {
+                auto remaining = deadline - steady_clock::now();
+                if (remaining <= nanoseconds(0))
+                    return try_get();
+                this->park(seen, duration_cast<nanoseconds>(remaining));
+            }
+        }
+    }
+
+  private:
+    long futex(int op, uint32_t value, const timespec *timeout) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t *>(&epoch_), op, value, timeout, nullptr, 0);
+    }
+
+    std::atomic<uint32_t> epoch_{0};
+    std::atomic<int> waiters_{0};
+};
+
+#endif // __PARKER_HPP__
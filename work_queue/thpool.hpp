@@ -1,57 +1,303 @@
 /**
  * @file thpool.hpp
- * @author your name (you@domain.com)
- * @brief 
- * @version 0.1
- * @date 2025-02-25
- * 
+ * @author arca
+ * @brief Work-stealing thread pool for per-frame parallel tasks.
+ * @version 0.2
+ * @date 2025-03-06
+ *
  * @copyright Copyright (c) 2025
- * 
- * !!! UNFINISHED !!!
  */
 
 #ifndef __THREAD_POOL_HPP__
 #define __THREAD_POOL_HPP__
 
-/**
- * @brief Dedicated thread pool for executing certain work
- */
+#include "parker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <exception>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <pthread.h>
-#include <semaphore.h>
+#include <thread>
+#include <type_traits>
+#include <vector>
 
+/**
+ * @brief Dedicated thread pool for executing certain work
+ * @details 每个工作线程有一个 Chase-Lev 双端队列：自己从底部 push/pop，空闲线程从其他线程的顶部偷任务。
+ * 外部线程提交的任务先进入注入队列，由空闲的工作线程领取。没有任务时工作线程通过 futex 挂起。
+ *
+ * @tparam MAX_THREADPOOL_SIZE 工作线程数量上限
+ */
 template <size_t MAX_THREADPOOL_SIZE = 16>
 class ThreadPool {
+  protected:
+    struct task_t {
+        std::function<void()> func;
+    }; // 任务类型
+
+    /**
+     * @brief Chase-Lev 工作窃取队列
+     * @remark push()/pop() 只能由所属工作线程调用，steal() 可由任意线程调用
+     */
+    class WorkStealingDeque {
+        struct Array {
+            explicit Array(int64_t cap) : capacity(cap), mask(cap - 1), items(new std::atomic<task_t *>[cap]) {}
+
+            task_t *get(int64_t i) const { return items[i & mask].load(std::memory_order_relaxed); }
+            void put(int64_t i, task_t *task) { items[i & mask].store(task, std::memory_order_relaxed); }
+
+            int64_t capacity, mask;
+            std::unique_ptr<std::atomic<task_t *>[]> items;
+        };
+
+      public:
+        explicit WorkStealingDeque(int64_t capacity = 256) {
+            garbage_.push_back(std::make_unique<Array>(capacity));
+            array_.store(garbage_.back().get(), std::memory_order_relaxed);
+        }
+
+        ~WorkStealingDeque() {
+            while (task_t *task = pop())
+                delete task;
+        }
+
+        void push(task_t *task) {
+            int64_t b = bottom_.load(std::memory_order_relaxed);
+            int64_t t = top_.load(std::memory_order_acquire);
+            Array *a  = array_.load(std::memory_order_relaxed);
+            if (b - t > a->capacity - 1)
+                a = grow(a, b, t);
+            a->put(b, task);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        task_t *pop() {
+            int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+            Array *a  = array_.load(std::memory_order_relaxed);
+            bottom_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t t = top_.load(std::memory_order_relaxed);
+
+            task_t *task = nullptr;
+            if (t <= b) {
+                task = a->get(b);
+                if (t == b) { // 最后一个元素，和窃取者竞争
+                    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                        task = nullptr;
+                    bottom_.store(b + 1, std::memory_order_relaxed);
+                }
+            } else
+                bottom_.store(b + 1, std::memory_order_relaxed);
+            return task;
+        }
+
+        task_t *steal() {
+            int64_t t = top_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t b = bottom_.load(std::memory_order_acquire);
+            if (t >= b)
+                return nullptr;
+
+            Array *a     = array_.load(std::memory_order_acquire);
+            task_t *task = a->get(t);
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr; // 被其他线程抢走
+            return task;
+        }
+
+        bool empty() const {
+            return bottom_.load(std::memory_order_relaxed) <= top_.load(std::memory_order_relaxed);
+        }
+
+      private:
+        Array *grow(Array *old, int64_t b, int64_t t) {
+            auto bigger = std::make_unique<Array>(old->capacity * 2);
+            for (int64_t i = t; i < b; ++i)
+                bigger->put(i, old->get(i));
+            Array *result = bigger.get();
+            garbage_.push_back(std::move(bigger)); // 窃取者可能还在读旧数组，析构时再释放
+            array_.store(result, std::memory_order_release);
+            return result;
+        }
+
+        alignas(64) std::atomic<int64_t> top_{0};
+        alignas(64) std::atomic<int64_t> bottom_{0};
+        std::atomic<Array *> array_;
+        std::vector<std::unique_ptr<Array>> garbage_;
+    };
+
   public:
-    ThreadPool() : head_(nullptr), tail_(nullptr),queue_length_(0) {
-        sem_init(&q_io_mutex, 0, 1);
-        sem_init(&q_has_task, 0, 0);
+    /**
+     * @param thread_num 工作线程数量，不超过 MAX_THREADPOOL_SIZE
+     * @param pin_to_cores 非空时，第 i 个工作线程绑定到 pin_to_cores[i % size] 号核心
+     */
+    explicit ThreadPool(
+        size_t thread_num = std::thread::hardware_concurrency(), const std::vector<int> &pin_to_cores = {}
+    ) {
+        thread_num = std::clamp<size_t>(thread_num, 1, MAX_THREADPOOL_SIZE);
+        for (size_t i = 0; i < thread_num; ++i)
+            queues_.push_back(std::make_unique<WorkStealingDeque>());
+
+        for (size_t i = 0; i < thread_num; ++i) {
+            threads_.emplace_back([this, i] { this->worker_loop(i); });
+            if (!pin_to_cores.empty()) {
+                cpu_set_t cpuset;
+                CPU_ZERO(&cpuset);
+                CPU_SET(pin_to_cores[i % pin_to_cores.size()], &cpuset);
+                pthread_setaffinity_np(threads_.back().native_handle(), sizeof(cpu_set_t), &cpuset);
+            }
+        }
+    }
+
+    ~ThreadPool() {
+        not_shutdown_.store(false, std::memory_order_release);
+        parker_.notify();
+        for (auto &t : threads_)
+            if (t.joinable())
+                t.join();
+
+        std::lock_guard<std::mutex> lock(inject_mutex_);
+        for (task_t *task : inject_)
+            delete task;
+    }
+
+    ThreadPool(const ThreadPool &)            = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return threads_.size(); }
+
+    /**
+     * @brief 提交一个任务，返回其结果的 future
+     */
+    template <typename F, typename... Args>
+    auto submit(F &&f, Args &&...args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using R   = std::invoke_result_t<F, Args...>;
+        auto task = std::make_shared<std::packaged_task<R()>>(
+            [f = std::forward<F>(f), ... args = std::forward<Args>(args)]() mutable { return std::invoke(f, args...); }
+        );
+        auto future = task->get_future();
+        this->enqueue(new task_t{[task] { (*task)(); }});
+        return future;
+    }
+
+    /**
+     * @brief 并行执行 fn(i), i ∈ [begin, end)，返回时全部执行完毕
+     * @details 区间按 grain 切块，调用线程自己也参与执行，因此可以在工作线程里嵌套调用。
+     * fn 抛出的第一个异常会在调用线程重新抛出。
+     */
+    template <typename F>
+    void parallel_for(size_t begin, size_t end, F &&fn, size_t grain = 1) {
+        if (begin >= end)
+            return;
+        grain               = std::max<size_t>(grain, 1);
+        const size_t chunks = (end - begin + grain - 1) / grain;
+        if (chunks == 1) {
+            for (size_t i = begin; i < end; ++i)
+                fn(i);
+            return;
+        }
+
+        struct State {
+            std::atomic<size_t> next{0}, done{0};
+            std::atomic<bool> failed{false};
+            std::exception_ptr error;
+        };
+        auto state = std::make_shared<State>();
+
+        auto run_chunks = [state, begin, end, grain, chunks, &fn] {
+            for (size_t c; (c = state->next.fetch_add(1, std::memory_order_relaxed)) < chunks;) {
+                if (!state->failed.load(std::memory_order_relaxed)) {
+                    try {
+                        for (size_t i = begin + c * grain, e = std::min(end, i + grain); i < e; ++i)
+                            fn(i);
+                    } catch (...) {
+                        if (!state->failed.exchange(true))
+                            state->error = std::current_exception();
+                    }
+                }
+                if (state->done.fetch_add(1, std::memory_order_acq_rel) + 1 == chunks)
+                    state->done.notify_all();
+            }
+        };
+
+        // fn 只在调用线程返回前被使用；晚到的辅助任务会发现没有剩余块，直接退出
+        const size_t helpers = std::min(chunks - 1, this->size());
+        for (size_t h = 0; h < helpers; ++h)
+            this->enqueue(new task_t{run_chunks});
+        run_chunks();
+
+        for (size_t d; (d = state->done.load(std::memory_order_acquire)) != chunks;)
+            state->done.wait(d);
+        if (state->error)
+            std::rethrow_exception(state->error);
     }
 
   protected:
-    struct task_t {
-        std::function<void(void *)>;
-        void *args;
-        task_t *next;
-    }; // 任务类型
+    void enqueue(task_t *task) {
+        if (current_pool_ == this)
+            queues_[current_index_]->push(task); // 工作线程内提交，放入自己的队列
+        else {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            inject_.push_back(task);
+        }
+        parker_.notify();
+    }
+
+    task_t *find_task(size_t index) {
+        if (task_t *task = queues_[index]->pop())
+            return task;
+
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            if (!inject_.empty()) {
+                task_t *task = inject_.front();
+                inject_.pop_front();
+                return task;
+            }
+        }
 
-    // 任务队列以及对应 semaphore
-    volatile size_t queue_length_;
-    std::unique_ptr<task_t> head_, tail_;
-    sem_t q_io_mutex; // io control
-    sem_t q_has_task; // no task
+        for (size_t k = 1, n = queues_.size(); k < n; ++k)
+            if (task_t *task = queues_[(index + k) % n]->steal())
+                return task;
+        return nullptr;
+    }
+
+    void worker_loop(size_t index) {
+        current_pool_  = this;
+        current_index_ = index;
+
+        while (true) {
+            uint32_t seen = parker_.epoch();
+            if (task_t *task = find_task(index)) {
+                task->func();
+                delete task;
+                continue;
+            }
+            if (!not_shutdown_.load(std::memory_order_acquire))
+                break;
+            parker_.park(seen);
+        }
+    }
+
+    // 任务队列
+    std::vector<std::unique_ptr<WorkStealingDeque>> queues_;
+    std::mutex inject_mutex_;
+    std::deque<task_t *> inject_; // 外部线程提交的任务
 
     // 线程池相关
-    std::unique_ptr<pthread_t[]> threads_;
-    volatile bool not_shutdown_;
-    volatile int working_thread_num_;
-    volatile int online_thread_num_;
-    sem_t work_lock_;
-    sem_t online_lock_;
-    sem_t idle_all_;
-
-  private:
+    std::vector<std::thread> threads_;
+    std::atomic<bool> not_shutdown_{true};
+    Parker parker_;
+
+    static inline thread_local ThreadPool *current_pool_ = nullptr;
+    static inline thread_local size_t current_index_     = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -2,14 +2,19 @@
 #define __THPOOL_HPP__
 
 #include "circular_buffer.hpp"
+#include "parker.hpp"
+#include "spsc_ring_buffer.hpp"
 
 #include <atomic>
+#include <chrono>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <pthread.h>
 #include <semaphore>
 #include <spdlog/spdlog.h>
+#include <thread>
+#include <type_traits>
 #include <vector>
 
 #include "config.hpp"
@@ -105,21 +110,53 @@ class DataTransmitter {
 
 /**
  * @brief Wrapper Class of circular buffer. Just for more specific usage.
- a
+ * @remark 每条流水线只有一个生产者和一个消费者时，可以用 `SPSCRingBuffer` 作为 Buffer 去掉锁。
+ *
  * @tparam DataType
  * @tparam BufferSize
+ * @tparam Buffer 底层缓冲区，`CircularBuffer`（加锁，满时覆盖旧数据）或 `SPSCRingBuffer`（无锁，满时丢弃新数据）
  */
-template <typename DataType, int BufferSize = 1024>
+template <typename DataType, int BufferSize = 1024, template <typename> class Buffer = CircularBuffer>
 class SyncQueue {
   private:
-    CircularBuffer<DataType> buffer_{BufferSize};
+    Buffer<DataType> buffer_{BufferSize};
+    Parker parker_;
+    ParkingPolicy policy_;
 
   public:
-    void write_data(const DataType &data) { buffer_.push(data); }
+    bool write_data(const DataType &data) { return write_data(DataType(data)); }
+    bool write_data(DataType &&data) {
+        bool ok = true;
+        if constexpr (std::is_same_v<decltype(buffer_.push(std::move(data))), bool>)
+            ok = buffer_.push(std::move(data));
+        else
+            buffer_.push(std::move(data));
+        parker_.notify();
+        return ok;
+    }
     auto read_data() { return std::forward<std::optional<const DataType &>>(buffer_.front()); }
     std::optional<DataType> pop_data() { return buffer_.pop(); }
-    bool is_empty() { return buffer_.empty(); }
-    bool is_full() { return buffer_.full(); }
+
+    /**
+     * @brief 阻塞直到取到数据。先按 ParkingPolicy 自旋，再挂起线程，不占用空闲核心
+     */
+    DataType pop_wait() {
+        return parker_.wait_for(policy_, [this] { return buffer_.pop(); }, std::chrono::nanoseconds(-1)).value();
+    }
+
+    /**
+     * @brief 最多等待 timeout，超时返回 std::nullopt
+     */
+    template <typename Rep, typename Period>
+    std::optional<DataType> pop_wait_for(const std::chrono::duration<Rep, Period> &timeout) {
+        return parker_.wait_for(
+            policy_, [this] { return buffer_.pop(); }, std::chrono::duration_cast<std::chrono::nanoseconds>(timeout)
+        );
+    }
+
+    void set_parking_policy(const ParkingPolicy &policy) { policy_ = policy; }
+    bool is_empty() { return buffer_.is_empty(); }
+    bool is_full() { return buffer_.is_full(); }
 };
 
 #endif
\ No newline at end of file